@@ -57,9 +57,25 @@
     {% set kernel_param_attributes = create_list({"in": "", "out": ""}, num_replications) %}
 {% endif %}
 
-#define min(a,b) (a<b?a:b)
+// Log2 of additional FFT sizes that are generated besides LOG_FFT_SIZE.
+// The kernels of the additional sizes are named with the size as additional suffix, e.g. fft1d_8_0
+{% if fft_additional_log_sizes is not defined %}
+    {% set fft_additional_log_sizes = [] %}
+{% endif %}
+{% set fft_log_sizes = ["LOG_FFT_SIZE"] + fft_additional_log_sizes %}
+
+// The reorder kernels for the in-order output are only generated on request, since they need an additional
+// on-chip buffer for two FFTs
+{% if fft_reorder_kernel is not defined %}
+    {% set fft_reorder_kernel = False %}
+{% endif %}
+
+// The transpose kernels are only needed for multidimensional FFTs and are also generated on request
+{% if fft_transpose_kernel is not defined %}
+    {% set fft_transpose_kernel = False %}
+{% endif %}
 
-#define LOGN            LOG_FFT_SIZE
+#define min(a,b) (a<b?a:b)
 
 #define LOGPOINTS       3
 #define POINTS          (1 << LOGPOINTS)
@@ -67,8 +83,11 @@
 // Need some depth to our channels to accommodate their bursty filling.
 #ifdef INTEL_FPGA
 #pragma OPENCL EXTENSION cl_intel_channels : enable
+{% for log_size in fft_log_sizes %}
+{% set size_suffix = "" if loop.first else "_" ~ log_size ~ "_" %}
 {% for i in range(num_total_replications) %}
-channel float2 chanin{{ i }}[POINTS] __attribute__((depth(POINTS)));
+channel float2 chanin{{ size_suffix }}{{ i }}[POINTS] __attribute__((depth(POINTS)));
+{% endfor %}
 {% endfor %}
 #endif
 #ifdef XILINX_FPGA
@@ -76,9 +95,12 @@ channel float2 chanin{{ i }}[POINTS] __attribute__((depth(POINTS)));
 //#define XILINX_PIPE_DEPTH ((1 << (LOGN - LOGPOINTS) < 16) ? 16 : (1 << (LOGN - LOGPOINTS)))
 
 // Compiler states, that the pipe depth needs at least to be 16
+{% for log_size in fft_log_sizes %}
+{% set size_suffix = "" if loop.first else "_" ~ log_size ~ "_" %}
 {% for i in range(num_total_replications) %}
-pipe float2x8 chanin{{ i }} __attribute__((xcl_reqd_pipe_depth(XILINX_PIPE_DEPTH)));
-pipe float2x8 chanout{{ i }} __attribute__((xcl_reqd_pipe_depth(XILINX_PIPE_DEPTH)));
+pipe float2x8 chanin{{ size_suffix }}{{ i }} __attribute__((xcl_reqd_pipe_depth(XILINX_PIPE_DEPTH)));
+pipe float2x8 chanout{{ size_suffix }}{{ i }} __attribute__((xcl_reqd_pipe_depth(XILINX_PIPE_DEPTH)));
+{% endfor %}
 {% endfor %}
 #endif
 
@@ -94,11 +116,18 @@ __attribute__((opencl_unroll_hint()))
   return y;
 }
 
+{% for log_size in fft_log_sizes %}
+{% set size_suffix = "" if loop.first else "_" ~ log_size ~ "_" %}
+
+// The kernels below are generated for the FFT size 2^{{ log_size }}
+#undef LOGN
+#define LOGN            {{ log_size }}
+
 {% for i in range(num_total_replications) %}
 
 __kernel
 __attribute__ ((max_global_work_dim(0), reqd_work_group_size(1,1,1)))
-void fetch{{ i }}(__global {{ kernel_param_attributes[i]["in"] }} float2 * restrict src, int iter) {
+void fetch{{ size_suffix }}{{ i }}(__global {{ kernel_param_attributes[i]["in"] }} float2 * restrict src, int iter) {
 
   const int N = (1 << LOGN);
 
@@ -162,17 +191,17 @@ void fetch{{ i }}(__global {{ kernel_param_attributes[i]["in"] }} float2 * restr
       buf2x8.i7 = write_chunk[7];
 
       // Start in the second iteration to forward the buffered data over the pipe
-      write_pipe_block(chanin{{ i }}, &buf2x8);
+      write_pipe_block(chanin{{ size_suffix }}{{ i }}, &buf2x8);
 #endif
 #ifdef INTEL_FPGA
-        write_channel_intel(chanin{{ i }}[0], write_chunk[0]);
-        write_channel_intel(chanin{{ i }}[1], write_chunk[1]);
-        write_channel_intel(chanin{{ i }}[2], write_chunk[2]);
-        write_channel_intel(chanin{{ i }}[3], write_chunk[3]);
-        write_channel_intel(chanin{{ i }}[4], write_chunk[4]);
-        write_channel_intel(chanin{{ i }}[5], write_chunk[5]);
-        write_channel_intel(chanin{{ i }}[6], write_chunk[6]);
-        write_channel_intel(chanin{{ i }}[7], write_chunk[7]);
+        write_channel_intel(chanin{{ size_suffix }}{{ i }}[0], write_chunk[0]);
+        write_channel_intel(chanin{{ size_suffix }}{{ i }}[1], write_chunk[1]);
+        write_channel_intel(chanin{{ size_suffix }}{{ i }}[2], write_chunk[2]);
+        write_channel_intel(chanin{{ size_suffix }}{{ i }}[3], write_chunk[3]);
+        write_channel_intel(chanin{{ size_suffix }}{{ i }}[4], write_chunk[4]);
+        write_channel_intel(chanin{{ size_suffix }}{{ i }}[5], write_chunk[5]);
+        write_channel_intel(chanin{{ size_suffix }}{{ i }}[6], write_chunk[6]);
+        write_channel_intel(chanin{{ size_suffix }}{{ i }}[7], write_chunk[7]);
 #endif
     }
   }
@@ -191,7 +220,7 @@ void fetch{{ i }}(__global {{ kernel_param_attributes[i]["in"] }} float2 * restr
 
 __attribute__ ((max_global_work_dim(0)))
 __attribute__((reqd_work_group_size(1,1,1)))
-kernel void fft1d{{ i }}(
+kernel void fft1d{{ size_suffix }}{{ i }}(
 #ifdef INTEL_FPGA
                 // Intel does not need a store kernel and directly writes back the result to global memory
                 __global {{ kernel_param_attributes[i]["out"] }} float2 * restrict dest,
@@ -233,17 +262,17 @@ kernel void fft1d{{ i }}(
     // Perform memory transfers only when reading data in range
     if (i < count * (N / POINTS)) {
 #ifdef INTEL_FPGA
-      data.i0 = read_channel_intel(chanin{{ i }}[0]);
-      data.i1 = read_channel_intel(chanin{{ i }}[1]);
-      data.i2 = read_channel_intel(chanin{{ i }}[2]);
-      data.i3 = read_channel_intel(chanin{{ i }}[3]);
-      data.i4 = read_channel_intel(chanin{{ i }}[4]);
-      data.i5 = read_channel_intel(chanin{{ i }}[5]);
-      data.i6 = read_channel_intel(chanin{{ i }}[6]);
-      data.i7 = read_channel_intel(chanin{{ i }}[7]);
+      data.i0 = read_channel_intel(chanin{{ size_suffix }}{{ i }}[0]);
+      data.i1 = read_channel_intel(chanin{{ size_suffix }}{{ i }}[1]);
+      data.i2 = read_channel_intel(chanin{{ size_suffix }}{{ i }}[2]);
+      data.i3 = read_channel_intel(chanin{{ size_suffix }}{{ i }}[3]);
+      data.i4 = read_channel_intel(chanin{{ size_suffix }}{{ i }}[4]);
+      data.i5 = read_channel_intel(chanin{{ size_suffix }}{{ i }}[5]);
+      data.i6 = read_channel_intel(chanin{{ size_suffix }}{{ i }}[6]);
+      data.i7 = read_channel_intel(chanin{{ size_suffix }}{{ i }}[7]);
 #endif
 #ifdef XILINX_FPGA
-      read_pipe_block(chanin{{ i }}, &data);
+      read_pipe_block(chanin{{ size_suffix }}{{ i }}, &data);
 #endif
     } else {
       data.i0 = data.i1 = data.i2 = data.i3 = 
@@ -272,7 +301,7 @@ kernel void fft1d{{ i }}(
 #endif
 #ifdef XILINX_FPGA
     // For Xilinx send the data to the store kernel to enable memory bursts
-      write_pipe_block(chanout{{ i }}, &data);
+      write_pipe_block(chanout{{ size_suffix }}{{ i }}, &data);
 #endif
     }
   }
@@ -285,14 +314,14 @@ This kernel works without conditional branches which enables memory bursts.
  */
 __kernel
 __attribute__ ((max_global_work_dim(0), reqd_work_group_size(1,1,1)))
-void store{{ i }}(__global {{ kernel_param_attributes[i]["out"] }} float2 * restrict dest, int iter) {
+void store{{ size_suffix }}{{ i }}(__global {{ kernel_param_attributes[i]["out"] }} float2 * restrict dest, int iter) {
 
   const int N = (1 << LOGN);
 
   // write the data back to global memory using memory bursts
   for(unsigned k = 0; k < iter * (N / POINTS); k++){ 
       float2x8 buf2x8;
-      read_pipe_block(chanout{{ i }}, &buf2x8);
+      read_pipe_block(chanout{{ size_suffix }}{{ i }}, &buf2x8);
 
       dest[(k << LOGPOINTS)]     = buf2x8.i0;    
       dest[(k << LOGPOINTS) + 1] = buf2x8.i1; 
@@ -305,5 +334,145 @@ void store{{ i }}(__global {{ kernel_param_attributes[i]["out"] }} float2 * rest
   }
 }
 #endif
+{% if fft_reorder_kernel %}
 
-{% endfor %}
\ No newline at end of file
+/**
+The reorder kernel converts the bit reversed output of the FFT kernel into natural order.
+The values of an FFT are written to an on-chip buffer at their bit reversed position and read back in natural order
+while the next FFT is written to the second half of the buffer.
+The buffer is split into POINTS banks and every value is rotated by the highest bits of its index, so the POINTS values
+of a chunk are always placed in different banks, both in bit reversed and in natural order.
+For FFT sizes below POINTS * POINTS the rotation is done by the bits above the bank bits instead.
+The values of a chunk are permuted in private memory, so every bank is always accessed by the same unrolled iteration.
+ */
+__kernel
+__attribute__ ((max_global_work_dim(0), reqd_work_group_size(1,1,1)))
+void reorder{{ size_suffix }}{{ i }}(__global {{ kernel_param_attributes[i]["out"] }} const float2 * restrict src,
+                __global {{ kernel_param_attributes[i]["out"] }} float2 * restrict dest, int iter) {
+#ifdef XILINX_FPGA
+#pragma HLS INTERFACE m_axi port=src offset=slave bundle=gmem0
+#pragma HLS INTERFACE m_axi port=dest offset=slave bundle=gmem1
+#endif
+
+  const int N = (1 << LOGN);
+  const unsigned shift = (LOGN - LOGPOINTS > LOGPOINTS) ? LOGN - LOGPOINTS : LOGPOINTS;
+
+  // Reorder buffer that can hold the data for two FFTs
+  float2 buf[2][N/POINTS][POINTS] __attribute__((numbanks(POINTS),xcl_array_partition(complete, 1), xcl_array_partition(complete, 3)));
+
+  // for iter iterations and one additional iteration to empty the last buffer
+  for(unsigned k = 0; k < (iter + 1) * (N / POINTS); k++){
+    const unsigned chunk = k & (N/POINTS - 1);
+    const unsigned current_buffer = (k >> (LOGN - LOGPOINTS)) & 1;
+#ifdef INTEL_FPGA
+    // Only use this condition for Intel FPGAs because it will destroy the memory bursts for Xilinx
+    if (k < iter * (N / POINTS)) {
+#endif
+      float2 read_chunk[POINTS];
+
+      // In the last iteration just read garbage, which will not be written back
+      __attribute__((opencl_unroll_hint(POINTS)))
+      for(int j = 0; j < POINTS; j++){
+        read_chunk[j] = src[(k << LOGPOINTS) + j];
+      }
+
+      // Sort the values of the chunk by their bank
+      float2 bank_chunk[POINTS];
+      unsigned bank_rows[POINTS];
+      __attribute__((opencl_unroll_hint(POINTS)))
+      for(int j = 0; j < POINTS; j++){
+        unsigned index = bit_reversed((chunk << LOGPOINTS) + j, LOGN);
+        unsigned bank = (index + (index >> shift)) & (POINTS - 1);
+        bank_chunk[bank] = read_chunk[j];
+        bank_rows[bank] = index >> LOGPOINTS;
+      }
+
+      __attribute__((opencl_unroll_hint(POINTS)))
+      for(int j = 0; j < POINTS; j++){
+        buf[current_buffer][bank_rows[j]][j] = bank_chunk[j];
+      }
+#ifdef INTEL_FPGA
+    }
+#endif
+    // Start in the second iteration to write back the previous FFT in natural order
+    if (k >= (N / POINTS)) {
+      // All values of a chunk in natural order are stored in the same row and rotated by the same number of banks
+      const unsigned rotation = (chunk << LOGPOINTS) >> shift;
+      float2 bank_chunk[POINTS];
+      __attribute__((opencl_unroll_hint(POINTS)))
+      for(int j = 0; j < POINTS; j++){
+        bank_chunk[j] = buf[1 - current_buffer][chunk][j];
+      }
+
+      __attribute__((opencl_unroll_hint(POINTS)))
+      for(int j = 0; j < POINTS; j++){
+        dest[((k - N / POINTS) << LOGPOINTS) + j] = bank_chunk[(j + rotation) & (POINTS - 1)];
+      }
+    }
+  }
+}
+
+{% endif %}
+{% endfor %}
+
+{% endfor %}
+
+{% if fft_transpose_kernel %}
+{% for i in range(num_total_replications) %}
+
+/**
+Corner turn kernel that is used between the passes of a multidimensional FFT.
+Every FFT of the batch is interpreted as matrix with 'rows' rows and 2^log_cols columns, where every row is the
+bit reversed output of a 1D FFT. The matrix is transposed and the bit reversal of the rows is
+undone in the same step, so the next pass can calculate the FFTs over the next dimension.
+The transposition is done in tiles of POINTS x POINTS values to allow bursts for reading and writing.
+Source and destination use separate memory interfaces, so they can be connected to different memory banks.
+ */
+__kernel
+__attribute__ ((max_global_work_dim(0), reqd_work_group_size(1,1,1)))
+void transpose{{ i }}(__global {{ kernel_param_attributes[i]["out"] }} const float2 * restrict src,
+                __global {{ kernel_param_attributes[i]["in"] }} float2 * restrict dest,
+                int rows, int log_cols, int count) {
+#ifdef XILINX_FPGA
+#pragma HLS INTERFACE m_axi port=src offset=slave bundle=gmem0
+#pragma HLS INTERFACE m_axi port=dest offset=slave bundle=gmem1
+#endif
+
+  const unsigned cols = 1 << log_cols;
+
+  for (unsigned fft = 0; fft < count; fft++) {
+    const ulong offset = (ulong)fft * rows * cols;
+    for (unsigned tile_row = 0; tile_row < rows; tile_row += POINTS) {
+      for (unsigned tile_col = 0; tile_col < cols; tile_col += POINTS) {
+        float2 tile[POINTS][POINTS];
+
+        // Read POINTS consecutive values of POINTS rows
+        for (unsigned r = 0; r < POINTS; r++) {
+          __attribute__((opencl_unroll_hint(POINTS)))
+          for (unsigned c = 0; c < POINTS; c++) {
+            tile[r][c] = src[offset + (tile_row + r) * cols + tile_col + c];
+          }
+        }
+
+        // Write the columns of the tile as consecutive values to the bit reversed row of the transposed matrix
+        for (unsigned c = 0; c < POINTS; c++) {
+          // Reverse all 32 bits with a fixed loop, since log_cols is not known at compile time
+          unsigned col = tile_col + c;
+          unsigned bit_rev = 0;
+          __attribute__((opencl_unroll_hint()))
+          for (unsigned b = 0; b < 32; b++) {
+            bit_rev = (bit_rev << 1) | ((col >> b) & 1);
+          }
+          bit_rev >>= (32 - log_cols);
+          __attribute__((opencl_unroll_hint(POINTS)))
+          for (unsigned r = 0; r < POINTS; r++) {
+            dest[offset + bit_rev * rows + tile_row + r] = tile[r][c];
+          }
+        }
+      }
+    }
+  }
+}
+
+{% endfor %}
+{% endif %}
@@ -41,12 +41,88 @@ This method can be implemented in multiple *.cpp files. This header enables
 simple exchange of the different calculation methods.
 
 @param config struct that contains all necessary information to execute the kernel on the FPGA
+@param data Input data for all FFTs of the batch
+@param data_out Output data for all FFTs of the batch
+@param iterations Number of FFTs in the batch
+@param inverse If true, the iFFT is calculated
+@param log_size The log2 of the FFT size. The kernel file has to contain kernels for this size.
 
 
-@return The resulting matrix
+@return The measured execution times. If the in-order output is used, the times of the reorder kernel are
+        additionally returned with the key "reorder".
 */
     std::map<std::string, std::vector<double>>
-    calculate(hpcc_base::ExecutionSettings<fft::FFTProgramSettings, cl::Device, cl::Context, cl::Program> const& config, std::complex<HOST_DATA_TYPE>* data, std::complex<HOST_DATA_TYPE>* data_out, unsigned iterations, bool inverse);
+    calculate(hpcc_base::ExecutionSettings<fft::FFTProgramSettings, cl::Device, cl::Context, cl::Program> const& config, std::complex<HOST_DATA_TYPE>* data, std::complex<HOST_DATA_TYPE>* data_out, unsigned iterations, bool inverse, uint log_size);
+
+/**
+Execution of multidimensional FFTs. Every pass calculates the 1D FFTs over the last dimension with the
+FFT kernel and rotates the dimensions with the transpose kernel. The data stays in device memory between the passes
+and the result is returned in natural order.
+
+@param config struct that contains all necessary information to execute the kernel on the FPGA
+@param data Input data for all FFTs of the batch
+@param data_out Output data for all FFTs of the batch
+@param iterations Number of multidimensional FFTs in the batch
+@param inverse If true, the iFFT is calculated
+@param log_size The log2 of the FFT size in every dimension. The kernel file has to contain kernels for this size.
+@param dimensions Number of dimensions of the FFT
+
+
+@return The measured execution times
+*/
+    std::map<std::string, std::vector<double>>
+    calculateMultiDimensional(hpcc_base::ExecutionSettings<fft::FFTProgramSettings, cl::Device, cl::Context, cl::Program> const& config, std::complex<HOST_DATA_TYPE>* data, std::complex<HOST_DATA_TYPE>* data_out, unsigned iterations, bool inverse, uint log_size, uint dimensions);
+
+/**
+Streaming execution of the FFT kernel. The batch is split into chunks that are written to the device, transformed
+and read back through a fixed ring of pinned host buffers and device buffers, so the transfers of a chunk are
+overlapped with the calculation of other chunks. The measured time includes all host transfers.
+Every repetition samples a different chunk of the stream, whose input and output are returned for the validation.
+If there are at least as many repetitions as chunks, every chunk is validated.
+
+@param config struct that contains all necessary information to execute the kernel on the FPGA
+@param data Contains the input of a sampled chunk for every repetition after the execution. The input of every chunk
+            is generated with fft::generate_stream_chunk() within the stream.
+@param data_out Contains the output of a sampled chunk for every repetition after the execution
+@param iterations Number of FFTs in the whole stream. Has to be a multiple of the chunk size.
+@param inverse If true, the iFFT is calculated
+@param log_size The log2 of the FFT size. The kernel file has to contain kernels for this size.
+
+
+@return The measured execution times
+*/
+    std::map<std::string, std::vector<double>>
+    calculateStreaming(hpcc_base::ExecutionSettings<fft::FFTProgramSettings, cl::Device, cl::Context, cl::Program> const& config, std::complex<HOST_DATA_TYPE>* data, std::complex<HOST_DATA_TYPE>* data_out, unsigned iterations, bool inverse, uint log_size);
+
+/**
+Execution of a single 1D FFT of size n^2 that is distributed over all MPI ranks using the six-step algorithm.
+The FFTs of size n over the local rows are calculated with the FFT kernel. The global transpositions
+are done on the host with MPI all-to-all communication, which also applies the twiddle factors.
+
+@param config struct that contains all necessary information to execute the kernel on the FPGA
+@param data Local part of the input data in natural order
+@param data_out Local part of the output data in natural order
+@param inverse If true, the iFFT is calculated
+@param log_size The log2 of n. The kernel file has to contain kernels for this size.
+
+
+@return The measured execution times and the time spent in the all-to-all communication
+*/
+    std::map<std::string, std::vector<double>>
+    calculateDistributed(hpcc_base::ExecutionSettings<fft::FFTProgramSettings, cl::Device, cl::Context, cl::Program> const& config, std::complex<HOST_DATA_TYPE>* data, std::complex<HOST_DATA_TYPE>* data_out, bool inverse, uint log_size);
+
+/**
+Get the name of a kernel for the given FFT size and replication.
+The kernels of LOG_FFT_SIZE are named without size, all other kernels contain the size as additional suffix.
+
+@param base_name Base name of the kernel
+@param log_size The log2 of the FFT size
+@param replication The kernel replication
+
+@return The name of the kernel
+*/
+    std::string
+    getKernelName(const std::string& base_name, uint log_size, int replication);
 
 }  // namespace bm_execution
 
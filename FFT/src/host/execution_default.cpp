@@ -27,6 +27,7 @@ SOFTWARE.
 #include <memory>
 #include <vector>
 #include <chrono>
+#include <string>
 
 /* External library headers */
 #ifdef INTEL_FPGA
@@ -40,6 +41,17 @@ SOFTWARE.
 
 namespace bm_execution {
 
+    /*
+     @copydoc bm_execution::getKernelName()
+    */
+    std::string
+    getKernelName(const std::string& base_name, uint log_size, int replication) {
+        if (log_size == LOG_FFT_SIZE) {
+            return base_name + std::to_string(replication);
+        }
+        return base_name + "_" + std::to_string(log_size) + "_" + std::to_string(replication);
+    }
+
     /*
     Implementation for the single kernel.
      @copydoc bm_execution::calculate()
@@ -49,26 +61,31 @@ namespace bm_execution {
             std::complex<HOST_DATA_TYPE>* data,
             std::complex<HOST_DATA_TYPE>* data_out,
             unsigned iterations,
-            bool inverse) {
+            bool inverse,
+            uint log_size) {
         
         int err;
+        const size_t fft_size = static_cast<size_t>(1) << log_size;
 
         std::vector<cl::Buffer> inBuffers;
         std::vector<cl::Buffer> outBuffers;
         std::vector<cl::Kernel> fetchKernels;
         std::vector<cl::Kernel> fftKernels;
         std::vector<cl::Kernel> storeKernels;
+        std::vector<cl::Buffer> reorderBuffers;
+        std::vector<cl::Kernel> reorderKernels;
         std::vector<cl::CommandQueue> fetchQueues;
         std::vector<cl::CommandQueue> fftQueues;
         std::vector<cl::CommandQueue> storeQueues;
 
         unsigned iterations_per_kernel = iterations / config.programSettings->kernelReplications;
+        const bool in_order = config.programSettings->inOrder;
 
         for (int r=0; r < config.programSettings->kernelReplications; r++) {
                 // Array of flags for each buffer that is allocated in this benchmark
                 // The content of the flags will be changed according to the used compiler flags
                 // to support different kinds of devices
-                int memory_bank_info[2] = {0};
+                int memory_bank_info[3] = {0};
 #ifdef INTEL_FPGA
 #ifdef USE_HBM
                 // For Intel HBM the buffers have to be created with a special flag
@@ -84,18 +101,25 @@ namespace bm_execution {
                         for (int k = 0; k < 2; k++) {
                                 memory_bank_info[k] = (((2 * r) + 1 + k) << 16);
                         }
+                        // The reordered output is written to the bank of the input data
+                        memory_bank_info[2] = memory_bank_info[0];
                 }
 #endif
 #endif
-                inBuffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[0], (1 << LOG_FFT_SIZE) * iterations_per_kernel * 2 * sizeof(HOST_DATA_TYPE), NULL, &err));
+                inBuffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[0], fft_size * iterations_per_kernel * 2 * sizeof(HOST_DATA_TYPE), NULL, &err));
                 ASSERT_CL(err)
-                outBuffers.push_back(cl::Buffer(*config.context, CL_MEM_WRITE_ONLY | memory_bank_info[1], (1 << LOG_FFT_SIZE) * iterations_per_kernel * 2 * sizeof(HOST_DATA_TYPE), NULL, &err));
+                // The output buffer is read by the reorder kernel for the in-order output
+                outBuffers.push_back(cl::Buffer(*config.context, (in_order ? CL_MEM_READ_WRITE : CL_MEM_WRITE_ONLY) | memory_bank_info[1], fft_size * iterations_per_kernel * 2 * sizeof(HOST_DATA_TYPE), NULL, &err));
                 ASSERT_CL(err)
+                if (in_order) {
+                        reorderBuffers.push_back(cl::Buffer(*config.context, CL_MEM_WRITE_ONLY | memory_bank_info[2], fft_size * iterations_per_kernel * 2 * sizeof(HOST_DATA_TYPE), NULL, &err));
+                        ASSERT_CL(err)
+                }
 
         #ifdef INTEL_FPGA
-                cl::Kernel fetchKernel(*config.program, (FETCH_KERNEL_NAME + std::to_string(r)).c_str(), &err);
+                cl::Kernel fetchKernel(*config.program, getKernelName(FETCH_KERNEL_NAME, log_size, r).c_str(), &err);
                 ASSERT_CL(err)
-                cl::Kernel fftKernel(*config.program, (FFT_KERNEL_NAME + std::to_string(r)).c_str(), &err);
+                cl::Kernel fftKernel(*config.program, getKernelName(FFT_KERNEL_NAME, log_size, r).c_str(), &err);
                 ASSERT_CL(err)
         #ifdef USE_SVM
                 err = clSetKernelArgSVMPointer(fetchKernel(), 0,
@@ -117,11 +141,14 @@ namespace bm_execution {
         #endif
 
         #ifdef XILINX_FPGA
-                cl::Kernel fetchKernel(*config.program, (std::string(FETCH_KERNEL_NAME) + std::to_string(r) + ":{" + FETCH_KERNEL_NAME + std::to_string(r) + "_1"  + "}").c_str(), &err);
+                std::string fetchName = getKernelName(FETCH_KERNEL_NAME, log_size, r);
+                std::string fftName = getKernelName(FFT_KERNEL_NAME, log_size, r);
+                std::string storeName = getKernelName(STORE_KERNEL_NAME, log_size, r);
+                cl::Kernel fetchKernel(*config.program, (fetchName + ":{" + fetchName + "_1"  + "}").c_str(), &err);
                 ASSERT_CL(err)
-                cl::Kernel fftKernel(*config.program, (std::string(FFT_KERNEL_NAME) + std::to_string(r) + ":{" + FFT_KERNEL_NAME + std::to_string(r) + "_1" + "}").c_str(), &err);
+                cl::Kernel fftKernel(*config.program, (fftName + ":{" + fftName + "_1" + "}").c_str(), &err);
                 ASSERT_CL(err)
-                cl::Kernel storeKernel(*config.program, (std::string(STORE_KERNEL_NAME) + std::to_string(r) + ":{" + STORE_KERNEL_NAME + std::to_string(r) + "_1" + "}").c_str(), &err);
+                cl::Kernel storeKernel(*config.program, (storeName + ":{" + storeName + "_1" + "}").c_str(), &err);
                 ASSERT_CL(err)
                 err = storeKernel.setArg(0, outBuffers[r]);
                 ASSERT_CL(err)
@@ -153,26 +180,46 @@ namespace bm_execution {
                 fetchKernels.push_back(fetchKernel);
                 fftKernels.push_back(fftKernel);
 
+                if (in_order) {
+        #ifdef INTEL_FPGA
+                        cl::Kernel reorderKernel(*config.program, getKernelName(REORDER_KERNEL_NAME, log_size, r).c_str(), &err);
+                        ASSERT_CL(err)
+        #endif
+        #ifdef XILINX_FPGA
+                        std::string reorderName = getKernelName(REORDER_KERNEL_NAME, log_size, r);
+                        cl::Kernel reorderKernel(*config.program, (reorderName + ":{" + reorderName + "_1" + "}").c_str(), &err);
+                        ASSERT_CL(err)
+        #endif
+                        err = reorderKernel.setArg(0, outBuffers[r]);
+                        ASSERT_CL(err)
+                        err = reorderKernel.setArg(1, reorderBuffers[r]);
+                        ASSERT_CL(err)
+                        err = reorderKernel.setArg(2, iterations_per_kernel);
+                        ASSERT_CL(err)
+                        reorderKernels.push_back(reorderKernel);
+                }
+
 #ifdef USE_SVM
                 err = clEnqueueSVMMap(fetchQueues[r](), CL_TRUE,
                                 CL_MAP_READ,
-                                reinterpret_cast<void *>(&data[r * (1 << LOG_FFT_SIZE) * iterations_per_kernel]),
-                                (1 << LOG_FFT_SIZE) * iterations_per_kernel * 2 * sizeof(HOST_DATA_TYPE), 0,
+                                reinterpret_cast<void *>(&data[r * fft_size * iterations_per_kernel]),
+                                fft_size * iterations_per_kernel * 2 * sizeof(HOST_DATA_TYPE), 0,
                                 NULL, NULL);
                 ASSERT_CL(err)
                 err = clEnqueueSVMMap(fftQueues[r](), CL_TRUE,
                                 CL_MAP_WRITE,
-                                reinterpret_cast<void *>(&data_out[r * (1 << LOG_FFT_SIZE) * iterations_per_kernel]),
-                                (1 << LOG_FFT_SIZE) * iterations_per_kernel * 2 * sizeof(HOST_DATA_TYPE), 0,
+                                reinterpret_cast<void *>(&data_out[r * fft_size * iterations_per_kernel]),
+                                fft_size * iterations_per_kernel * 2 * sizeof(HOST_DATA_TYPE), 0,
                                 NULL, NULL);
                 ASSERT_CL(err)
 #else
-                err = fetchQueues[r].enqueueWriteBuffer(inBuffers[r],CL_TRUE,0, (1 << LOG_FFT_SIZE) * iterations_per_kernel * 2 * sizeof(HOST_DATA_TYPE), &data[r * (1 << LOG_FFT_SIZE) * iterations_per_kernel]);
+                err = fetchQueues[r].enqueueWriteBuffer(inBuffers[r],CL_TRUE,0, fft_size * iterations_per_kernel * 2 * sizeof(HOST_DATA_TYPE), &data[r * fft_size * iterations_per_kernel]);
                 ASSERT_CL(err)
 #endif
         }
 
         std::vector<double> calculationTimings;
+        std::vector<double> reorderTimings;
         for (uint r =0; r < config.programSettings->numRepetitions; r++) {
             auto startCalculation = std::chrono::high_resolution_clock::now();
             for (int r=0; r < config.programSettings->kernelReplications; r++) {
@@ -194,25 +241,44 @@ namespace bm_execution {
                     std::chrono::duration_cast<std::chrono::duration<double>>
                             (endCalculation - startCalculation);
             calculationTimings.push_back(calculationTime.count());
+
+            if (in_order) {
+                // The reordering is measured separately to report the cost of the in-order output
+                auto startReorder = std::chrono::high_resolution_clock::now();
+                for (int r=0; r < config.programSettings->kernelReplications; r++) {
+                    fetchQueues[r].enqueueNDRangeKernel(reorderKernels[r], cl::NullRange, cl::NDRange(1), cl::NDRange(1));
+                }
+                for (int r=0; r < config.programSettings->kernelReplications; r++) {
+                    fetchQueues[r].finish();
+                }
+                auto endReorder = std::chrono::high_resolution_clock::now();
+                std::chrono::duration<double> reorderTime =
+                        std::chrono::duration_cast<std::chrono::duration<double>>
+                                (endReorder - startReorder);
+                reorderTimings.push_back(reorderTime.count());
+            }
         }
         for (int r=0; r < config.programSettings->kernelReplications; r++) {
 #ifdef USE_SVM
                 err = clEnqueueSVMUnmap(fetchQueues[r](),
-                                        reinterpret_cast<void *>(&data[r * (1 << LOG_FFT_SIZE) * iterations_per_kernel]), 0,
+                                        reinterpret_cast<void *>(&data[r * fft_size * iterations_per_kernel]), 0,
                                         NULL, NULL);
                 ASSERT_CL(err)
                 err = clEnqueueSVMUnmap(fftQueues[r](),
-                                        reinterpret_cast<void *>(&data_out[r * (1 << LOG_FFT_SIZE) * iterations_per_kernel]), 0,
+                                        reinterpret_cast<void *>(&data_out[r * fft_size * iterations_per_kernel]), 0,
                                         NULL, NULL);
                 ASSERT_CL(err)
 #else
-                err = fetchQueues[r].enqueueReadBuffer(outBuffers[r],CL_TRUE,0, (1 << LOG_FFT_SIZE) * iterations_per_kernel * 2 * sizeof(HOST_DATA_TYPE), &data_out[r * (1 << LOG_FFT_SIZE) * iterations_per_kernel]);
+                err = fetchQueues[r].enqueueReadBuffer(in_order ? reorderBuffers[r] : outBuffers[r],CL_TRUE,0, fft_size * iterations_per_kernel * 2 * sizeof(HOST_DATA_TYPE), &data_out[r * fft_size * iterations_per_kernel]);
                 ASSERT_CL(err)
 #endif
         }
         std::map<std::string, std::vector<double>> timings;
 
         timings["execution"] = calculationTimings;
+        if (in_order) {
+            timings["reorder"] = reorderTimings;
+        }
 
         return timings;
     }
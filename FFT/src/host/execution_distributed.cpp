@@ -0,0 +1,209 @@
+/*
+Copyright (c) 2023 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* Related header files */
+#include "execution.h"
+
+/* C++ standard library headers */
+#include <memory>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <cstring>
+
+/* External library headers */
+#ifdef INTEL_FPGA
+#ifdef USE_HBM
+// CL_HETEROGENEOUS_INTELFPGA is defined here
+#include "CL/cl_ext_intelfpga.h"
+#endif
+#endif
+
+namespace bm_execution {
+
+    /*
+    Implementation for the distributed FFT using the FFT kernel for the local FFTs.
+     @copydoc bm_execution::calculateDistributed()
+    */
+    std::map<std::string, std::vector<double>>
+    calculateDistributed(hpcc_base::ExecutionSettings<fft::FFTProgramSettings, cl::Device, cl::Context, cl::Program> const&  config,
+            std::complex<HOST_DATA_TYPE>* data,
+            std::complex<HOST_DATA_TYPE>* data_out,
+            bool inverse,
+            uint log_size) {
+
+        int err;
+        int mpi_size = 1;
+#ifdef _USE_MPI_
+        MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+#endif
+
+        std::vector<cl::Buffer> inBuffers;
+        std::vector<cl::Buffer> outBuffers;
+        std::vector<cl::Kernel> fetchKernels;
+        std::vector<cl::Kernel> fftKernels;
+        std::vector<cl::Kernel> storeKernels;
+        std::vector<cl::CommandQueue> fetchQueues;
+        std::vector<cl::CommandQueue> fftQueues;
+        std::vector<cl::CommandQueue> storeQueues;
+
+        const size_t fft_size = static_cast<size_t>(1) << log_size;
+        // Every rank calculates the FFTs over its local rows of the n x n matrix in both FFT passes
+        const size_t local_rows = fft_size / mpi_size;
+        const cl_uint rows_per_kernel = local_rows / config.programSettings->kernelReplications;
+        const size_t buffer_size = fft_size * rows_per_kernel * 2 * sizeof(HOST_DATA_TYPE);
+
+        for (int r=0; r < config.programSettings->kernelReplications; r++) {
+                // Array of flags for each buffer that is allocated in this benchmark
+                // The content of the flags will be changed according to the used compiler flags
+                // to support different kinds of devices
+                int memory_bank_info[2] = {0};
+#ifdef INTEL_FPGA
+#ifdef USE_HBM
+                // For Intel HBM the buffers have to be created with a special flag
+                for (int& v : memory_bank_info) {
+                         v = CL_MEM_HETEROGENEOUS_INTELFPGA;
+                }
+#else
+                // Set the memory bank bits if memory interleaving is not used
+                if (!config.programSettings->useMemoryInterleaving) {
+                        for (int k = 0; k < 2; k++) {
+                                memory_bank_info[k] = (((2 * r) + 1 + k) << 16);
+                        }
+                }
+#endif
+#endif
+                inBuffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[0], buffer_size, NULL, &err));
+                ASSERT_CL(err)
+                outBuffers.push_back(cl::Buffer(*config.context, CL_MEM_WRITE_ONLY | memory_bank_info[1], buffer_size, NULL, &err));
+                ASSERT_CL(err)
+
+        #ifdef INTEL_FPGA
+                cl::Kernel fetchKernel(*config.program, getKernelName(FETCH_KERNEL_NAME, log_size, r).c_str(), &err);
+                ASSERT_CL(err)
+                cl::Kernel fftKernel(*config.program, getKernelName(FFT_KERNEL_NAME, log_size, r).c_str(), &err);
+                ASSERT_CL(err)
+                err = fftKernel.setArg(0, outBuffers[r]);
+                ASSERT_CL(err)
+                err = fftKernel.setArg(1, rows_per_kernel);
+                ASSERT_CL(err)
+                err = fftKernel.setArg(2, static_cast<cl_int>(inverse));
+                ASSERT_CL(err)
+        #endif
+
+        #ifdef XILINX_FPGA
+                std::string fetchName = getKernelName(FETCH_KERNEL_NAME, log_size, r);
+                std::string fftName = getKernelName(FFT_KERNEL_NAME, log_size, r);
+                std::string storeName = getKernelName(STORE_KERNEL_NAME, log_size, r);
+                cl::Kernel fetchKernel(*config.program, (fetchName + ":{" + fetchName + "_1"  + "}").c_str(), &err);
+                ASSERT_CL(err)
+                cl::Kernel fftKernel(*config.program, (fftName + ":{" + fftName + "_1" + "}").c_str(), &err);
+                ASSERT_CL(err)
+                cl::Kernel storeKernel(*config.program, (storeName + ":{" + storeName + "_1" + "}").c_str(), &err);
+                ASSERT_CL(err)
+                err = storeKernel.setArg(0, outBuffers[r]);
+                ASSERT_CL(err)
+                err = storeKernel.setArg(1, rows_per_kernel);
+                ASSERT_CL(err)
+
+                err = fftKernel.setArg(0, rows_per_kernel);
+                ASSERT_CL(err)
+                err = fftKernel.setArg(1, static_cast<cl_int>(inverse));
+                ASSERT_CL(err)
+
+                storeQueues.push_back(cl::CommandQueue(*config.context, *config.device, 0, &err));
+                ASSERT_CL(err)
+
+                storeKernels.push_back(storeKernel);
+        #endif
+
+                err = fetchKernel.setArg(0, inBuffers[r]);
+                ASSERT_CL(err)
+                err = fetchKernel.setArg(1, rows_per_kernel);
+                ASSERT_CL(err)
+
+                fetchQueues.push_back(cl::CommandQueue(*config.context, *config.device, 0, &err));
+                ASSERT_CL(err)
+                fftQueues.push_back(cl::CommandQueue(*config.context, *config.device, 0, &err));
+                ASSERT_CL(err)
+
+                fetchKernels.push_back(fetchKernel);
+                fftKernels.push_back(fftKernel);
+        }
+
+        // Calculate the FFTs over all local rows on the FPGA. The result of every FFT is in bit reversed order.
+        auto calculateLocalFFTs = [&](std::complex<HOST_DATA_TYPE>* in, std::complex<HOST_DATA_TYPE>* out) {
+            for (int r=0; r < config.programSettings->kernelReplications; r++) {
+                err = fetchQueues[r].enqueueWriteBuffer(inBuffers[r], CL_FALSE, 0, buffer_size, &in[r * fft_size * rows_per_kernel]);
+                ASSERT_CL(err)
+                fetchQueues[r].enqueueNDRangeKernel(fetchKernels[r], cl::NullRange, cl::NDRange(1), cl::NDRange(1));
+                fftQueues[r].enqueueNDRangeKernel(fftKernels[r], cl::NullRange, cl::NDRange(1), cl::NDRange(1));
+        #ifdef XILINX_FPGA
+                storeQueues[r].enqueueNDRangeKernel(storeKernels[r], cl::NullRange, cl::NDRange(1), cl::NDRange(1));
+        #endif
+            }
+            for (int r=0; r < config.programSettings->kernelReplications; r++) {
+                fetchQueues[r].finish();
+                fftQueues[r].finish();
+#ifdef XILINX_FPGA
+                storeQueues[r].finish();
+#endif
+                err = fetchQueues[r].enqueueReadBuffer(outBuffers[r], CL_TRUE, 0, buffer_size, &out[r * fft_size * rows_per_kernel]);
+                ASSERT_CL(err)
+            }
+        };
+
+        std::vector<std::complex<HOST_DATA_TYPE>> work_in(local_rows * fft_size);
+        std::vector<std::complex<HOST_DATA_TYPE>> work_out(local_rows * fft_size);
+
+        std::vector<double> calculationTimings;
+        std::vector<double> communicationTimings;
+        for (uint rep = 0; rep < config.programSettings->numRepetitions; rep++) {
+#ifdef _USE_MPI_
+            MPI_Barrier(MPI_COMM_WORLD);
+#endif
+            auto startCalculation = std::chrono::high_resolution_clock::now();
+            double communicationTime = 0.0;
+            // The input is interpreted as n x n matrix in row-major order with the rows distributed over all ranks.
+            // The transposition uses the input array as receive buffer, so the input data is copied first
+            std::memcpy(work_in.data(), data, work_in.size() * sizeof(std::complex<HOST_DATA_TYPE>));
+            communicationTime += fft::distributed_transpose(work_in.data(), work_out.data(), log_size, false, 0);
+            calculateLocalFFTs(work_out.data(), work_in.data());
+            communicationTime += fft::distributed_transpose(work_in.data(), work_out.data(), log_size, true, inverse ? 1 : -1);
+            calculateLocalFFTs(work_out.data(), work_in.data());
+            communicationTime += fft::distributed_transpose(work_in.data(), data_out, log_size, true, 0);
+            auto endCalculation = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double> calculationTime =
+                    std::chrono::duration_cast<std::chrono::duration<double>>
+                            (endCalculation - startCalculation);
+            calculationTimings.push_back(calculationTime.count());
+            communicationTimings.push_back(communicationTime);
+        }
+        std::map<std::string, std::vector<double>> timings;
+
+        timings["execution"] = calculationTimings;
+        timings["communication"] = communicationTimings;
+
+        return timings;
+    }
+
+}  // namespace bm_execution
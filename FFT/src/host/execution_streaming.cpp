@@ -0,0 +1,269 @@
+/*
+Copyright (c) 2023 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* Related header files */
+#include "execution.h"
+
+/* C++ standard library headers */
+#include <memory>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <algorithm>
+
+/* External library headers */
+#ifdef INTEL_FPGA
+#ifdef USE_HBM
+// CL_HETEROGENEOUS_INTELFPGA is defined here
+#include "CL/cl_ext_intelfpga.h"
+#endif
+#endif
+
+namespace bm_execution {
+
+    /*
+    Implementation for the streaming execution of the FFT kernel.
+     @copydoc bm_execution::calculateStreaming()
+    */
+    std::map<std::string, std::vector<double>>
+    calculateStreaming(hpcc_base::ExecutionSettings<fft::FFTProgramSettings, cl::Device, cl::Context, cl::Program> const&  config,
+            std::complex<HOST_DATA_TYPE>* data,
+            std::complex<HOST_DATA_TYPE>* data_out,
+            unsigned iterations,
+            bool inverse,
+            uint log_size) {
+
+        int err;
+
+        // Number of buffers in the ring of every kernel replication. With three buffers, the write of the next chunk,
+        // the calculation of the current chunk and the read of the previous chunk can be executed at the same time
+        const int ring_size = 3;
+
+        const size_t fft_size = static_cast<size_t>(1) << log_size;
+        const cl_uint chunk_size = config.programSettings->streamChunkSize;
+        const size_t chunk_bytes = fft_size * chunk_size * 2 * sizeof(HOST_DATA_TYPE);
+        const uint chunks = iterations / chunk_size;
+        const size_t chunk_values = fft_size * chunk_size;
+        // Every repetition samples another chunk of the stream for the validation
+        const uint samples = std::min<uint>(config.programSettings->numRepetitions, chunks);
+
+        std::vector<std::vector<cl::Buffer>> inBuffers(config.programSettings->kernelReplications);
+        std::vector<std::vector<cl::Buffer>> outBuffers(config.programSettings->kernelReplications);
+        // Pinned host buffers that are used as source and destination of the transfers
+        std::vector<std::vector<cl::Buffer>> hostInBuffers(config.programSettings->kernelReplications);
+        std::vector<std::vector<cl::Buffer>> hostOutBuffers(config.programSettings->kernelReplications);
+        std::vector<std::vector<std::complex<HOST_DATA_TYPE>*>> hostInPointers(config.programSettings->kernelReplications);
+        std::vector<std::vector<std::complex<HOST_DATA_TYPE>*>> hostOutPointers(config.programSettings->kernelReplications);
+        std::vector<cl::Kernel> fetchKernels;
+        std::vector<cl::Kernel> fftKernels;
+        std::vector<cl::Kernel> storeKernels;
+        std::vector<cl::CommandQueue> writeQueues;
+        std::vector<cl::CommandQueue> readQueues;
+        std::vector<cl::CommandQueue> fetchQueues;
+        std::vector<cl::CommandQueue> fftQueues;
+        std::vector<cl::CommandQueue> storeQueues;
+
+        for (int r=0; r < config.programSettings->kernelReplications; r++) {
+                // Array of flags for each buffer that is allocated in this benchmark
+                // The content of the flags will be changed according to the used compiler flags
+                // to support different kinds of devices
+                int memory_bank_info[2] = {0};
+#ifdef INTEL_FPGA
+#ifdef USE_HBM
+                // For Intel HBM the buffers have to be created with a special flag
+                for (int& v : memory_bank_info) {
+                         v = CL_MEM_HETEROGENEOUS_INTELFPGA;
+                }
+#else
+                // Set the memory bank bits if memory interleaving is not used
+                if (!config.programSettings->useMemoryInterleaving) {
+                        for (int k = 0; k < 2; k++) {
+                                memory_bank_info[k] = (((2 * r) + 1 + k) << 16);
+                        }
+                }
+#endif
+#endif
+                writeQueues.push_back(cl::CommandQueue(*config.context, *config.device, 0, &err));
+                ASSERT_CL(err)
+                readQueues.push_back(cl::CommandQueue(*config.context, *config.device, 0, &err));
+                ASSERT_CL(err)
+                for (int slot = 0; slot < ring_size; slot++) {
+                        inBuffers[r].push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[0], chunk_bytes, NULL, &err));
+                        ASSERT_CL(err)
+                        outBuffers[r].push_back(cl::Buffer(*config.context, CL_MEM_WRITE_ONLY | memory_bank_info[1], chunk_bytes, NULL, &err));
+                        ASSERT_CL(err)
+                        hostInBuffers[r].push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | CL_MEM_ALLOC_HOST_PTR, chunk_bytes, NULL, &err));
+                        ASSERT_CL(err)
+                        hostOutBuffers[r].push_back(cl::Buffer(*config.context, CL_MEM_WRITE_ONLY | CL_MEM_ALLOC_HOST_PTR, chunk_bytes, NULL, &err));
+                        ASSERT_CL(err)
+                        hostInPointers[r].push_back(reinterpret_cast<std::complex<HOST_DATA_TYPE>*>(
+                                writeQueues[r].enqueueMapBuffer(hostInBuffers[r][slot], CL_TRUE, CL_MAP_WRITE, 0, chunk_bytes, NULL, NULL, &err)));
+                        ASSERT_CL(err)
+                        hostOutPointers[r].push_back(reinterpret_cast<std::complex<HOST_DATA_TYPE>*>(
+                                readQueues[r].enqueueMapBuffer(hostOutBuffers[r][slot], CL_TRUE, CL_MAP_READ, 0, chunk_bytes, NULL, NULL, &err)));
+                        ASSERT_CL(err)
+                }
+
+        #ifdef INTEL_FPGA
+                cl::Kernel fetchKernel(*config.program, getKernelName(FETCH_KERNEL_NAME, log_size, r).c_str(), &err);
+                ASSERT_CL(err)
+                cl::Kernel fftKernel(*config.program, getKernelName(FFT_KERNEL_NAME, log_size, r).c_str(), &err);
+                ASSERT_CL(err)
+                err = fftKernel.setArg(1, chunk_size);
+                ASSERT_CL(err)
+                err = fftKernel.setArg(2, static_cast<cl_int>(inverse));
+                ASSERT_CL(err)
+        #endif
+
+        #ifdef XILINX_FPGA
+                std::string fetchName = getKernelName(FETCH_KERNEL_NAME, log_size, r);
+                std::string fftName = getKernelName(FFT_KERNEL_NAME, log_size, r);
+                std::string storeName = getKernelName(STORE_KERNEL_NAME, log_size, r);
+                cl::Kernel fetchKernel(*config.program, (fetchName + ":{" + fetchName + "_1"  + "}").c_str(), &err);
+                ASSERT_CL(err)
+                cl::Kernel fftKernel(*config.program, (fftName + ":{" + fftName + "_1" + "}").c_str(), &err);
+                ASSERT_CL(err)
+                cl::Kernel storeKernel(*config.program, (storeName + ":{" + storeName + "_1" + "}").c_str(), &err);
+                ASSERT_CL(err)
+                err = storeKernel.setArg(1, chunk_size);
+                ASSERT_CL(err)
+
+                err = fftKernel.setArg(0, chunk_size);
+                ASSERT_CL(err)
+                err = fftKernel.setArg(1, static_cast<cl_int>(inverse));
+                ASSERT_CL(err)
+
+                storeQueues.push_back(cl::CommandQueue(*config.context, *config.device, 0, &err));
+                ASSERT_CL(err)
+
+                storeKernels.push_back(storeKernel);
+        #endif
+
+                err = fetchKernel.setArg(1, chunk_size);
+                ASSERT_CL(err)
+
+                fetchQueues.push_back(cl::CommandQueue(*config.context, *config.device, 0, &err));
+                ASSERT_CL(err)
+                fftQueues.push_back(cl::CommandQueue(*config.context, *config.device, 0, &err));
+                ASSERT_CL(err)
+
+                fetchKernels.push_back(fetchKernel);
+                fftKernels.push_back(fftKernel);
+        }
+
+        std::vector<std::vector<cl::Event>> readEvents(config.programSettings->kernelReplications, std::vector<cl::Event>(ring_size));
+
+        std::vector<double> calculationTimings;
+        for (uint rep = 0; rep < config.programSettings->numRepetitions; rep++) {
+            // The sampled chunks are spread evenly over the stream
+            const uint sample = rep % samples;
+            const uint sampled_chunk = static_cast<uint>(static_cast<uint64_t>(sample) * chunks / samples);
+            std::complex<HOST_DATA_TYPE>* sample_out = data_out + sample * chunk_values;
+            auto startCalculation = std::chrono::high_resolution_clock::now();
+            // The chunks are assigned to the kernel replications in a round-robin fashion.
+            // Every replication cycles through its ring of buffers.
+            for (uint c = 0; c < chunks; c++) {
+                const int r = c % config.programSettings->kernelReplications;
+                const uint sequence = c / config.programSettings->kernelReplications;
+                const int slot = sequence % ring_size;
+                // The buffers of the slot can only be reused after the result of the previous chunk was read back
+                if (sequence >= ring_size) {
+                    readEvents[r][slot].wait();
+                    // Keep the result of the sampled chunk before its buffers are reused
+                    if (c - ring_size * config.programSettings->kernelReplications == sampled_chunk) {
+                        std::copy(hostOutPointers[r][slot], hostOutPointers[r][slot] + chunk_values, sample_out);
+                    }
+                }
+                // Every chunk of the stream gets a different input
+                fft::generate_stream_chunk(hostInPointers[r][slot], chunk_values, c);
+
+                cl::Event writeEvent;
+                err = writeQueues[r].enqueueWriteBuffer(inBuffers[r][slot], CL_FALSE, 0, chunk_bytes, hostInPointers[r][slot], NULL, &writeEvent);
+                ASSERT_CL(err)
+                std::vector<cl::Event> writeEvents({writeEvent});
+
+                err = fetchKernels[r].setArg(0, inBuffers[r][slot]);
+                ASSERT_CL(err)
+                cl::Event calculationEvent;
+                err = fetchQueues[r].enqueueNDRangeKernel(fetchKernels[r], cl::NullRange, cl::NDRange(1), cl::NDRange(1), &writeEvents);
+                ASSERT_CL(err)
+        #ifdef INTEL_FPGA
+                err = fftKernels[r].setArg(0, outBuffers[r][slot]);
+                ASSERT_CL(err)
+                err = fftQueues[r].enqueueNDRangeKernel(fftKernels[r], cl::NullRange, cl::NDRange(1), cl::NDRange(1), NULL, &calculationEvent);
+                ASSERT_CL(err)
+        #endif
+        #ifdef XILINX_FPGA
+                err = fftQueues[r].enqueueNDRangeKernel(fftKernels[r], cl::NullRange, cl::NDRange(1), cl::NDRange(1));
+                ASSERT_CL(err)
+                err = storeKernels[r].setArg(0, outBuffers[r][slot]);
+                ASSERT_CL(err)
+                err = storeQueues[r].enqueueNDRangeKernel(storeKernels[r], cl::NullRange, cl::NDRange(1), cl::NDRange(1), NULL, &calculationEvent);
+                ASSERT_CL(err)
+                storeQueues[r].flush();
+        #endif
+                std::vector<cl::Event> calculationEvents({calculationEvent});
+                err = readQueues[r].enqueueReadBuffer(outBuffers[r][slot], CL_FALSE, 0, chunk_bytes, hostOutPointers[r][slot], &calculationEvents, &readEvents[r][slot]);
+                ASSERT_CL(err)
+                writeQueues[r].flush();
+                fetchQueues[r].flush();
+                fftQueues[r].flush();
+                readQueues[r].flush();
+            }
+            for (int r=0; r < config.programSettings->kernelReplications; r++) {
+                readQueues[r].finish();
+            }
+            auto endCalculation = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double> calculationTime =
+                    std::chrono::duration_cast<std::chrono::duration<double>>
+                            (endCalculation - startCalculation);
+            calculationTimings.push_back(calculationTime.count());
+
+            // The result of the sampled chunk is still in its buffers, if they were not reused by a later chunk
+            if (sampled_chunk + ring_size * config.programSettings->kernelReplications >= chunks) {
+                const int sampled_replication = sampled_chunk % config.programSettings->kernelReplications;
+                const int sampled_slot = (sampled_chunk / config.programSettings->kernelReplications) % ring_size;
+                std::copy(hostOutPointers[sampled_replication][sampled_slot], hostOutPointers[sampled_replication][sampled_slot] + chunk_values, sample_out);
+            }
+            // Generate the input of the sampled chunk again outside of the measurement for the validation
+            fft::generate_stream_chunk(data + sample * chunk_values, chunk_values, sampled_chunk);
+        }
+
+        for (int r=0; r < config.programSettings->kernelReplications; r++) {
+            for (int slot = 0; slot < ring_size; slot++) {
+                err = writeQueues[r].enqueueUnmapMemObject(hostInBuffers[r][slot], hostInPointers[r][slot]);
+                ASSERT_CL(err)
+                err = readQueues[r].enqueueUnmapMemObject(hostOutBuffers[r][slot], hostOutPointers[r][slot]);
+                ASSERT_CL(err)
+            }
+            writeQueues[r].finish();
+            readQueues[r].finish();
+        }
+
+        std::map<std::string, std::vector<double>> timings;
+
+        timings["execution"] = calculationTimings;
+
+        return timings;
+    }
+
+}  // namespace bm_execution
@@ -27,39 +27,70 @@ SOFTWARE.
 #include "fft_benchmark.hpp"
 
 /* C++ standard library headers */
+#include <algorithm>
 #include <memory>
 #include <random>
+#include <sstream>
 
 /* Project's headers */
 #include "execution.h"
 #include "parameters.h"
 
 fft::FFTProgramSettings::FFTProgramSettings(cxxopts::ParseResult &results) : hpcc_base::BaseSettings(results),
-    iterations(results["b"].as<uint>()), inverse(results.count("inverse")) {
-
+    iterations(results["b"].as<uint>()), inverse(results.count("inverse")),
+    logFFTSizes(results["log-size"].as<std::vector<uint>>()), dimensions(results["dimensions"].as<uint>()),
+    distributed(results.count("distributed")), streamChunkSize(results["stream-chunk"].as<uint>()),
+    real(results.count("real")), inOrder(results.count("in-order")) {
+#ifndef FFT_REORDER_KERNEL
+    if (inOrder) {
+        std::cerr << "WARNING: The kernel file does not contain reorder kernels. The output will be bit reversed on the host instead." << std::endl;
+        inOrder = false;
+    }
+#endif
 }
 
 std::map<std::string, std::string>
 fft::FFTProgramSettings::getSettingsMap() {
         auto map = hpcc_base::BaseSettings::getSettingsMap();
-        map["FFT Size"] = std::to_string(1 << LOG_FFT_SIZE);
+        std::string sizes;
+        for (auto log_size : logFFTSizes) {
+            sizes += (sizes.empty() ? "" : ",") + std::to_string(1 << log_size);
+        }
+        map["FFT Size"] = sizes;
+        map["Dimensions"] = std::to_string(dimensions);
+        map["Distributed"] = distributed ? "Yes" : "No";
+        if (streamChunkSize > 0) {
+            map["Stream Chunk Size"] = std::to_string(streamChunkSize);
+        }
         map["Batch Size"] = std::to_string(iterations);
         map["Inverse"] = inverse ? "Yes" : "No";
+        map["Real"] = real ? "Yes" : "No";
+        map["In-Order Output"] = inOrder ? "Yes" : "No";
         return map;
 }
 
-fft::FFTData::FFTData(cl::Context context, uint iterations) : context(context) {
+fft::FFTData::FFTData(cl::Context context, const std::vector<size_t>& sizes, bool real) : context(context), real_data(nullptr) {
+    // The batches of all FFT sizes are stored one after another
+    size_t total_size = 0;
+    for (auto size : sizes) {
+        offsets.push_back(total_size);
+        total_size += size;
+    }
 #ifdef USE_SVM
     data = reinterpret_cast<std::complex<HOST_DATA_TYPE>*>(
                         clSVMAlloc(context(), 0 ,
-                        iterations * (1 << LOG_FFT_SIZE) * sizeof(std::complex<HOST_DATA_TYPE>), 1024));
+                        total_size * sizeof(std::complex<HOST_DATA_TYPE>), 1024));
     data_out = reinterpret_cast<std::complex<HOST_DATA_TYPE>*>(
                         clSVMAlloc(context(), 0 ,
-                        iterations * (1 << LOG_FFT_SIZE) * sizeof(std::complex<HOST_DATA_TYPE>), 1024));
+                        total_size * sizeof(std::complex<HOST_DATA_TYPE>), 1024));
 #else
-    posix_memalign(reinterpret_cast<void**>(&data), 64, iterations * (1 << LOG_FFT_SIZE) * sizeof(std::complex<HOST_DATA_TYPE>));
-    posix_memalign(reinterpret_cast<void**>(&data_out), 64, iterations * (1 << LOG_FFT_SIZE) * sizeof(std::complex<HOST_DATA_TYPE>));
+    posix_memalign(reinterpret_cast<void**>(&data), 64, total_size * sizeof(std::complex<HOST_DATA_TYPE>));
+    posix_memalign(reinterpret_cast<void**>(&data_out), 64, total_size * sizeof(std::complex<HOST_DATA_TYPE>));
 #endif
+    if (real) {
+        // Every complex FFT contains two real signals
+        posix_memalign(reinterpret_cast<void**>(&real_data), 64, 2 * total_size * sizeof(HOST_DATA_TYPE));
+    }
 }
 
 fft::FFTData::~FFTData() {
@@ -70,6 +101,7 @@ fft::FFTData::~FFTData() {
     free(data);
     free(data_out);
 #endif
+    free(real_data);
 }
 
 fft::FFTBenchmark::FFTBenchmark(int argc, char* argv[]) : HpccFpgaBenchmark(argc, argv) {
@@ -83,86 +115,467 @@ fft::FFTBenchmark::addAdditionalParseOptions(cxxopts::Options &options) {
     options.add_options()
             ("b", "Number of batched FFT calculations (iterations)",
              cxxopts::value<uint>()->default_value(std::to_string(DEFAULT_ITERATIONS)))
-            ("inverse", "If set, the inverse FFT is calculated instead");
+            ("inverse", "If set, the inverse FFT is calculated instead")
+            ("log-size", "Log2 of the FFT sizes that are measured as comma separated list. The kernel file has to contain kernels for all given sizes.",
+             cxxopts::value<std::vector<uint>>()->default_value(DEFAULT_FFT_LOG_SIZES))
+            ("dimensions", "Number of dimensions of the FFT. The FFT size is used for every dimension.",
+             cxxopts::value<uint>()->default_value("1"))
+            ("distributed", "If set, a single 1D FFT with the squared FFT size is distributed over all MPI ranks instead of calculating independent batches")
+            ("stream-chunk", "Number of FFTs per chunk for the streaming execution. The batch is streamed through the device chunk by chunk including the host transfers. If 0, the whole batch is stored on the device.",
+             cxxopts::value<uint>()->default_value("0"))
+            ("real", "If set, the batch consists of real signals. The FFT calculates their half spectra (R2C), the iFFT calculates real signals from half spectra (C2R). Two real FFTs are packed into a single complex FFT.")
+            ("in-order", "If set, the output of the FFT kernel is reordered into natural order on the device with an additional reorder kernel. The time of the reordering is reported separately.");
+}
+
+std::string
+fft::FFTBenchmark::getSizeSuffix(size_t index) const {
+    if (index == 0) {
+        return "";
+    }
+    return "_" + std::to_string(1 << executionSettings->programSettings->logFFTSizes[index]);
+}
+
+size_t
+fft::FFTBenchmark::getLocalDataSize(size_t index) const {
+    const uint log_size = executionSettings->programSettings->logFFTSizes[index];
+    if (executionSettings->programSettings->distributed) {
+        // Every rank stores a block of rows of the n x n matrix
+        return (static_cast<size_t>(1) << (2 * log_size)) / mpi_comm_size;
+    }
+    if (executionSettings->programSettings->streamChunkSize > 0) {
+        // Only the chunks that are sampled for the validation are stored on the host, one for every repetition
+        const uint chunks = executionSettings->programSettings->iterations / executionSettings->programSettings->streamChunkSize;
+        const uint samples = std::min<uint>(executionSettings->programSettings->numRepetitions, chunks);
+        return static_cast<size_t>(samples) * executionSettings->programSettings->streamChunkSize << log_size;
+    }
+    if (executionSettings->programSettings->real) {
+        // Two real signals are packed into a single complex FFT
+        return static_cast<size_t>(executionSettings->programSettings->iterations / 2) << log_size;
+    }
+    return static_cast<size_t>(executionSettings->programSettings->iterations) << (log_size * executionSettings->programSettings->dimensions);
 }
 
 void
 fft::FFTBenchmark::executeKernel(FFTData &data) {
-    timings = bm_execution::calculate(*executionSettings, data.data, data.data_out, executionSettings->programSettings->iterations,
-                                         executionSettings->programSettings->inverse);
+    timings.clear();
+    for (size_t s = 0; s < executionSettings->programSettings->logFFTSizes.size(); s++) {
+        std::map<std::string, std::vector<double>> size_timings;
+        if (executionSettings->programSettings->distributed) {
+            size_timings = bm_execution::calculateDistributed(*executionSettings, data.data + data.offsets[s], data.data_out + data.offsets[s],
+                                                    executionSettings->programSettings->inverse,
+                                                    executionSettings->programSettings->logFFTSizes[s]);
+        }
+        else if (executionSettings->programSettings->streamChunkSize > 0) {
+            size_timings = bm_execution::calculateStreaming(*executionSettings, data.data + data.offsets[s], data.data_out + data.offsets[s],
+                                                    executionSettings->programSettings->iterations,
+                                                    executionSettings->programSettings->inverse,
+                                                    executionSettings->programSettings->logFFTSizes[s]);
+        }
+        else if (executionSettings->programSettings->real) {
+            const uint log_size = executionSettings->programSettings->logFFTSizes[s];
+            const uint pairs = executionSettings->programSettings->iterations / 2;
+            // The pairs of real signals or half spectra are packed on the host into the complex input of the FFT kernel
+            // and the result is separated again afterwards
+            if (executionSettings->programSettings->inverse) {
+                fft::pack_real_spectra(data.data + data.offsets[s], data.data_out + data.offsets[s], pairs, log_size);
+                size_timings = bm_execution::calculate(*executionSettings, data.data_out + data.offsets[s], data.data_out + data.offsets[s],
+                                                    pairs, true, log_size);
+                fft::unpack_real_signals(data.data_out + data.offsets[s], data.real_data + 2 * data.offsets[s], pairs, log_size);
+            }
+            else {
+                fft::pack_real_signals(data.real_data + 2 * data.offsets[s], data.data + data.offsets[s], pairs, log_size);
+                size_timings = bm_execution::calculate(*executionSettings, data.data + data.offsets[s], data.data_out + data.offsets[s],
+                                                    pairs, false, log_size);
+                fft::unpack_real_spectra(data.data_out + data.offsets[s], pairs, log_size);
+            }
+        }
+        else if (executionSettings->programSettings->dimensions > 1) {
+            size_timings = bm_execution::calculateMultiDimensional(*executionSettings, data.data + data.offsets[s], data.data_out + data.offsets[s],
+                                                    executionSettings->programSettings->iterations,
+                                                    executionSettings->programSettings->inverse,
+                                                    executionSettings->programSettings->logFFTSizes[s],
+                                                    executionSettings->programSettings->dimensions);
+        }
+        else {
+            size_timings = bm_execution::calculate(*executionSettings, data.data + data.offsets[s], data.data_out + data.offsets[s],
+                                                    executionSettings->programSettings->iterations,
+                                                    executionSettings->programSettings->inverse,
+                                                    executionSettings->programSettings->logFFTSizes[s]);
+        }
+        for (auto& t : size_timings) {
+            timings[t.first + getSizeSuffix(s)] = t.second;
+        }
+    }
 }
 
 void
 fft::FFTBenchmark::collectResults() {
-    double gflop = static_cast<double>(5 * (1 << LOG_FFT_SIZE) * LOG_FFT_SIZE) * executionSettings->programSettings->iterations * 1.0e-9 * mpi_comm_size;
+    for (size_t s = 0; s < executionSettings->programSettings->logFFTSizes.size(); s++) {
+        if (executionSettings->programSettings->distributed) {
+            collectDistributedResults(s);
+            continue;
+        }
+        // A multidimensional FFT consists of 1D FFTs over all dimensions, which results in 5 * N * log2(N) FLOP
+        // with N being the total number of values
+        uint log_total_size = executionSettings->programSettings->logFFTSizes[s] * executionSettings->programSettings->dimensions;
+        std::string suffix = getSizeSuffix(s);
+        double gflop = 5.0 * static_cast<double>(static_cast<size_t>(1) << log_total_size) * log_total_size * executionSettings->programSettings->iterations * 1.0e-9 * mpi_comm_size;
+        if (executionSettings->programSettings->real) {
+            // A real FFT only needs half of the FLOP of a complex FFT of the same size, i.e. 2.5 * N * log2(N)
+            gflop /= 2.0;
+        }
+
+        uint number_measurements = timings["execution" + suffix].size();
+        std::vector<double> avg_measures(number_measurements);
+#ifdef _USE_MPI_
+        // Copy the object variable to a local variable to make it accessible to the lambda function
+        int mpi_size = mpi_comm_size;
+        MPI_Reduce(timings["execution" + suffix].data(), avg_measures.data(), number_measurements, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+        std::for_each(avg_measures.begin(),avg_measures.end(), [mpi_size](double& x) {x /= mpi_size;});
+#else
+        std::copy(timings["execution" + suffix].begin(), timings["execution" + suffix].end(), avg_measures.begin());
+#endif
+        if (mpi_comm_rank == 0) {
+            double minTime = *min_element(avg_measures.begin(), avg_measures.end());
+            double avgTime = accumulate(avg_measures.begin(), avg_measures.end(), 0.0) / avg_measures.size();
+            results.emplace("t_min" + suffix, hpcc_base::HpccResult(minTime / (executionSettings->programSettings->iterations * executionSettings->programSettings->kernelReplications), "s"));
+            results.emplace("t_avg" + suffix, hpcc_base::HpccResult(avgTime / (executionSettings->programSettings->iterations * executionSettings->programSettings->kernelReplications), "s"));
+            results.emplace("gflops_min" + suffix, hpcc_base::HpccResult(gflop / minTime, "GFLOP/s"));
+            results.emplace("gflops_avg" + suffix, hpcc_base::HpccResult(gflop / avgTime, "GFLOP/s"));
+            if (executionSettings->programSettings->streamChunkSize > 0) {
+                // The streaming execution includes all host transfers, so this is the sustained end-to-end rate
+                double transforms = static_cast<double>(executionSettings->programSettings->iterations) * mpi_comm_size;
+                results.emplace("transforms_max" + suffix, hpcc_base::HpccResult(transforms / minTime, "FFT/s"));
+                results.emplace("transforms_avg" + suffix, hpcc_base::HpccResult(transforms / avgTime, "FFT/s"));
+            }
+        }
+        if (executionSettings->programSettings->inOrder) {
+            collectReorderResults(s, gflop);
+        }
+    }
+}
 
-    uint number_measurements = timings["execution"].size();
-    std::vector<double> avg_measures(number_measurements);
+void
+fft::FFTBenchmark::collectReorderResults(size_t index, double gflop) {
+    std::string suffix = getSizeSuffix(index);
+    uint number_measurements = timings["reorder" + suffix].size();
+    std::vector<double> avg_execution(number_measurements);
+    std::vector<double> avg_reorder(number_measurements);
+#ifdef _USE_MPI_
+    MPI_Reduce(timings["execution" + suffix].data(), avg_execution.data(), number_measurements, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(timings["reorder" + suffix].data(), avg_reorder.data(), number_measurements, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+#else
+    std::copy(timings["execution" + suffix].begin(), timings["execution" + suffix].end(), avg_execution.begin());
+    std::copy(timings["reorder" + suffix].begin(), timings["reorder" + suffix].end(), avg_reorder.begin());
+#endif
+    if (mpi_comm_rank == 0) {
+        // The ranks are averaged by dividing the sums of both times, so the size of the communicator cancels out
+        double executionTime = accumulate(avg_execution.begin(), avg_execution.end(), 0.0);
+        double reorderTime = accumulate(avg_reorder.begin(), avg_reorder.end(), 0.0);
+        double avgTime = (executionTime + reorderTime) / (number_measurements * mpi_comm_size);
+        results.emplace("reorder_share" + suffix, hpcc_base::HpccResult(reorderTime / (executionTime + reorderTime), ""));
+        results.emplace("gflops_in_order_avg" + suffix, hpcc_base::HpccResult(gflop / avgTime, "GFLOP/s"));
+    }
+}
+
+void
+fft::FFTBenchmark::collectDistributedResults(size_t index) {
+    // A single FFT of size n^2 is calculated by all ranks together
+    uint log_total_size = 2 * executionSettings->programSettings->logFFTSizes[index];
+    std::string suffix = getSizeSuffix(index);
+    double gflop = 5.0 * static_cast<double>(static_cast<size_t>(1) << log_total_size) * log_total_size * 1.0e-9;
+
+    // The slowest rank determines the execution time of the FFT
+    uint number_measurements = timings["execution" + suffix].size();
+    std::vector<double> max_measures(number_measurements);
+    std::vector<double> max_communication(number_measurements);
 #ifdef _USE_MPI_
-    // Copy the object variable to a local variable to make it accessible to the lambda function
-    int mpi_size = mpi_comm_size;
-    MPI_Reduce(timings.data(), avg_measures.data(), number_measurements, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
-    std::for_each(avg_measures.begin(),avg_measures.end(), [mpi_size](double& x) {x /= mpi_size;});
+    MPI_Reduce(timings["execution" + suffix].data(), max_measures.data(), number_measurements, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Reduce(timings["communication" + suffix].data(), max_communication.data(), number_measurements, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
 #else
-    std::copy(timings["execution"].begin(), timings["execution"].end(), avg_measures.begin());
+    std::copy(timings["execution" + suffix].begin(), timings["execution" + suffix].end(), max_measures.begin());
+    std::copy(timings["communication" + suffix].begin(), timings["communication" + suffix].end(), max_communication.begin());
 #endif
     if (mpi_comm_rank == 0) {
-        double minTime = *min_element(avg_measures.begin(), avg_measures.end());
-        double avgTime = accumulate(avg_measures.begin(), avg_measures.end(), 0.0) / avg_measures.size();
-        results.emplace("t_min", hpcc_base::HpccResult(minTime / (executionSettings->programSettings->iterations * executionSettings->programSettings->kernelReplications), "s"));
-        results.emplace("t_avg", hpcc_base::HpccResult(avgTime / (executionSettings->programSettings->iterations * executionSettings->programSettings->kernelReplications), "s"));
-        results.emplace("gflops_min", hpcc_base::HpccResult(gflop / minTime, "GFLOP/s"));
-        results.emplace("gflops_avg", hpcc_base::HpccResult(gflop / avgTime, "GFLOP/s"));
+        double minTime = *min_element(max_measures.begin(), max_measures.end());
+        double avgTime = accumulate(max_measures.begin(), max_measures.end(), 0.0) / max_measures.size();
+        double avgCommunicationTime = accumulate(max_communication.begin(), max_communication.end(), 0.0) / max_communication.size();
+        results.emplace("t_min" + suffix, hpcc_base::HpccResult(minTime, "s"));
+        results.emplace("t_avg" + suffix, hpcc_base::HpccResult(avgTime, "s"));
+        results.emplace("gflops_min" + suffix, hpcc_base::HpccResult(gflop / minTime, "GFLOP/s"));
+        results.emplace("gflops_avg" + suffix, hpcc_base::HpccResult(gflop / avgTime, "GFLOP/s"));
+        results.emplace("t_comm_avg" + suffix, hpcc_base::HpccResult(avgCommunicationTime, "s"));
+        results.emplace("comm_share" + suffix, hpcc_base::HpccResult(avgCommunicationTime / avgTime, ""));
     }
 }
 
 void
 fft::FFTBenchmark::printResults() {
     if (mpi_comm_rank == 0) {
-        std::cout << std::setw(ENTRY_SPACE) << " " << std::left << std::setw(ENTRY_SPACE) << " avg"
-                << std::setw(ENTRY_SPACE) << " best" << std::right << std::endl;
-        std::cout << std::setw(ENTRY_SPACE) << "Time in s: " << results.at("t_avg") << results.at("t_min") << std::endl;
-        std::cout << std::setw(ENTRY_SPACE) << "GFLOPS: " << results.at("gflops_avg") << results.at("gflops_min") << std::endl;
+        for (size_t s = 0; s < executionSettings->programSettings->logFFTSizes.size(); s++) {
+            std::string suffix = getSizeSuffix(s);
+            if (executionSettings->programSettings->logFFTSizes.size() > 1) {
+                std::cout << "FFT Size: " << (1 << executionSettings->programSettings->logFFTSizes[s]) << std::endl;
+            }
+            std::cout << std::setw(ENTRY_SPACE) << " " << std::left << std::setw(ENTRY_SPACE) << " avg"
+                    << std::setw(ENTRY_SPACE) << " best" << std::right << std::endl;
+            std::cout << std::setw(ENTRY_SPACE) << "Time in s: " << results.at("t_avg" + suffix) << results.at("t_min" + suffix) << std::endl;
+            std::cout << std::setw(ENTRY_SPACE) << "GFLOPS: " << results.at("gflops_avg" + suffix) << results.at("gflops_min" + suffix) << std::endl;
+            if (executionSettings->programSettings->streamChunkSize > 0) {
+                std::cout << std::setw(ENTRY_SPACE) << "FFT/s: " << results.at("transforms_avg" + suffix) << results.at("transforms_max" + suffix) << std::endl;
+            }
+            if (executionSettings->programSettings->inOrder) {
+                std::cout << std::setw(ENTRY_SPACE) << "In-order: " << results.at("gflops_in_order_avg" + suffix) << std::endl;
+                std::cout << std::setw(ENTRY_SPACE) << "Reorder share: " << results.at("reorder_share" + suffix) << std::endl;
+            }
+            if (executionSettings->programSettings->distributed) {
+                std::cout << std::setw(ENTRY_SPACE) << "Comm. in s: " << results.at("t_comm_avg" + suffix) << std::endl;
+                std::cout << std::setw(ENTRY_SPACE) << "Comm. share: " << results.at("comm_share" + suffix) << std::endl;
+            }
+        }
+    }
+}
+
+bool
+fft::FFTBenchmark::checkInputParameters() {
+    bool validationResult = true;
+    if (executionSettings->programSettings->logFFTSizes.empty()) {
+        std::cerr << "ERROR: At least one FFT size has to be given!" << std::endl;
+        validationResult = false;
+    }
+    // The kernel file only contains kernels for the FFT sizes it was generated with
+    std::vector<uint> kernel_log_sizes;
+    std::stringstream kernel_log_sizes_stream(DEFAULT_FFT_LOG_SIZES);
+    for (std::string log_size; std::getline(kernel_log_sizes_stream, log_size, ',');) {
+        kernel_log_sizes.push_back(std::stoul(log_size));
+    }
+    for (auto log_size : executionSettings->programSettings->logFFTSizes) {
+        // The FFT kernel processes 8 values per clock cycle and thus requires at least 8 values per FFT
+        if (log_size < 3 || log_size > 30) {
+            std::cerr << "ERROR: The log2 of the FFT size has to be in the range [3,30], but " << log_size << " was given!" << std::endl;
+            validationResult = false;
+        }
+        else if (std::find(kernel_log_sizes.begin(), kernel_log_sizes.end(), log_size) == kernel_log_sizes.end()) {
+            std::cerr << "ERROR: The kernel file does not contain kernels for the FFT size 2^" << log_size
+                        << ". Supported log2 sizes are: " << DEFAULT_FFT_LOG_SIZES << std::endl;
+            validationResult = false;
+        }
+        else if (log_size * executionSettings->programSettings->dimensions > 30) {
+            std::cerr << "ERROR: The FFT with " << executionSettings->programSettings->dimensions << " dimensions of size " << (1 << log_size)
+                        << " is too large!" << std::endl;
+            validationResult = false;
+        }
+    }
+    if (executionSettings->programSettings->dimensions < 1 || executionSettings->programSettings->dimensions > 3) {
+        std::cerr << "ERROR: Only FFTs with 1 to 3 dimensions are supported, but " << executionSettings->programSettings->dimensions << " were given!" << std::endl;
+        validationResult = false;
     }
+#ifndef FFT_TRANSPOSE_KERNEL
+    if (executionSettings->programSettings->dimensions > 1) {
+        std::cerr << "ERROR: The kernel file does not contain transpose kernels, which are needed for multidimensional FFTs!" << std::endl;
+        validationResult = false;
+    }
+#endif
+    if (executionSettings->programSettings->distributed) {
+        if (executionSettings->programSettings->dimensions > 1) {
+            std::cerr << "ERROR: The distributed FFT only supports a single dimension!" << std::endl;
+            validationResult = false;
+        }
+        // The rows of the n x n matrix have to be distributed equally over all ranks and kernel replications
+        for (auto log_size : executionSettings->programSettings->logFFTSizes) {
+            if (log_size > 15 || (1 << log_size) % (mpi_comm_size * executionSettings->programSettings->kernelReplications) != 0) {
+                std::cerr << "ERROR: The FFT size " << (1 << log_size) << " can not be distributed over " << mpi_comm_size
+                            << " ranks with " << executionSettings->programSettings->kernelReplications << " kernel replications!" << std::endl;
+                validationResult = false;
+            }
+        }
+    }
+    if (executionSettings->programSettings->streamChunkSize > 0) {
+        if (executionSettings->programSettings->dimensions > 1 || executionSettings->programSettings->distributed) {
+            std::cerr << "ERROR: The streaming execution only supports batches of 1D FFTs!" << std::endl;
+            validationResult = false;
+        }
+        if (executionSettings->programSettings->iterations % executionSettings->programSettings->streamChunkSize != 0) {
+            std::cerr << "ERROR: The batch size has to be a multiple of the stream chunk size " << executionSettings->programSettings->streamChunkSize << "!" << std::endl;
+            validationResult = false;
+        }
+    }
+    if (executionSettings->programSettings->real) {
+        if (executionSettings->programSettings->dimensions > 1 || executionSettings->programSettings->distributed
+                || executionSettings->programSettings->streamChunkSize > 0) {
+            std::cerr << "ERROR: Real FFTs are only supported for batches of 1D FFTs!" << std::endl;
+            validationResult = false;
+        }
+        if (executionSettings->programSettings->iterations % 2 != 0) {
+            std::cerr << "ERROR: The batch size has to be even for real FFTs, since two real signals are packed into a single FFT!" << std::endl;
+            validationResult = false;
+        }
+        else if ((executionSettings->programSettings->iterations / 2) % executionSettings->programSettings->kernelReplications != 0) {
+            // The packed complex FFTs are distributed equally over the kernel replications
+            std::cerr << "ERROR: The number of packed FFTs " << executionSettings->programSettings->iterations / 2
+                        << " has to be a multiple of the " << executionSettings->programSettings->kernelReplications << " kernel replications for real FFTs!" << std::endl;
+            validationResult = false;
+        }
+    }
+    if (executionSettings->programSettings->inOrder) {
+        // The output of multidimensional and distributed FFTs is already in natural order
+        if (executionSettings->programSettings->dimensions > 1 || executionSettings->programSettings->distributed
+                || executionSettings->programSettings->streamChunkSize > 0 || executionSettings->programSettings->real) {
+            std::cerr << "ERROR: The in-order output is only supported for batches of complex 1D FFTs!" << std::endl;
+            validationResult = false;
+        }
+    }
+#ifdef USE_SVM
+    if (executionSettings->programSettings->dimensions > 1 || executionSettings->programSettings->distributed
+            || executionSettings->programSettings->streamChunkSize > 0 || executionSettings->programSettings->real
+            || executionSettings->programSettings->inOrder) {
+        std::cerr << "ERROR: Multidimensional, distributed, streaming, real and in-order FFTs are not supported with SVM!" << std::endl;
+        validationResult = false;
+    }
+#endif
+    return validationResult;
 }
 
 std::unique_ptr<fft::FFTData>
 fft::FFTBenchmark::generateInputData() {
-    auto d = std::unique_ptr<fft::FFTData>(new fft::FFTData(*executionSettings->context, executionSettings->programSettings->iterations));
-    std::mt19937 gen(0);
+    std::vector<size_t> sizes;
+    size_t total_size = 0;
+    for (size_t s = 0; s < executionSettings->programSettings->logFFTSizes.size(); s++) {
+        sizes.push_back(getLocalDataSize(s));
+        total_size += sizes.back();
+    }
+    auto d = std::unique_ptr<fft::FFTData>(new fft::FFTData(*executionSettings->context, sizes, executionSettings->programSettings->real));
+    // The ranks hold different parts of the same FFT in distributed mode, so they need different inputs
+    std::mt19937 gen(executionSettings->programSettings->distributed ? mpi_comm_rank : 0);
     auto dis = std::uniform_real_distribution<HOST_DATA_TYPE>(-1.0, 1.0);
-    for (int i=0; i< executionSettings->programSettings->iterations * (1 << LOG_FFT_SIZE); i++) {
+    for (size_t i=0; i < total_size; i++) {
         d->data[i].real(dis(gen));
         d->data[i].imag(dis(gen));
         d->data_out[i].real(0.0);
         d->data_out[i].imag(0.0);
     }
+    if (executionSettings->programSettings->real) {
+        for (size_t i=0; i < 2 * total_size; i++) {
+            d->real_data[i] = dis(gen);
+        }
+    }
     return d;
 }
 
 bool  
 fft::FFTBenchmark::validateOutput(fft::FFTData &data) {
-    double residual_max = 0;
-    for (int i = 0; i < executionSettings->programSettings->iterations; i++) {
-        // we have to bit reverse the output data of the FPGA kernel, since it will be provided in bit-reversed order.
-        // Directly applying iFFT on the data would thus not form the identity function we want to have for verification.
-        // TODO: This might need to be changed for other FPGA implementations that return the data in correct order
-        fft::bit_reverse(&data.data_out[i * (1 << LOG_FFT_SIZE)], 1);
-        fft::fourier_transform_gold(true, LOG_FFT_SIZE, &data.data_out[i * (1 << LOG_FFT_SIZE)]);
-
-        // Normalize the data after applying iFFT
-        for (int j = 0; j < (1 << LOG_FFT_SIZE); j++) {
-            data.data_out[i * (1 << LOG_FFT_SIZE) + j] /= (1 << LOG_FFT_SIZE);
+    double error = 0.0;
+    for (size_t s = 0; s < executionSettings->programSettings->logFFTSizes.size(); s++) {
+        const uint log_size = executionSettings->programSettings->logFFTSizes[s];
+        const uint dimensions = executionSettings->programSettings->dimensions;
+        const uint log_total_size = executionSettings->programSettings->distributed ? 2 * log_size : log_size * dimensions;
+        const size_t total_size = static_cast<size_t>(1) << log_total_size;
+        double residual_max = 0;
+        if (executionSettings->programSettings->distributed) {
+            const size_t local_size = getLocalDataSize(s);
+            std::complex<HOST_DATA_TYPE>* fft_out = &data.data_out[data.offsets[s]];
+            std::complex<HOST_DATA_TYPE>* fft_in = &data.data[data.offsets[s]];
+            // The output is distributed in natural order, so the distributed reference iFFT can be applied directly
+            fft::fourier_transform_gold_distributed(true, log_size, fft_out);
+            #pragma omp parallel for reduction(max:residual_max)
+            for (size_t j = 0; j < local_size; j++) {
+                fft_out[j] /= static_cast<HOST_DATA_TYPE>(total_size);
+                double tmp_error =  std::abs(fft_in[j] - fft_out[j]);
+                residual_max = residual_max > tmp_error ? residual_max : tmp_error;
+            }
+#ifdef _USE_MPI_
+            MPI_Allreduce(MPI_IN_PLACE, &residual_max, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+#endif
+        }
+        else if (executionSettings->programSettings->real) {
+            const size_t size = static_cast<size_t>(1) << log_size;
+            const size_t half = size / 2;
+            const bool inverse = executionSettings->programSettings->inverse;
+            #pragma omp parallel for reduction(max:residual_max)
+            for (int i = 0; i < executionSettings->programSettings->iterations; i++) {
+                const HOST_DATA_TYPE* signal = &data.real_data[2 * data.offsets[s] + i * size];
+                const std::complex<HOST_DATA_TYPE>* spectrum = (inverse ? data.data : data.data_out) + data.offsets[s] + i * half;
+                thread_local std::vector<std::complex<HOST_DATA_TYPE>> values;
+                values.resize(size);
+                if (inverse) {
+                    // The reference FFT of the calculated real signal has to result in the given half spectrum
+                    for (size_t j = 0; j < size; j++) {
+                        values[j] = signal[j];
+                    }
+                    fft::fourier_transform_gold(false, log_size, values.data());
+                    for (size_t k = 0; k <= half; k++) {
+                        std::complex<HOST_DATA_TYPE> expected = (k == 0) ? spectrum[0].real() : (k == half) ? spectrum[0].imag() : spectrum[k];
+                        double tmp_error = std::abs(values[k] / static_cast<HOST_DATA_TYPE>(size) - expected);
+                        residual_max = residual_max > tmp_error ? residual_max : tmp_error;
+                    }
+                }
+                else {
+                    // The reference iFFT of the full spectrum has to result in the real input signal
+                    values[0] = spectrum[0].real();
+                    values[half] = spectrum[0].imag();
+                    for (size_t k = 1; k < half; k++) {
+                        values[k] = spectrum[k];
+                        values[size - k] = std::conj(spectrum[k]);
+                    }
+                    fft::fourier_transform_gold(true, log_size, values.data());
+                    for (size_t j = 0; j < size; j++) {
+                        double tmp_error = std::abs(values[j] / static_cast<HOST_DATA_TYPE>(size) - signal[j]);
+                        residual_max = residual_max > tmp_error ? residual_max : tmp_error;
+                    }
+                }
+            }
+        }
+        else if (dimensions > 1) {
+            // The multidimensional FFTs are validated one after another, since the reference implementation
+            // already uses all threads for a single FFT
+            for (int i = 0; i < executionSettings->programSettings->iterations; i++) {
+                std::complex<HOST_DATA_TYPE>* fft_out = &data.data_out[data.offsets[s] + i * total_size];
+                std::complex<HOST_DATA_TYPE>* fft_in = &data.data[data.offsets[s] + i * total_size];
+                // The output of multidimensional FFTs is already in natural order
+                fft::fourier_transform_gold_multidim(true, log_size, dimensions, fft_out);
+                #pragma omp parallel for reduction(max:residual_max)
+                for (size_t j = 0; j < total_size; j++) {
+                    fft_out[j] /= static_cast<HOST_DATA_TYPE>(total_size);
+                    double tmp_error =  std::abs(fft_in[j] - fft_out[j]);
+                    residual_max = residual_max > tmp_error ? residual_max : tmp_error;
+                }
+            }
+        }
+        else {
+            // Only the sampled chunks are stored for the streaming execution
+            const int stored_ffts = getLocalDataSize(s) >> log_size;
+            #pragma omp parallel for reduction(max:residual_max)
+            for (int i = 0; i < stored_ffts; i++) {
+                std::complex<HOST_DATA_TYPE>* fft_out = &data.data_out[data.offsets[s] + (static_cast<size_t>(i) << log_size)];
+                std::complex<HOST_DATA_TYPE>* fft_in = &data.data[data.offsets[s] + (static_cast<size_t>(i) << log_size)];
+                // we have to bit reverse the output data of the FPGA kernel, since it will be provided in bit-reversed order.
+                // Directly applying iFFT on the data would thus not form the identity function we want to have for verification.
+                // The reorder kernel already returns the data in natural order.
+                if (!executionSettings->programSettings->inOrder) {
+                    fft::bit_reverse(fft_out, 1, log_size);
+                }
+                fft::fourier_transform_gold(true, log_size, fft_out);
+
+                // Normalize the data after applying iFFT
+                for (int j = 0; j < (1 << log_size); j++) {
+                    fft_out[j] /= (1 << log_size);
+                }
+                for (int j = 0; j < (1 << log_size); j++) {
+                    double tmp_error =  std::abs(fft_in[j] - fft_out[j]);
+                    residual_max = residual_max > tmp_error ? residual_max : tmp_error;
+                }
+            }
         }
-        for (int j = 0; j < (1 << LOG_FFT_SIZE); j++) {
-            double tmp_error =  std::abs(data.data[i * (1 << LOG_FFT_SIZE) + j] - data.data_out[i * (1 << LOG_FFT_SIZE) + j]);
-            residual_max = residual_max > tmp_error ? residual_max : tmp_error;
+        // Calculate residual according to paper considering also the used iterations
+        double size_error = residual_max /
+                    (std::numeric_limits<HOST_DATA_TYPE>::epsilon() * log_total_size);
+        if (s > 0) {
+            errors.emplace("residual" + getSizeSuffix(s), size_error);
         }
+        error = std::max(error, size_error);
     }
-    // Calculate residual according to paper considering also the used iterations
-    double error = residual_max /
-                   (std::numeric_limits<HOST_DATA_TYPE>::epsilon() * LOG_FFT_SIZE);
-    
+
+    // The residual is the maximum residual over all FFT sizes
     errors.emplace("residual", error);
     errors.emplace("epsilon", std::numeric_limits<HOST_DATA_TYPE>::epsilon());
 
@@ -177,111 +590,22 @@ void fft::FFTBenchmark::printError() {
 
 }
 
-void 
-fft::bit_reverse(std::complex<HOST_DATA_TYPE> *data, unsigned iterations) {
-    auto *tmp = new std::complex<HOST_DATA_TYPE>[(1 << LOG_FFT_SIZE)];
-    for (int k=0; k < iterations; k++) {
-        for (int i = 0; i < (1 << LOG_FFT_SIZE); i++) {
-            int fwd = i;
-            int bit_rev = 0;
-            for (int j = 0; j < LOG_FFT_SIZE; j++) {
-                bit_rev <<= 1;
-                bit_rev |= fwd & 1;
-                fwd >>= 1;
-            }
-            tmp[i] = data[bit_rev];
-        }
-        for (int i = 0; i < (1 << LOG_FFT_SIZE); i++) {
-            data[k * (1 << LOG_FFT_SIZE) + i] = tmp[i];
-        }
-    }
-    delete [] tmp;
-}
-
-// The function definitions and implementations below this comment are taken from the
-// FFT1D example implementation of the Intel FPGA SDK for OpenCL 19.4
-// They are licensed under the following conditions:
-//
-// Copyright (C) 2013-2019 Altera Corporation, San Jose, California, USA. All rights reserved.
-// Permission is hereby granted, free of charge, to any person obtaining a copy of this
-// software and associated documentation files (the "Software"), to deal in the Software
-// without restriction, including without limitation the rights to use, copy, modify, merge,
-// publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to
-// whom the Software is furnished to do so, subject to the following conditions:
-// The above copyright notice and this permission notice shall be included in all copies or
-// substantial portions of the Software.
-//
-// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
-// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
-// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
-// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
-// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
-// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
-// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
-// OTHER DEALINGS IN THE SOFTWARE.
-//
-// This agreement shall be governed in all respects by the laws of the State of California and
-// by the laws of the United States of America.
-
-
-void 
-fft::fourier_transform_gold(bool inverse, const int lognr_points, std::complex<HOST_DATA_TYPE> *data_sp) {
-    const int nr_points = 1 << lognr_points;
-
-    auto *data = new std::complex<double>[nr_points];
-
-    for (int i=0; i < nr_points; i++) {
-        data[i] = data_sp[i];
-    }
-
-    // The inverse requires swapping the real and imaginary component
-
-    if (inverse) {
-        for (int i = 0; i < nr_points; i++) {
-            double tmp = data[i].imag();
-            data[i].imag(data[i].real());
-            data[i].real(tmp);
-        }
-    }
-    // Do a FT recursively
-    fft::fourier_stage(lognr_points, data);
-
-    // The inverse requires swapping the real and imaginary component
-    if (inverse) {
-        for (int i = 0; i < nr_points; i++) {
-            double tmp = data[i].real();
-            data[i].real(data[i].imag());
-            data[i].imag(tmp);
+void
+fft::generate_stream_chunk(std::complex<HOST_DATA_TYPE>* data, size_t size, uint chunk) {
+    // SplitMix64 is used as counter based generator, so the values can be generated in parallel.
+    // The index of the chunk is used as seed
+    const uint64_t seed = static_cast<uint64_t>(chunk) * size * 2;
+    #pragma omp parallel for
+    for (size_t i = 0; i < size; i++) {
+        HOST_DATA_TYPE values[2];
+        for (int k = 0; k < 2; k++) {
+            uint64_t z = (seed + 2 * i + k + 1) * 0x9E3779B97F4A7C15ull;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            z ^= z >> 31;
+            // Use the upper 24 bits for a value in [-1,1)
+            values[k] = static_cast<HOST_DATA_TYPE>(static_cast<double>(z >> 40) / (1 << 23) - 1.0);
         }
+        data[i] = std::complex<HOST_DATA_TYPE>(values[0], values[1]);
     }
-
-    // Do the bit reversal
-    for (int i = 0; i < nr_points; i++) {
-        data_sp[i] = data[i];
-    }
-
-    delete [] data;
-}
-
-void 
-fft::fourier_stage(int lognr_points, std::complex<double> *data) {
-    int nr_points = 1 << lognr_points;
-    if (nr_points == 1) return;
-    auto *half1 = new std::complex<double>[nr_points / 2];
-    auto *half2 = new std::complex<double>[nr_points / 2];
-    for (int i = 0; i < nr_points / 2; i++) {
-        half1[i] = data[2 * i];
-        half2[i] = data[2 * i + 1];
-    }
-    fourier_stage(lognr_points - 1, half1);
-    fourier_stage(lognr_points - 1, half2);
-    for (int i = 0; i < nr_points / 2; i++) {
-        data[i].real(half1[i].real() + cos (2 * M_PI * i / nr_points) * half2[i].real() + sin (2 * M_PI * i / nr_points) * half2[i].imag());
-        data[i].imag(half1[i].imag() - sin (2 * M_PI * i / nr_points) * half2[i].real() + cos (2 * M_PI * i / nr_points) * half2[i].imag());
-        data[i + nr_points / 2].real(half1[i].real() - cos (2 * M_PI * i / nr_points) * half2[i].real() - sin (2 * M_PI * i / nr_points) * half2[i].imag());
-        data[i + nr_points / 2].imag(half1[i].imag() + sin (2 * M_PI * i / nr_points) * half2[i].real() - cos (2 * M_PI * i / nr_points) * half2[i].imag());
-    }
-
-    delete [] half1;
-    delete [] half2;
 }
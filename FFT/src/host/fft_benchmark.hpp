@@ -26,6 +26,7 @@ SOFTWARE.
 /* C++ standard library headers */
 #include <complex>
 #include <memory>
+#include <vector>
 
 /* Project's headers */
 #include "hpcc_benchmark.hpp"
@@ -55,6 +56,46 @@ public:
     */
     bool inverse;
 
+    /**
+     * @brief Log2 of the FFT sizes that will be measured. The kernel file has to contain kernels for all sizes.
+     *          The first size is the primary size of the benchmark and its results are reported without size suffix.
+     * 
+     */
+    std::vector<uint> logFFTSizes;
+
+    /**
+     * @brief Number of dimensions of the FFT. The FFT size is used for every dimension.
+     * 
+     */
+    uint dimensions;
+
+    /**
+     * @brief If true, a single 1D FFT of size n^2 is calculated over all MPI ranks instead of independent
+     *          batches, where n is the FFT size of the kernel
+     * 
+     */
+    bool distributed;
+
+    /**
+     * @brief Number of FFTs per chunk for the streaming execution. If 0, the whole batch is stored on the device.
+     * 
+     */
+    uint streamChunkSize;
+
+    /**
+     * @brief If true, FFTs of real signals are calculated (R2C) or real signals are calculated from their spectra
+     *          for the inverse FFT (C2R). Two real FFTs are packed into a single complex FFT.
+     * 
+     */
+    bool real;
+
+    /**
+     * @brief If true, the output of the FFT kernel is reordered into natural order on the device
+     *          using the reorder kernel, so no bit reversal is needed on the host
+     * 
+     */
+    bool inOrder;
+
     /**
      * @brief Construct a new FFT Program Settings object
      * 
@@ -80,7 +121,8 @@ class FFTData {
 public:
 
     /**
-     * @brief The data array used as input of the FFT calculation
+     * @brief The data array used as input of the FFT calculation.
+     *          The batches of all FFT sizes are stored one after another in this array.
      * 
      */
     std::complex<HOST_DATA_TYPE>* data;
@@ -91,6 +133,20 @@ public:
      */
     std::complex<HOST_DATA_TYPE>* data_out;
 
+    /**
+     * @brief The real signals that are used as input of the R2C FFT or as output of the C2R FFT.
+     *          Contains twice the number of values of the complex arrays, or is nullptr if real FFTs are not used.
+     *          The half spectra of the real signals are stored in the complex data arrays.
+     * 
+     */
+    HOST_DATA_TYPE* real_data;
+
+    /**
+     * @brief Offset of the first value of every FFT size in the data arrays
+     * 
+     */
+    std::vector<size_t> offsets;
+
     /**
      * @brief The context that is used to allocate memory in SVM mode
      * 
@@ -101,9 +157,10 @@ public:
      * @brief Construct a new FFT Data object
      * 
      * @param context The OpenCL context used to allocate memory in SVM mode
-     * @param iterations Number of FFT data that will be stored sequentially in the array
+     * @param sizes Number of values that will be stored sequentially in the array for every FFT size
+     * @param real If true, the array for the real signals is allocated additionally
      */
-    FFTData(cl::Context context, uint iterations);
+    FFTData(cl::Context context, const std::vector<size_t>& sizes, bool real = false);
 
     /**
      * @brief Destroy the FFT Data object. Free the allocated memory
@@ -143,6 +200,43 @@ protected:
     void
     addAdditionalParseOptions(cxxopts::Options &options) override;
 
+    /**
+     * @brief Get the suffix that is appended to the timing and result keys of a FFT size
+     * 
+     * @param index Index of the FFT size in the program settings
+     * @return std::string Empty string for the first FFT size, "_" followed by the FFT size otherwise
+     */
+    std::string
+    getSizeSuffix(size_t index) const;
+
+    /**
+     * @brief Get the number of values that are stored on this rank for a FFT size
+     * 
+     * @param index Index of the FFT size in the program settings
+     * @return size_t The number of values of the whole batch, or the local part of the distributed FFT
+     */
+    size_t
+    getLocalDataSize(size_t index) const;
+
+    /**
+     * @brief Collect the results of the distributed FFT. The execution time is the maximum over all ranks.
+     *          Additionally, the time of the all-to-all communication and its share of the execution time are reported.
+     * 
+     * @param index Index of the FFT size in the program settings
+     */
+    void
+    collectDistributedResults(size_t index);
+
+    /**
+     * @brief Collect the cost of the in-order output. The share of the reorder kernel in the total time and the
+     *          GFLOP/s including the reordering are reported.
+     * 
+     * @param index Index of the FFT size in the program settings
+     * @param gflop The GFLOP of the whole batch
+     */
+    void
+    collectReorderResults(size_t index, double gflop);
+
 public:
 
     /**
@@ -190,6 +284,15 @@ public:
     void
     printResults() override;
 
+    /**
+     * @brief Check the given FFT sizes
+     * 
+     * @return true if all FFT sizes are supported
+     * @return false otherwise
+     */
+    bool
+    checkInputParameters() override;
+
     /**
      * @brief Construct a new FFT Benchmark object
      * 
@@ -210,33 +313,69 @@ public:
  *
  * @param data Array of complex numbers that will be sorted in bit reversed order
  * @param iterations Length of the data array will be calculated with iterations * FFT Size
+ * @param log_size The log2 of the FFT size
+ */
+void bit_reverse(std::complex<HOST_DATA_TYPE> *data, unsigned iterations, int log_size = LOG_FFT_SIZE);
+
+/**
+ * @brief Precomputed data that is needed by the reference implementation to calculate FFTs of a fixed size.
+ *          This contains the bit reversal permutation and the twiddle factors of all stages in separate arrays
+ *          for the real and imaginary part, so the butterflies can be vectorized by the compiler.
+ *          Plans should be retrieved with getFFTPlan() so they are only calculated once per FFT size.
  */
-void bit_reverse(std::complex<HOST_DATA_TYPE> *data, unsigned iterations);
-
-// The function definitions and implementations below this comment are taken from the
-// FFT1D example implementation of the Intel FPGA SDK for OpenCL 19.4
-// They are licensed under the following conditions:
-//
-// Copyright (C) 2013-2019 Altera Corporation, San Jose, California, USA. All rights reserved.
-// Permission is hereby granted, free of charge, to any person obtaining a copy of this
-// software and associated documentation files (the "Software"), to deal in the Software
-// without restriction, including without limitation the rights to use, copy, modify, merge,
-// publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to
-// whom the Software is furnished to do so, subject to the following conditions:
-// The above copyright notice and this permission notice shall be included in all copies or
-// substantial portions of the Software.
-//
-// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
-// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
-// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
-// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
-// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
-// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
-// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
-// OTHER DEALINGS IN THE SOFTWARE.
-//
-// This agreement shall be governed in all respects by the laws of the State of California and
-// by the laws of the United States of America.
+class FFTPlan {
+
+public:
+
+    /**
+     * @brief The log2 of the FFT size
+     */
+    const int log_size;
+
+    /**
+     * @brief The FFT size
+     */
+    const uint size;
+
+    /**
+     * @brief Contains the bit reversed index for every index of the FFT
+     */
+    std::vector<uint> bit_reversal;
+
+    /**
+     * @brief Twiddle factors of all radix-4 passes. Every pass that combines sub-FFTs of size q stores 4*q values:
+     *          the real and imaginary parts of e^(-2*pi*i*j/(2q)) followed by the real and imaginary parts
+     *          of e^(-2*pi*i*j/(4q)) for j = 0..q-1
+     */
+    std::vector<double> twiddles;
+
+    /**
+     * @brief Construct a new FFT plan and precompute the bit reversal and twiddle factors
+     * 
+     * @param log_size The log2 of the FFT size
+     */
+    explicit FFTPlan(int log_size);
+
+    /**
+     * @brief Calculate the FFT in place using radix-4 passes and a single radix-2 stage for odd log sizes.
+     *          The result is not normalized for the inverse FFT.
+     * 
+     * @param re Real parts of the input data in bit reversed order. Will contain the result in natural order.
+     * @param im Imaginary parts of the input data in bit reversed order. Will contain the result in natural order.
+     * @param inverse if false, the FFT will be calculated, else the iFFT
+     */
+    void execute(double* re, double* im, bool inverse) const;
+
+};
+
+/**
+ * @brief Get the FFT plan for the given FFT size. The plan is created on the first call and cached for all
+ *          following calls. This function is thread safe.
+ * 
+ * @param log_size The log2 of the FFT size
+ * @return const FFTPlan& The plan for the given FFT size
+ */
+const FFTPlan& getFFTPlan(int log_size);
 
 /**
  * @brief Do a FFT with a reference implementation on the CPU
@@ -248,13 +387,97 @@ void bit_reverse(std::complex<HOST_DATA_TYPE> *data, unsigned iterations);
 void fourier_transform_gold(bool inverse, const int lognr_points, std::complex<HOST_DATA_TYPE> *data);
 
 /**
- * @brief Calculate a single stage of the whole FFT calculation.
- *          This function will mainly be used by fourier_transform_gold() to calculate the FFT.
+ * @brief Do a multidimensional FFT with the reference implementation on the CPU.
+ *          The 1D FFT is calculated over every dimension with the same size. The result is in natural order.
  * 
- * @param lognr_points The log2 of the FFT size that should be calculated 
- * @param data The input data for the FFT stage
+ * @param inverse if false, the FFT will be calculated, else the iFFT
+ * @param lognr_points The log2 of the FFT size in every dimension
+ * @param dimensions The number of dimensions
+ * @param data The input data for the FFT in row-major order
+ */
+void fourier_transform_gold_multidim(bool inverse, const int lognr_points, const int dimensions, std::complex<HOST_DATA_TYPE> *data);
+
+/**
+ * @brief Generate the input of a chunk of the streaming execution with pseudo random values in [-1,1).
+ *          The values only depend on the index of the chunk, so every chunk of the stream gets a different input
+ *          that can be generated again for the validation. The generator is fast enough to feed the stream.
+ * 
+ * @param data Array for the values of the chunk
+ * @param size Number of complex values in the chunk
+ * @param chunk Index of the chunk in the stream
+ */
+void generate_stream_chunk(std::complex<HOST_DATA_TYPE>* data, size_t size, uint chunk);
+
+/**
+ * @brief Pack pairs of real signals into complex signals by using the first signal as real part and the second
+ *          signal as imaginary part
+ * 
+ * @param real Array of 2 * pairs real signals
+ * @param data Array of pairs complex signals
+ * @param pairs Number of signal pairs
+ * @param log_size The log2 of the FFT size
+ */
+void pack_real_signals(const HOST_DATA_TYPE* real, std::complex<HOST_DATA_TYPE>* data, unsigned pairs, int log_size);
+
+/**
+ * @brief Separate the FFTs of packed pairs of real signals into their half spectra in place.
+ *          The half spectrum of a real signal of size N is stored in N/2 complex values, where the real value
+ *          at index N/2 is stored in the imaginary part of the first value.
+ * 
+ * @param data The bit reversed FFTs of the packed signals. Will contain the half spectra of both signals of every pair.
+ * @param pairs Number of signal pairs
+ * @param log_size The log2 of the FFT size
+ */
+void unpack_real_spectra(std::complex<HOST_DATA_TYPE>* data, unsigned pairs, int log_size);
+
+/**
+ * @brief Pack pairs of half spectra of real signals into full complex spectra, so the inverse FFT returns the
+ *          first signal in the real part and the second signal in the imaginary part
+ * 
+ * @param spectra The half spectra of 2 * pairs real signals in the format of unpack_real_spectra()
+ * @param data Array of pairs complex spectra
+ * @param pairs Number of signal pairs
+ * @param log_size The log2 of the FFT size
+ */
+void pack_real_spectra(const std::complex<HOST_DATA_TYPE>* spectra, std::complex<HOST_DATA_TYPE>* data, unsigned pairs, int log_size);
+
+/**
+ * @brief Separate the inverse FFTs of packed spectra into the real signals
+ * 
+ * @param data The bit reversed inverse FFTs of the packed spectra
+ * @param real Array of 2 * pairs real signals
+ * @param pairs Number of signal pairs
+ * @param log_size The log2 of the FFT size
+ */
+void unpack_real_signals(const std::complex<HOST_DATA_TYPE>* data, HOST_DATA_TYPE* real, unsigned pairs, int log_size);
+
+/**
+ * @brief Transpose a n x n matrix whose rows are distributed in equal blocks over all MPI ranks with a single
+ *          all-to-all exchange. Optionally, the bit reversal of the rows is undone and the twiddle factors of
+ *          the six-step FFT algorithm are applied while the data is packed for the exchange.
+ * 
+ * @param in The local rows of the matrix. Is used as receive buffer and will be overwritten.
+ * @param out The local rows of the transposed matrix
+ * @param log_size The log2 of the matrix size n
+ * @param bit_reversed If true, the values of every row are expected in bit reversed order
+ * @param twiddle_direction -1 to multiply every value (r,c) with exp(-2*pi*i*r*c/n^2) before the transposition,
+ *                          1 for the complex conjugate, 0 to skip the multiplication
+ * @return double The time in seconds that was spent in the all-to-all communication
+ */
+double distributed_transpose(std::complex<HOST_DATA_TYPE>* in, std::complex<HOST_DATA_TYPE>* out, int log_size,
+                            bool bit_reversed, int twiddle_direction);
+
+/**
+ * @brief Do a 1D FFT of size n^2 that is distributed over all MPI ranks on the CPU.
+ *          Every rank holds a consecutive block of n^2 / ranks values of the input and output in natural order.
+ *          The blocks are gathered on rank 0, which calculates the whole FFT with fourier_transform_gold(), so the
+ *          reference does not depend on distributed_transpose() that is used by the measured execution.
+ * 
+ * @param inverse if false, the FFT will be calculated, else the iFFT
+ * @param lognr_points The log2 of n. The log2 of the total FFT size is 2 * lognr_points.
+ * @param data The local part of the input data. Will contain the local part of the result.
  */
-void fourier_stage(int lognr_points, std::complex<double> *data);
+void fourier_transform_gold_distributed(bool inverse, const int lognr_points, std::complex<HOST_DATA_TYPE> *data);
 
 } // namespace fft
 
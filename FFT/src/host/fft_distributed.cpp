@@ -0,0 +1,136 @@
+/*
+Copyright (c) 2023 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* Related header files */
+#include "fft_benchmark.hpp"
+
+/* C++ standard library headers */
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstring>
+#include <vector>
+
+double
+fft::distributed_transpose(std::complex<HOST_DATA_TYPE>* in, std::complex<HOST_DATA_TYPE>* out, int log_size,
+                            bool bit_reversed, int twiddle_direction) {
+    int mpi_rank = 0;
+    int mpi_size = 1;
+#ifdef _USE_MPI_
+    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+#endif
+    const size_t n = static_cast<size_t>(1) << log_size;
+    const size_t local_rows = n / mpi_size;
+    const size_t block_size = local_rows * local_rows;
+    const FFTPlan& plan = getFFTPlan(log_size);
+
+    // The twiddle factors w^m of the six-step algorithm with w = exp(-2*pi*i/n^2) and m < n^2 are calculated
+    // from two tables with w^m = w^(m_high * n) * w^m_low
+    std::vector<std::complex<double>> twiddles_low;
+    std::vector<std::complex<double>> twiddles_high;
+    if (twiddle_direction != 0) {
+        twiddles_low.resize(n);
+        twiddles_high.resize(n);
+        const double n_total = static_cast<double>(n) * n;
+        for (size_t j = 0; j < n; j++) {
+            twiddles_low[j] = std::polar(1.0, twiddle_direction * 2.0 * M_PI * j / n_total);
+            twiddles_high[j] = std::polar(1.0, twiddle_direction * 2.0 * M_PI * j * n / n_total);
+        }
+    }
+
+    // Pack the blocks for every destination rank. The blocks are already transposed, so every rank only has to
+    // copy consecutive rows into place after the exchange
+    #pragma omp parallel for collapse(2)
+    for (int dest = 0; dest < mpi_size; dest++) {
+        for (size_t c = 0; c < local_rows; c++) {
+            const size_t col = dest * local_rows + c;
+            const size_t src_col = bit_reversed ? plan.bit_reversal[col] : col;
+            std::complex<HOST_DATA_TYPE>* block = &out[dest * block_size + c * local_rows];
+            for (size_t r = 0; r < local_rows; r++) {
+                std::complex<HOST_DATA_TYPE> value = in[r * n + src_col];
+                if (twiddle_direction != 0) {
+                    const size_t m = ((mpi_rank * local_rows + r) * col) & (n * n - 1);
+                    value = std::complex<HOST_DATA_TYPE>(std::complex<double>(value) * twiddles_high[m >> log_size] * twiddles_low[m & (n - 1)]);
+                }
+                block[r] = value;
+            }
+        }
+    }
+
+    auto start_communication = std::chrono::high_resolution_clock::now();
+#ifdef _USE_MPI_
+    // Exchange the blocks row by row, since the number of values of a block may exceed the range of int.
+    // The MPI data type is derived from the size of the host data type
+    MPI_Datatype value_type;
+    MPI_Type_match_size(MPI_TYPECLASS_REAL, sizeof(HOST_DATA_TYPE), &value_type);
+    MPI_Datatype row_type;
+    MPI_Type_contiguous(static_cast<int>(2 * local_rows), value_type, &row_type);
+    MPI_Type_commit(&row_type);
+    MPI_Alltoall(out, static_cast<int>(local_rows), row_type, in, static_cast<int>(local_rows), row_type, MPI_COMM_WORLD);
+    MPI_Type_free(&row_type);
+#else
+    std::memcpy(in, out, block_size * sizeof(std::complex<HOST_DATA_TYPE>));
+#endif
+    auto end_communication = std::chrono::high_resolution_clock::now();
+
+    // The block received from rank p contains the columns p * local_rows to (p + 1) * local_rows of all local rows
+    #pragma omp parallel for collapse(2)
+    for (size_t c = 0; c < local_rows; c++) {
+        for (int src = 0; src < mpi_size; src++) {
+            std::memcpy(&out[c * n + src * local_rows], &in[src * block_size + c * local_rows],
+                        local_rows * sizeof(std::complex<HOST_DATA_TYPE>));
+        }
+    }
+
+    return std::chrono::duration_cast<std::chrono::duration<double>>(end_communication - start_communication).count();
+}
+
+void
+fft::fourier_transform_gold_distributed(bool inverse, const int lognr_points, std::complex<HOST_DATA_TYPE> *data) {
+    int mpi_rank = 0;
+    int mpi_size = 1;
+#ifdef _USE_MPI_
+    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+#endif
+    const size_t n = static_cast<size_t>(1) << lognr_points;
+    const size_t local_rows = n / mpi_size;
+
+#ifdef _USE_MPI_
+    // Gather the rows of all ranks, since the total number of values may exceed the range of int
+    MPI_Datatype value_type;
+    MPI_Type_match_size(MPI_TYPECLASS_REAL, sizeof(HOST_DATA_TYPE), &value_type);
+    MPI_Datatype row_type;
+    MPI_Type_contiguous(static_cast<int>(2 * n), value_type, &row_type);
+    MPI_Type_commit(&row_type);
+    std::vector<std::complex<HOST_DATA_TYPE>> global_data(mpi_rank == 0 ? n * n : 0);
+    MPI_Gather(data, static_cast<int>(local_rows), row_type, global_data.data(), static_cast<int>(local_rows), row_type, 0, MPI_COMM_WORLD);
+    if (mpi_rank == 0) {
+        fourier_transform_gold(inverse, 2 * lognr_points, global_data.data());
+    }
+    MPI_Scatter(global_data.data(), static_cast<int>(local_rows), row_type, data, static_cast<int>(local_rows), row_type, 0, MPI_COMM_WORLD);
+    MPI_Type_free(&row_type);
+#else
+    fourier_transform_gold(inverse, 2 * lognr_points, data);
+#endif
+}
@@ -0,0 +1,107 @@
+/*
+Copyright (c) 2023 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* Related header files */
+#include "fft_benchmark.hpp"
+
+/* C++ standard library headers */
+#include <complex>
+#include <vector>
+
+void
+fft::pack_real_signals(const HOST_DATA_TYPE* real, std::complex<HOST_DATA_TYPE>* data, unsigned pairs, int log_size) {
+    const size_t size = static_cast<size_t>(1) << log_size;
+    #pragma omp parallel for
+    for (uint p = 0; p < pairs; p++) {
+        const HOST_DATA_TYPE* a = &real[2 * p * size];
+        const HOST_DATA_TYPE* b = &real[(2 * p + 1) * size];
+        for (size_t j = 0; j < size; j++) {
+            data[p * size + j] = std::complex<HOST_DATA_TYPE>(a[j], b[j]);
+        }
+    }
+}
+
+void
+fft::unpack_real_spectra(std::complex<HOST_DATA_TYPE>* data, unsigned pairs, int log_size) {
+    const FFTPlan& plan = getFFTPlan(log_size);
+    const size_t size = plan.size;
+    const size_t half = size / 2;
+    #pragma omp parallel for
+    for (uint p = 0; p < pairs; p++) {
+        thread_local std::vector<std::complex<HOST_DATA_TYPE>> z;
+        z.resize(size);
+        std::complex<HOST_DATA_TYPE>* pair_data = &data[p * size];
+        // The FFT kernel returns the result in bit reversed order
+        for (size_t k = 0; k < size; k++) {
+            z[k] = pair_data[plan.bit_reversal[k]];
+        }
+        // Z = A + iB with A and B being Hermitian, so A[k] = (Z[k] + conj(Z[N-k])) / 2 and B[k] = (Z[k] - conj(Z[N-k])) / 2i.
+        // The real values A[N/2] and B[N/2] are stored in the imaginary part of the first value of the spectra
+        std::complex<HOST_DATA_TYPE>* a = pair_data;
+        std::complex<HOST_DATA_TYPE>* b = pair_data + half;
+        a[0] = std::complex<HOST_DATA_TYPE>(z[0].real(), z[half].real());
+        b[0] = std::complex<HOST_DATA_TYPE>(z[0].imag(), z[half].imag());
+        for (size_t k = 1; k < half; k++) {
+            std::complex<HOST_DATA_TYPE> z_k = z[k];
+            std::complex<HOST_DATA_TYPE> z_mirror = std::conj(z[size - k]);
+            a[k] = (z_k + z_mirror) * static_cast<HOST_DATA_TYPE>(0.5);
+            b[k] = (z_k - z_mirror) * std::complex<HOST_DATA_TYPE>(0.0, -0.5);
+        }
+    }
+}
+
+void
+fft::pack_real_spectra(const std::complex<HOST_DATA_TYPE>* spectra, std::complex<HOST_DATA_TYPE>* data, unsigned pairs, int log_size) {
+    const size_t size = static_cast<size_t>(1) << log_size;
+    const size_t half = size / 2;
+    #pragma omp parallel for
+    for (uint p = 0; p < pairs; p++) {
+        const std::complex<HOST_DATA_TYPE>* a = &spectra[p * size];
+        const std::complex<HOST_DATA_TYPE>* b = &spectra[p * size + half];
+        std::complex<HOST_DATA_TYPE>* z = &data[p * size];
+        const std::complex<HOST_DATA_TYPE> i(0.0, 1.0);
+        // Z = A + iB, where the second half of the spectra is given by the Hermitian symmetry
+        z[0] = std::complex<HOST_DATA_TYPE>(a[0].real(), b[0].real());
+        z[half] = std::complex<HOST_DATA_TYPE>(a[0].imag(), b[0].imag());
+        for (size_t k = 1; k < half; k++) {
+            z[k] = a[k] + i * b[k];
+            z[size - k] = std::conj(a[k]) + i * std::conj(b[k]);
+        }
+    }
+}
+
+void
+fft::unpack_real_signals(const std::complex<HOST_DATA_TYPE>* data, HOST_DATA_TYPE* real, unsigned pairs, int log_size) {
+    const FFTPlan& plan = getFFTPlan(log_size);
+    const size_t size = plan.size;
+    #pragma omp parallel for
+    for (uint p = 0; p < pairs; p++) {
+        HOST_DATA_TYPE* a = &real[2 * p * size];
+        HOST_DATA_TYPE* b = &real[(2 * p + 1) * size];
+        // The FFT kernel returns the result in bit reversed order
+        for (size_t j = 0; j < size; j++) {
+            std::complex<HOST_DATA_TYPE> z = data[p * size + plan.bit_reversal[j]];
+            a[j] = z.real();
+            b[j] = z.imag();
+        }
+    }
+}
@@ -0,0 +1,214 @@
+/*
+Copyright (c) 2023 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* Related header files */
+#include "fft_benchmark.hpp"
+
+/* C++ standard library headers */
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+fft::FFTPlan::FFTPlan(int log_size) : log_size(log_size), size(1u << log_size), bit_reversal(1u << log_size) {
+    for (uint i = 0; i < size; i++) {
+        uint fwd = i;
+        uint bit_rev = 0;
+        for (int j = 0; j < log_size; j++) {
+            bit_rev <<= 1;
+            bit_rev |= fwd & 1;
+            fwd >>= 1;
+        }
+        bit_reversal[i] = bit_rev;
+    }
+
+    // A single radix-2 stage is needed first for odd sizes, all other stages are combined to radix-4 passes.
+    // Every pass that combines sub-FFTs of size q stores the twiddle factors for both of its radix-2 stages
+    for (uint q = (log_size % 2 == 1) ? 2 : 1; q < size; q *= 4) {
+        size_t offset = twiddles.size();
+        twiddles.resize(offset + 4 * q);
+        for (uint j = 0; j < q; j++) {
+            double angle1 = -2.0 * M_PI * j / (2.0 * q);
+            double angle2 = -2.0 * M_PI * j / (4.0 * q);
+            twiddles[offset + j] = std::cos(angle1);
+            twiddles[offset + q + j] = std::sin(angle1);
+            twiddles[offset + 2 * q + j] = std::cos(angle2);
+            twiddles[offset + 3 * q + j] = std::sin(angle2);
+        }
+    }
+}
+
+void
+fft::FFTPlan::execute(double* re, double* im, bool inverse) const {
+    // The inverse FFT uses the complex conjugate of all twiddle factors
+    const double sign = inverse ? -1.0 : 1.0;
+    uint q = 1;
+    if (log_size % 2 == 1) {
+        #pragma omp simd
+        for (uint k = 0; k < size; k += 2) {
+            double r = re[k + 1];
+            double i = im[k + 1];
+            re[k + 1] = re[k] - r;
+            im[k + 1] = im[k] - i;
+            re[k] += r;
+            im[k] += i;
+        }
+        q = 2;
+    }
+    const double* w = twiddles.data();
+    for (; q < size; q *= 4) {
+        const double* w1r = w;
+        const double* w1i = w + q;
+        const double* w2r = w + 2 * q;
+        const double* w2i = w + 3 * q;
+        w += 4 * q;
+        for (uint k = 0; k < size; k += 4 * q) {
+            double* r0 = re + k;
+            double* r1 = r0 + q;
+            double* r2 = r1 + q;
+            double* r3 = r2 + q;
+            double* i0 = im + k;
+            double* i1 = i0 + q;
+            double* i2 = i1 + q;
+            double* i3 = i2 + q;
+            #pragma omp simd
+            for (uint j = 0; j < q; j++) {
+                double c1 = w1r[j];
+                double s1 = sign * w1i[j];
+                double c2 = w2r[j];
+                double s2 = sign * w2i[j];
+                // First radix-2 stage on the sub-FFTs of size q
+                double t1r = c1 * r1[j] - s1 * i1[j];
+                double t1i = c1 * i1[j] + s1 * r1[j];
+                double t3r = c1 * r3[j] - s1 * i3[j];
+                double t3i = c1 * i3[j] + s1 * r3[j];
+                double b0r = r0[j] + t1r;
+                double b0i = i0[j] + t1i;
+                double b1r = r0[j] - t1r;
+                double b1i = i0[j] - t1i;
+                double b2r = r2[j] + t3r;
+                double b2i = i2[j] + t3i;
+                double b3r = r2[j] - t3r;
+                double b3i = i2[j] - t3i;
+                // Second radix-2 stage on the sub-FFTs of size 2q. The twiddle factor of the second half
+                // additionally contains a rotation by -i, or +i for the inverse
+                double u2r = c2 * b2r - s2 * b2i;
+                double u2i = c2 * b2i + s2 * b2r;
+                double u3r = sign * (c2 * b3i + s2 * b3r);
+                double u3i = -sign * (c2 * b3r - s2 * b3i);
+                r0[j] = b0r + u2r;
+                i0[j] = b0i + u2i;
+                r2[j] = b0r - u2r;
+                i2[j] = b0i - u2i;
+                r1[j] = b1r + u3r;
+                i1[j] = b1i + u3i;
+                r3[j] = b1r - u3r;
+                i3[j] = b1i - u3i;
+            }
+        }
+    }
+}
+
+const fft::FFTPlan&
+fft::getFFTPlan(int log_size) {
+    static std::map<int, std::unique_ptr<FFTPlan>> plans;
+    static std::mutex plans_mutex;
+    std::lock_guard<std::mutex> lock(plans_mutex);
+    auto& plan = plans[log_size];
+    if (!plan) {
+        plan = std::unique_ptr<FFTPlan>(new FFTPlan(log_size));
+    }
+    return *plan;
+}
+
+void
+fft::bit_reverse(std::complex<HOST_DATA_TYPE> *data, unsigned iterations, int log_size) {
+    const FFTPlan& plan = getFFTPlan(log_size);
+    #pragma omp parallel for if(iterations > 1)
+    for (uint k = 0; k < iterations; k++) {
+        std::complex<HOST_DATA_TYPE>* fft_data = &data[static_cast<size_t>(k) * plan.size];
+        // The permutation is its own inverse, so it can be done in place by swapping pairs
+        for (uint i = 0; i < plan.size; i++) {
+            uint bit_rev = plan.bit_reversal[i];
+            if (i < bit_rev) {
+                std::swap(fft_data[i], fft_data[bit_rev]);
+            }
+        }
+    }
+}
+
+void
+fft::fourier_transform_gold(bool inverse, const int lognr_points, std::complex<HOST_DATA_TYPE> *data) {
+    const FFTPlan& plan = getFFTPlan(lognr_points);
+
+    // The calculation is done in double precision in separate arrays for the real and imaginary part.
+    // The arrays are reused for all calls of the same thread
+    thread_local std::vector<double> re;
+    thread_local std::vector<double> im;
+    re.resize(plan.size);
+    im.resize(plan.size);
+
+    // The iterative FFT requires the input in bit reversed order
+    for (uint i = 0; i < plan.size; i++) {
+        re[i] = data[plan.bit_reversal[i]].real();
+        im[i] = data[plan.bit_reversal[i]].imag();
+    }
+
+    plan.execute(re.data(), im.data(), inverse);
+
+    for (uint i = 0; i < plan.size; i++) {
+        data[i] = std::complex<HOST_DATA_TYPE>(re[i], im[i]);
+    }
+}
+
+void
+fft::fourier_transform_gold_multidim(bool inverse, const int lognr_points, const int dimensions, std::complex<HOST_DATA_TYPE> *data) {
+    const FFTPlan& plan = getFFTPlan(lognr_points);
+    const size_t total_size = static_cast<size_t>(1) << (lognr_points * dimensions);
+    const size_t lines = total_size / plan.size;
+
+    // Calculate the 1D FFTs over one dimension after another.
+    // The values of a single 1D FFT are stored with the distance 'stride' in the data array
+    for (size_t stride = 1; stride < total_size; stride *= plan.size) {
+        #pragma omp parallel for
+        for (size_t line = 0; line < lines; line++) {
+            thread_local std::vector<double> re;
+            thread_local std::vector<double> im;
+            re.resize(plan.size);
+            im.resize(plan.size);
+
+            std::complex<HOST_DATA_TYPE>* line_data = &data[(line / stride) * stride * plan.size + line % stride];
+            for (uint i = 0; i < plan.size; i++) {
+                re[i] = line_data[plan.bit_reversal[i] * stride].real();
+                im[i] = line_data[plan.bit_reversal[i] * stride].imag();
+            }
+
+            plan.execute(re.data(), im.data(), inverse);
+
+            for (uint i = 0; i < plan.size; i++) {
+                line_data[i * stride] = std::complex<HOST_DATA_TYPE>(re[i], im[i]);
+            }
+        }
+    }
+}
@@ -184,3 +184,138 @@ TEST_F(FFTKernelTest, FPGAiFFTAndCPUiFFTGiveSameResults) {
         EXPECT_NEAR(std::abs(data->data_out[i]), 0.0, 0.001);
     }
 }
+
+/**
+ * Check if all FFT sizes of the kernel file are measured, validated and reported in a single run
+ */
+TEST_F(FFTKernelTest, ResultsReportedForAllFFTSizes) {
+    auto& log_sizes = bm->getExecutionSettings().programSettings->logFFTSizes;
+    if (log_sizes.size() < 2) {
+        GTEST_SKIP() << "The kernel file contains only a single FFT size";
+    }
+    bm->executeKernel(*data);
+    EXPECT_TRUE(bm->validateOutput(*data));
+    bm->collectResults();
+    auto results = bm->getResultsJson();
+    EXPECT_TRUE(results.count("gflops_avg"));
+    EXPECT_EQ(1, bm->getTimingsMap().at("execution").size());
+    for (size_t s = 1; s < log_sizes.size(); s++) {
+        std::string suffix = "_" + std::to_string(1 << log_sizes[s]);
+        EXPECT_TRUE(results.count("gflops_avg" + suffix));
+        EXPECT_TRUE(results.count("t_min" + suffix));
+        EXPECT_EQ(1, bm->getTimingsMap().at("execution" + suffix).size());
+    }
+}
+
+/**
+ * Check if the 2D FFT on the FPGA gives the same result as the reference implementation
+ */
+TEST_F(FFTKernelTest, FPGA2DFFTAndCPU2DFFTGiveSameResults) {
+#ifndef FFT_TRANSPOSE_KERNEL
+    GTEST_SKIP() << "The kernel file does not contain transpose kernels";
+#endif
+    auto& settings = *bm->getExecutionSettings().programSettings;
+    if (LOG_FFT_SIZE > 8) {
+        GTEST_SKIP() << "The 2D FFT is too large to be executed in emulation";
+    }
+    settings.dimensions = 2;
+    settings.iterations = settings.kernelReplications;
+    settings.logFFTSizes = {LOG_FFT_SIZE};
+    data = bm->generateInputData();
+    std::vector<std::complex<HOST_DATA_TYPE>> verify_data(data->data, data->data + settings.iterations * (1 << (2 * LOG_FFT_SIZE)));
+
+    bm->executeKernel(*data);
+
+    for (uint i = 0; i < settings.iterations; i++) {
+        fft::fourier_transform_gold_multidim(false, LOG_FFT_SIZE, 2, &verify_data[i * (1 << (2 * LOG_FFT_SIZE))]);
+    }
+    for (size_t i = 0; i < verify_data.size(); i++) {
+        EXPECT_NEAR(std::abs(data->data_out[i] - verify_data[i]), 0.0, 0.001 * LOG_FFT_SIZE);
+    }
+    EXPECT_TRUE(bm->validateOutput(*data));
+}
+
+/**
+ * Check if the distributed FFT calculated with the FFT kernel is validated and reports the communication share
+ */
+TEST_F(FFTKernelTest, DistributedFFTIsValidated) {
+    auto& settings = *bm->getExecutionSettings().programSettings;
+    if (LOG_FFT_SIZE > 8) {
+        GTEST_SKIP() << "The distributed FFT is too large to be executed in emulation";
+    }
+    settings.distributed = true;
+    settings.logFFTSizes = {LOG_FFT_SIZE};
+    data = bm->generateInputData();
+
+    bm->executeKernel(*data);
+    EXPECT_EQ(1, bm->getTimingsMap().at("communication").size());
+    EXPECT_TRUE(bm->validateOutput(*data));
+    bm->collectResults();
+    auto results = bm->getResultsJson();
+    EXPECT_TRUE(results.count("comm_share"));
+    EXPECT_TRUE(results.count("gflops_avg"));
+}
+
+/**
+ * Check if the streaming execution returns the correct results for the sampled chunks and reports the transform rate
+ */
+TEST_F(FFTKernelTest, StreamingExecutionIsValidated) {
+    auto& settings = *bm->getExecutionSettings().programSettings;
+    settings.logFFTSizes = {LOG_FFT_SIZE};
+    settings.streamChunkSize = 1;
+    settings.iterations = 4 * settings.kernelReplications;
+    // Sample the first chunk, whose buffers are reused later in the stream, and a chunk whose result is still
+    // in its buffers at the end of the stream
+    settings.numRepetitions = 2;
+    data = bm->generateInputData();
+
+    bm->executeKernel(*data);
+    EXPECT_EQ(2, bm->getTimingsMap().at("execution").size());
+    EXPECT_TRUE(bm->validateOutput(*data));
+    // The sampled chunks have different inputs
+    const size_t fft_size = static_cast<size_t>(1) << LOG_FFT_SIZE;
+    EXPECT_FALSE(std::equal(data->data, data->data + fft_size, data->data + fft_size));
+    bm->collectResults();
+    auto results = bm->getResultsJson();
+    EXPECT_TRUE(results.count("transforms_avg"));
+    EXPECT_TRUE(results.count("transforms_max"));
+}
+
+/**
+ * Check if the R2C and C2R FFTs calculated with the FFT kernel are validated
+ */
+TEST_F(FFTKernelTest, RealFFTsAreValidated) {
+    auto& settings = *bm->getExecutionSettings().programSettings;
+    settings.logFFTSizes = {LOG_FFT_SIZE};
+    settings.real = true;
+    settings.iterations = 2 * settings.kernelReplications;
+    for (bool inverse : {false, true}) {
+        settings.inverse = inverse;
+        data = bm->generateInputData();
+        bm->executeKernel(*data);
+        EXPECT_TRUE(bm->validateOutput(*data));
+    }
+}
+
+/**
+ * Check if the in-order output is the bit reversed output of the FFT kernel and the reorder time is measured
+ */
+TEST_F(FFTKernelTest, InOrderOutputMatchesBitReversedOutput) {
+#ifndef FFT_REORDER_KERNEL
+    GTEST_SKIP() << "The kernel file does not contain reorder kernels";
+#endif
+    auto& settings = *bm->getExecutionSettings().programSettings;
+    settings.logFFTSizes = {LOG_FFT_SIZE};
+    data = bm->generateInputData();
+    bm->executeKernel(*data);
+    std::vector<std::complex<HOST_DATA_TYPE>> expected(data->data_out, data->data_out + (settings.iterations << LOG_FFT_SIZE));
+    fft::bit_reverse(expected.data(), settings.iterations);
+    settings.inOrder = true;
+    bm->executeKernel(*data);
+    EXPECT_EQ(1, bm->getTimingsMap().at("reorder").size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        EXPECT_FLOAT_EQ(data->data_out[i].real(), expected[i].real());
+        EXPECT_FLOAT_EQ(data->data_out[i].imag(), expected[i].imag());
+    }
+    EXPECT_TRUE(bm->validateOutput(*data));
+}
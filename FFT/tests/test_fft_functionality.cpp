@@ -122,6 +122,296 @@ TEST_F(FFTHostTest, FFTandiFFTProduceResultCloseToSource) {
     }
 }
 
+/**
+ * Check if the reference FFT and iFFT match a naive DFT for all FFT sizes up to the configured size
+ */
+TEST_F(FFTHostTest, FFTMatchesNaiveDFT) {
+    for (int log_size = 0; log_size <= LOG_FFT_SIZE; log_size++) {
+        const int size = 1 << log_size;
+        for (bool inverse : {false, true}) {
+            std::vector<std::complex<HOST_DATA_TYPE>> result(data->data, data->data + size);
+            fft::fourier_transform_gold(inverse, log_size, result.data());
+            for (int k = 0; k < size; k++) {
+                std::complex<double> expected = 0;
+                for (int j = 0; j < size; j++) {
+                    double angle = (inverse ? 2.0 : -2.0) * M_PI * ((static_cast<long>(j) * k) % size) / size;
+                    expected += std::complex<double>(data->data[j]) * std::polar(1.0, angle);
+                }
+                EXPECT_NEAR(result[k].real(), expected.real(), 0.0001 * (log_size + 1));
+                EXPECT_NEAR(result[k].imag(), expected.imag(), 0.0001 * (log_size + 1));
+            }
+        }
+    }
+}
+
+/**
+ * Check if the multidimensional reference FFT matches a naive 2D DFT
+ */
+TEST_F(FFTHostTest, MultiDimensionalFFTMatchesNaiveDFT) {
+    const int log_size = std::min(LOG_FFT_SIZE, 4);
+    const int size = 1 << log_size;
+    for (bool inverse : {false, true}) {
+        std::vector<std::complex<HOST_DATA_TYPE>> result(data->data, data->data + size * size);
+        fft::fourier_transform_gold_multidim(inverse, log_size, 2, result.data());
+        for (int k1 = 0; k1 < size; k1++) {
+            for (int k2 = 0; k2 < size; k2++) {
+                std::complex<double> expected = 0;
+                for (int j1 = 0; j1 < size; j1++) {
+                    for (int j2 = 0; j2 < size; j2++) {
+                        double angle = (inverse ? 2.0 : -2.0) * M_PI * ((j1 * k1 + j2 * k2) % size) / size;
+                        expected += std::complex<double>(data->data[j1 * size + j2]) * std::polar(1.0, angle);
+                    }
+                }
+                EXPECT_NEAR(result[k1 * size + k2].real(), expected.real(), 0.001);
+                EXPECT_NEAR(result[k1 * size + k2].imag(), expected.imag(), 0.001);
+            }
+        }
+    }
+}
+
+/**
+ * Check if the multidimensional FFT and iFFT result in the scaled input for 3 dimensions
+ */
+TEST_F(FFTHostTest, MultiDimensionalFFTandiFFTProduceResultCloseToSource) {
+    const int log_size = std::min(LOG_FFT_SIZE, 4);
+    const int total_size = 1 << (3 * log_size);
+    std::vector<std::complex<HOST_DATA_TYPE>> source(total_size);
+    for (int i = 0; i < total_size; i++) {
+        source[i] = data->data[i % (1 << LOG_FFT_SIZE)];
+    }
+    std::vector<std::complex<HOST_DATA_TYPE>> result(source);
+    fft::fourier_transform_gold_multidim(false, log_size, 3, result.data());
+    fft::fourier_transform_gold_multidim(true, log_size, 3, result.data());
+    for (int i = 0; i < total_size; i++) {
+        EXPECT_NEAR(std::abs(result[i] / static_cast<HOST_DATA_TYPE>(total_size) - source[i]), 0.0, 0.001);
+    }
+}
+
+/**
+ * Check if the distributed reference FFT matches the 1D reference FFT of the squared size.
+ * Every rank only passes its local block of the input. The test is also executed with multiple MPI ranks.
+ */
+TEST_F(FFTHostTest, DistributedFFTMatchesReferenceFFT) {
+    int mpi_rank = 0;
+    int mpi_size = 1;
+#ifdef _USE_MPI_
+    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+#endif
+    const int log_size = std::min(LOG_FFT_SIZE, 5);
+    const int total_size = 1 << (2 * log_size);
+    const int local_size = total_size / mpi_size;
+    std::vector<std::complex<HOST_DATA_TYPE>> source(total_size);
+    for (int i = 0; i < total_size; i++) {
+        source[i] = data->data[i % (1 << LOG_FFT_SIZE)] * static_cast<HOST_DATA_TYPE>(i % 3);
+    }
+    for (bool inverse : {false, true}) {
+        std::vector<std::complex<HOST_DATA_TYPE>> result(source.begin() + mpi_rank * local_size, source.begin() + (mpi_rank + 1) * local_size);
+        std::vector<std::complex<HOST_DATA_TYPE>> expected(source);
+        fft::fourier_transform_gold_distributed(inverse, log_size, result.data());
+        fft::fourier_transform_gold(inverse, 2 * log_size, expected.data());
+        for (int i = 0; i < local_size; i++) {
+            EXPECT_NEAR(std::abs(result[i] - expected[mpi_rank * local_size + i]), 0.0, 0.001);
+        }
+    }
+}
+
+/**
+ * Check if the distributed transpose of the measured execution matches a transpose of the gathered matrix.
+ * The test is also executed with multiple MPI ranks.
+ */
+TEST_F(FFTHostTest, DistributedTransposeMatchesGatheredTranspose) {
+    int mpi_rank = 0;
+    int mpi_size = 1;
+#ifdef _USE_MPI_
+    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+#endif
+    const int log_size = std::min(LOG_FFT_SIZE, 5);
+    const int n = 1 << log_size;
+    const int local_rows = n / mpi_size;
+    std::vector<std::complex<HOST_DATA_TYPE>> in(local_rows * n);
+    std::vector<std::complex<HOST_DATA_TYPE>> out(local_rows * n);
+    for (int r = 0; r < local_rows; r++) {
+        for (int c = 0; c < n; c++) {
+            in[r * n + c] = std::complex<HOST_DATA_TYPE>(mpi_rank * local_rows + r, c);
+        }
+    }
+    fft::distributed_transpose(in.data(), out.data(), log_size, false, 0);
+    for (int r = 0; r < local_rows; r++) {
+        for (int c = 0; c < n; c++) {
+            EXPECT_EQ(out[r * n + c], std::complex<HOST_DATA_TYPE>(c, mpi_rank * local_rows + r));
+        }
+    }
+}
+
+/**
+ * Check if FFT sizes that are not contained in the kernel file are rejected
+ */
+TEST_F(FFTHostTest, UnsupportedFFTSizeIsRejected) {
+    auto& settings = *bm->getExecutionSettings().programSettings;
+    settings.logFFTSizes = {LOG_FFT_SIZE};
+    EXPECT_TRUE(bm->checkInputParameters());
+    // Additional sizes are always smaller than LOG_FFT_SIZE
+    settings.logFFTSizes = {LOG_FFT_SIZE + 1};
+    EXPECT_FALSE(bm->checkInputParameters());
+}
+
+/**
+ * Check if only the sampled chunks of the batch are stored on the host for the streaming execution
+ */
+TEST_F(FFTHostTest, StreamingStoresSampledChunks) {
+    auto& settings = *bm->getExecutionSettings().programSettings;
+    settings.logFFTSizes = {LOG_FFT_SIZE};
+    settings.iterations = 8;
+    settings.streamChunkSize = 2;
+    EXPECT_TRUE(bm->checkInputParameters());
+    // One chunk is sampled for every repetition, but at most every chunk once
+    for (uint repetitions : {1u, 3u, 10u}) {
+        settings.numRepetitions = repetitions;
+        settings.logFFTSizes = {LOG_FFT_SIZE, LOG_FFT_SIZE};
+        data = bm->generateInputData();
+        ASSERT_EQ(data->offsets.size(), 2);
+        EXPECT_EQ(data->offsets[1], static_cast<size_t>(std::min(repetitions, 4u)) * 2 << LOG_FFT_SIZE);
+    }
+    settings.logFFTSizes = {LOG_FFT_SIZE};
+    settings.streamChunkSize = 3;
+    EXPECT_FALSE(bm->checkInputParameters());
+}
+
+/**
+ * Check if the generated inputs of the stream differ between chunks and can be generated again
+ */
+TEST_F(FFTHostTest, StreamChunksGetDifferentInputs) {
+    const size_t size = 64;
+    std::vector<std::complex<HOST_DATA_TYPE>> chunk0(size), chunk1(size), chunk0_again(size);
+    fft::generate_stream_chunk(chunk0.data(), size, 0);
+    fft::generate_stream_chunk(chunk1.data(), size, 1);
+    fft::generate_stream_chunk(chunk0_again.data(), size, 0);
+    EXPECT_EQ(chunk0, chunk0_again);
+    EXPECT_NE(chunk0, chunk1);
+    for (auto v : chunk1) {
+        EXPECT_GE(v.real(), -1.0);
+        EXPECT_LT(v.real(), 1.0);
+        EXPECT_GE(v.imag(), -1.0);
+        EXPECT_LT(v.imag(), 1.0);
+    }
+}
+
+/**
+ * Check if real FFTs are rejected if the packed FFTs can not be distributed equally over the kernel replications
+ */
+TEST_F(FFTHostTest, RealFFTPairsAreDistributedOverReplications) {
+#ifdef USE_SVM
+    GTEST_SKIP() << "Real FFTs are not supported with SVM";
+#endif
+    auto& settings = *bm->getExecutionSettings().programSettings;
+    settings.logFFTSizes = {LOG_FFT_SIZE};
+    settings.real = true;
+    settings.iterations = 2 * settings.kernelReplications;
+    EXPECT_TRUE(bm->checkInputParameters());
+    settings.iterations = 3;
+    EXPECT_FALSE(bm->checkInputParameters());
+    if (settings.kernelReplications > 1) {
+        settings.iterations = 2 * settings.kernelReplications + 2;
+        EXPECT_FALSE(bm->checkInputParameters());
+    }
+}
+
+/**
+ * Check if the half spectra separated from a packed complex FFT match the reference FFTs of the real signals
+ */
+TEST_F(FFTHostTest, RealSpectraMatchReferenceFFT) {
+    const int size = 1 << LOG_FFT_SIZE;
+    const int half = size / 2;
+    std::vector<HOST_DATA_TYPE> real(2 * size);
+    for (int i = 0; i < 2 * size; i++) {
+        real[i] = data->data[i % size].real() + data->data[i % size].imag() * (i / size);
+    }
+    std::vector<std::complex<HOST_DATA_TYPE>> packed(size);
+    fft::pack_real_signals(real.data(), packed.data(), 1, LOG_FFT_SIZE);
+    // The FFT kernel returns the result in bit reversed order
+    fft::fourier_transform_gold(false, LOG_FFT_SIZE, packed.data());
+    fft::bit_reverse(packed.data(), 1);
+    fft::unpack_real_spectra(packed.data(), 1, LOG_FFT_SIZE);
+    for (int signal = 0; signal < 2; signal++) {
+        std::vector<std::complex<HOST_DATA_TYPE>> expected(real.begin() + signal * size, real.begin() + (signal + 1) * size);
+        fft::fourier_transform_gold(false, LOG_FFT_SIZE, expected.data());
+        const std::complex<HOST_DATA_TYPE>* spectrum = &packed[signal * half];
+        EXPECT_NEAR(spectrum[0].real(), expected[0].real(), 0.001);
+        EXPECT_NEAR(spectrum[0].imag(), expected[half].real(), 0.001);
+        for (int k = 1; k < half; k++) {
+            EXPECT_NEAR(std::abs(spectrum[k] - expected[k]), 0.0, 0.001);
+        }
+    }
+}
+
+/**
+ * Check if the real signals are restored from their half spectra by the packed inverse FFT
+ */
+TEST_F(FFTHostTest, RealSignalsRestoredFromSpectra) {
+    const int size = 1 << LOG_FFT_SIZE;
+    std::vector<HOST_DATA_TYPE> real(2 * size);
+    std::vector<HOST_DATA_TYPE> restored(2 * size);
+    for (int i = 0; i < 2 * size; i++) {
+        real[i] = data->data[i % size].real() + data->data[i % size].imag() * (i / size);
+    }
+    std::vector<std::complex<HOST_DATA_TYPE>> packed(size);
+    fft::pack_real_signals(real.data(), packed.data(), 1, LOG_FFT_SIZE);
+    fft::fourier_transform_gold(false, LOG_FFT_SIZE, packed.data());
+    fft::bit_reverse(packed.data(), 1);
+    fft::unpack_real_spectra(packed.data(), 1, LOG_FFT_SIZE);
+    std::vector<std::complex<HOST_DATA_TYPE>> spectra(packed);
+    fft::pack_real_spectra(spectra.data(), packed.data(), 1, LOG_FFT_SIZE);
+    fft::fourier_transform_gold(true, LOG_FFT_SIZE, packed.data());
+    fft::bit_reverse(packed.data(), 1);
+    fft::unpack_real_signals(packed.data(), restored.data(), 1, LOG_FFT_SIZE);
+    for (int i = 0; i < 2 * size; i++) {
+        EXPECT_NEAR(restored[i] / size, real[i], 0.001);
+    }
+}
+
+/**
+ * Check if bit reversal is applied to every FFT of a batch and is its own inverse
+ */
+TEST_F(FFTHostTest, BitReverseMultipleIterations) {
+    const int iterations = 3;
+    std::vector<std::complex<HOST_DATA_TYPE>> values(iterations * (1 << LOG_FFT_SIZE));
+    for (int i = 0; i < values.size(); i++) {
+        values[i] = std::complex<HOST_DATA_TYPE>(i, 0);
+    }
+    fft::bit_reverse(values.data(), iterations);
+    const fft::FFTPlan& plan = fft::getFFTPlan(LOG_FFT_SIZE);
+    for (int k = 0; k < iterations; k++) {
+        for (int i = 0; i < (1 << LOG_FFT_SIZE); i++) {
+            EXPECT_FLOAT_EQ(values[k * (1 << LOG_FFT_SIZE) + i].real(), k * (1 << LOG_FFT_SIZE) + plan.bit_reversal[i]);
+        }
+    }
+    fft::bit_reverse(values.data(), iterations);
+    for (int i = 0; i < values.size(); i++) {
+        EXPECT_FLOAT_EQ(values[i].real(), i);
+    }
+}
+
+/**
+ * Check if the data of multiple FFT sizes is stored one after another
+ */
+TEST_F(FFTHostTest, DataLayoutForMultipleSizes) {
+    bm->getExecutionSettings().programSettings->logFFTSizes = {LOG_FFT_SIZE, 3};
+    data = bm->generateInputData();
+    uint iterations = bm->getExecutionSettings().programSettings->iterations;
+    ASSERT_EQ(data->offsets.size(), 2);
+    EXPECT_EQ(data->offsets[0], 0);
+    EXPECT_EQ(data->offsets[1], static_cast<size_t>(iterations) << LOG_FFT_SIZE);
+    // The input data of the first size does not change if more sizes are added
+    bm->getExecutionSettings().programSettings->logFFTSizes = {LOG_FFT_SIZE};
+    auto verify_data = bm->generateInputData();
+    for (size_t i = 0; i < (static_cast<size_t>(iterations) << LOG_FFT_SIZE); i++) {
+        EXPECT_FLOAT_EQ(data->data[i].real(), verify_data->data[i].real());
+        EXPECT_FLOAT_EQ(data->data[i].imag(), verify_data->data[i].imag());
+    }
+}
+
 using json = nlohmann::json;
 
 TEST_F(FFTHostTest, JsonDump) {
@@ -30,6 +30,20 @@ SOFTWARE.
 #pragma OPENCL EXTENSION cl_khr_fp16 : enable
 #endif
 
+/**
+Load a value of the input matrices A and B from global memory and convert it to the
+data type used for the calculation.
+Half precision inputs are converted with vload_half. bfloat16 values are the upper 16 bits of
+a single precision value, so they are converted by shifting their raw bits.
+*/
+#if defined(INPUT_DATA_TYPE_HALF)
+#define LOAD_INPUT(ptr, index) vload_half((index), (ptr))
+#elif defined(INPUT_DATA_TYPE_BFLOAT16)
+#define LOAD_INPUT(ptr, index) as_float(((uint) (ptr)[(index)]) << 16)
+#else
+#define LOAD_INPUT(ptr, index) (ptr)[(index)]
+#endif
+
 // code generation expects an array of maps of size num_replications with the keys a,b,c,out.
 // The value of the keys have to be strings containing the attributes that
 // have to be assigned to input and output buffers in global memory
@@ -266,13 +280,20 @@ Two level blocked GEMM kernel
 
 calculates C_OUT = alpha * A.dot(B) + beta * C
 
-@param a The data array representing the whole matrix a in global memory
-@param b The data array representing the whole matrix b in global memory
+@param a The data array representing the whole matrix a in global memory. The values may be stored in a reduced
+            precision format given by DEVICE_INPUT_DATA_TYPE
+@param b The data array representing the whole matrix b in global memory. The values may be stored in a reduced
+            precision format given by DEVICE_INPUT_DATA_TYPE
 @param c The data array representing the whole matrix c in global memory
 @param c_out The data array that will used as output of the result
 @param alpha The alpha scalar value
 @param beta The beta scalar value
-@param a_size the x and y size of the matrix in blocks
+@param a_size the number of columns of A and rows of B in blocks
+@param out_offset the first row of blocks of the result that is calculated by this kernel
+@param max_block the row of blocks after the last row of blocks that is calculated by this kernel
+@param batch_count the number of independent matrices that are stored contiguously in all buffers and
+                    calculated one after another. In this case, every kernel has to calculate the whole matrices.
+@param b_size the number of columns of B and C in blocks
 */
 __attribute__((uses_global_work_offset(0)))
 __kernel
@@ -287,8 +308,8 @@ void gemm{{ i }}(
           const float alpha,
           const float beta,
 #else
-            __global {{ kernel_param_attributes[i]["a"] }} const DEVICE_DATA_TYPE* restrict a,
-          __global {{ kernel_param_attributes[i]["b"] }} const DEVICE_DATA_TYPE* restrict b,
+            __global {{ kernel_param_attributes[i]["a"] }} const DEVICE_INPUT_DATA_TYPE* restrict a,
+          __global {{ kernel_param_attributes[i]["b"] }} const DEVICE_INPUT_DATA_TYPE* restrict b,
           __global {{ kernel_param_attributes[i]["c"] }} const DEVICE_DATA_TYPE* restrict c,
           __global {{ kernel_param_attributes[i]["out"] }} DEVICE_DATA_TYPE* restrict c_out,
           const DEVICE_DATA_TYPE alpha,
@@ -296,11 +317,25 @@ void gemm{{ i }}(
 #endif
           const uint a_size,
           const uint out_offset,
-          const uint max_block) {
+          const uint max_block,
+          const uint batch_count,
+          const uint b_size) {
 
-    const unsigned size = a_size * BLOCK_SIZE;
+    // Leading dimensions of A and of B, C and the result
+    const unsigned lda = a_size * BLOCK_SIZE;
+    const unsigned ldb = b_size * BLOCK_SIZE;
 
-    // Level 1 Matrix Multiplication
+#ifdef INTEL_FPGA
+#pragma disable_loop_pipelining
+#endif
+    for (unsigned batch = 0; batch < batch_count; batch++) {
+
+        // Offset of the current matrix in all buffers
+        const ulong a_offset = (ulong)batch * max_block * BLOCK_SIZE * lda;
+        const ulong b_offset = (ulong)batch * lda * ldb;
+        const ulong c_offset = (ulong)batch * max_block * BLOCK_SIZE * ldb;
+
+        // Level 1 Matrix Multiplication
 #ifdef INTEL_FPGA
 #pragma loop_coalesce 2
 #pragma disable_loop_pipelining
@@ -309,22 +344,22 @@ void gemm{{ i }}(
 // These two loops will not be coalesced, but should not produce much overhead because the outer loop does 
 // not do a lot of iterations
 #endif
-    for (unsigned y_block = out_offset; y_block < max_block; y_block++) {
+        for (unsigned y_block = out_offset; y_block < max_block; y_block++) {
 #ifdef INTEL_FPGA
 #pragma disable_loop_pipelining
 #endif
-        for (unsigned x_block = 0; x_block < a_size; x_block++) {
-            DEVICE_DATA_TYPE c_block[BLOCK_SIZE / GEMM_BLOCK][BLOCK_SIZE / GEMM_BLOCK]
-            [GEMM_BLOCK][GEMM_BLOCK]  __attribute((numbanks(GEMM_BLOCK * GEMM_BLOCK),xcl_array_partition(complete, 3),xcl_array_partition(complete, 4)));
+            for (unsigned x_block = 0; x_block < b_size; x_block++) {
+                DEVICE_DATA_TYPE c_block[BLOCK_SIZE / GEMM_BLOCK][BLOCK_SIZE / GEMM_BLOCK]
+                [GEMM_BLOCK][GEMM_BLOCK]  __attribute((numbanks(GEMM_BLOCK * GEMM_BLOCK),xcl_array_partition(complete, 3),xcl_array_partition(complete, 4)));
 #ifdef INTEL_FPGA
 #pragma disable_loop_pipelining
 #endif
-            for (unsigned diagonal_block=0; diagonal_block < a_size; diagonal_block++) {
-                DEVICE_DATA_TYPE a_block[BLOCK_SIZE / GEMM_BLOCK][BLOCK_SIZE / GEMM_BLOCK]
-                                        [GEMM_BLOCK][GEMM_BLOCK]  __attribute((numbanks(GEMM_BLOCK * GEMM_BLOCK),xcl_array_partition(complete, 3),xcl_array_partition(complete, 4)));
-                DEVICE_DATA_TYPE b_block[BLOCK_SIZE / GEMM_BLOCK][BLOCK_SIZE / GEMM_BLOCK]
-                                        [GEMM_BLOCK][GEMM_BLOCK]  __attribute((numbanks(GEMM_BLOCK * GEMM_BLOCK),xcl_array_partition(complete, 3),xcl_array_partition(complete, 4)));
-                // Load all needed level 1 blocks
+                for (unsigned diagonal_block=0; diagonal_block < a_size; diagonal_block++) {
+                    DEVICE_DATA_TYPE a_block[BLOCK_SIZE / GEMM_BLOCK][BLOCK_SIZE / GEMM_BLOCK]
+                                            [GEMM_BLOCK][GEMM_BLOCK]  __attribute((numbanks(GEMM_BLOCK * GEMM_BLOCK),xcl_array_partition(complete, 3),xcl_array_partition(complete, 4)));
+                    DEVICE_DATA_TYPE b_block[BLOCK_SIZE / GEMM_BLOCK][BLOCK_SIZE / GEMM_BLOCK]
+                                            [GEMM_BLOCK][GEMM_BLOCK]  __attribute((numbanks(GEMM_BLOCK * GEMM_BLOCK),xcl_array_partition(complete, 3),xcl_array_partition(complete, 4)));
+                    // Load all needed level 1 blocks
 
 #ifdef INTEL_FPGA
 // Coalesce both loops to generate single loop
@@ -343,48 +378,48 @@ void gemm{{ i }}(
 __attribute__((xcl_pipeline_loop(1)))
 #endif
 #endif
-                for (unsigned i = 0; i < BLOCK_SIZE ; i++) {
+                    for (unsigned i = 0; i < BLOCK_SIZE ; i++) {
 #ifdef XILINX_FPGA
 #ifndef XILINX_UNROLL_GLOBAL_MEM_PIPELINE
 __attribute__((xcl_pipeline_loop(1)))
 #endif
 #endif
-                    for (unsigned j = 0; j < BLOCK_SIZE; j += GLOBAL_MEM_UNROLL) {
+                        for (unsigned j = 0; j < BLOCK_SIZE; j += GLOBAL_MEM_UNROLL) {
 
 #ifdef ENABLE_MIXED_PRECISION
-                        float a_reorder_buffer[GLOBAL_MEM_UNROLL];
-                        float b_reorder_buffer[GLOBAL_MEM_UNROLL];
+                            float a_reorder_buffer[GLOBAL_MEM_UNROLL];
+                            float b_reorder_buffer[GLOBAL_MEM_UNROLL];
 #else
-                        DEVICE_DATA_TYPE a_reorder_buffer[GLOBAL_MEM_UNROLL];
-                        DEVICE_DATA_TYPE b_reorder_buffer[GLOBAL_MEM_UNROLL];
+                            DEVICE_DATA_TYPE a_reorder_buffer[GLOBAL_MEM_UNROLL];
+                            DEVICE_DATA_TYPE b_reorder_buffer[GLOBAL_MEM_UNROLL];
 #endif
 __attribute__((opencl_unroll_hint(GLOBAL_MEM_UNROLL)))
-                        for (unsigned u = 0; u < GLOBAL_MEM_UNROLL; u++) {
-                            a_reorder_buffer[u] = a[(y_block * size + diagonal_block) * BLOCK_SIZE +
-                                j + u + i * size];
-                            b_reorder_buffer[u] = b[(diagonal_block * size + x_block) * BLOCK_SIZE +
-                                                          j + u + i * size];
-                        }
+                            for (unsigned u = 0; u < GLOBAL_MEM_UNROLL; u++) {
+                                a_reorder_buffer[u] = LOAD_INPUT(a, a_offset + (y_block * lda + diagonal_block) * BLOCK_SIZE +
+                                    j + u + i * lda);
+                                b_reorder_buffer[u] = LOAD_INPUT(b, b_offset + (diagonal_block * ldb + x_block) * BLOCK_SIZE +
+                                                              j + u + i * ldb);
+                            }
 __attribute__((opencl_unroll_hint(GLOBAL_MEM_UNROLL/GEMM_BLOCK)))
-                        for (unsigned b = 0; b < GLOBAL_MEM_UNROLL/GEMM_BLOCK; b++) {
+                            for (unsigned b = 0; b < GLOBAL_MEM_UNROLL/GEMM_BLOCK; b++) {
 __attribute__((opencl_unroll_hint(GEMM_BLOCK)))
-                            for (unsigned u = 0; u < GEMM_BLOCK; u++) {
+                                for (unsigned u = 0; u < GEMM_BLOCK; u++) {
 #ifdef ENABLE_MIXED_PRECISION
-                                vstore_half(a_reorder_buffer[b * GEMM_BLOCK + u], u, &a_block[i / GEMM_BLOCK][j / GEMM_BLOCK + b][i & (GEMM_BLOCK - 1)][0]);
-                                vstore_half(b_reorder_buffer[b * GEMM_BLOCK + u], u , &b_block[i / GEMM_BLOCK][j / GEMM_BLOCK + b][i & (GEMM_BLOCK - 1)][0]);
+                                    vstore_half(a_reorder_buffer[b * GEMM_BLOCK + u], u, &a_block[i / GEMM_BLOCK][j / GEMM_BLOCK + b][i & (GEMM_BLOCK - 1)][0]);
+                                    vstore_half(b_reorder_buffer[b * GEMM_BLOCK + u], u , &b_block[i / GEMM_BLOCK][j / GEMM_BLOCK + b][i & (GEMM_BLOCK - 1)][0]);
 #else
-                                a_block[i / GEMM_BLOCK][j / GEMM_BLOCK + b][i & (GEMM_BLOCK - 1)][u] = a_reorder_buffer[b * GEMM_BLOCK + u];
-                                b_block[i / GEMM_BLOCK][j / GEMM_BLOCK + b][i & (GEMM_BLOCK - 1)][u] = b_reorder_buffer[b * GEMM_BLOCK + u];
+                                    a_block[i / GEMM_BLOCK][j / GEMM_BLOCK + b][i & (GEMM_BLOCK - 1)][u] = a_reorder_buffer[b * GEMM_BLOCK + u];
+                                    b_block[i / GEMM_BLOCK][j / GEMM_BLOCK + b][i & (GEMM_BLOCK - 1)][u] = b_reorder_buffer[b * GEMM_BLOCK + u];
 #endif
+                                }
                             }
                         }
                     }
-                }
 
-                local_gemm(a_block, b_block, c_block, diagonal_block);
-            }
+                    local_gemm(a_block, b_block, c_block, diagonal_block);
+                }
 
-    unsigned moved_y_block = y_block - out_offset;
+        unsigned moved_y_block = y_block - out_offset;
 
 #ifdef INTEL_FPGA
 #pragma loop_coalesce
@@ -402,42 +437,43 @@ __attribute__((opencl_unroll_hint(GEMM_BLOCK)))
 __attribute__((xcl_pipeline_loop(1)))
 #endif
 #endif
-            for (unsigned i = 0; i < BLOCK_SIZE; i++) {
+                for (unsigned i = 0; i < BLOCK_SIZE; i++) {
 #ifdef XILINX_FPGA
 #ifndef XILINX_UNROLL_GLOBAL_MEM_PIPELINE
 __attribute__((xcl_pipeline_loop(1)))
 #endif
 #endif
-                for (unsigned j = 0; j < BLOCK_SIZE/GLOBAL_MEM_UNROLL; j++) {
+                    for (unsigned j = 0; j < BLOCK_SIZE/GLOBAL_MEM_UNROLL; j++) {
 
 #ifdef ENABLE_MIXED_PRECISION
-                    // With half precision data type this algorithm still uses single precision for the last addition
-                    // to get rid of additional conversions
-                    float c_reorder_buffer[GLOBAL_MEM_UNROLL];
-                    float matrix_block_part[GLOBAL_MEM_UNROLL];
-                    __attribute__((opencl_unroll_hint(GLOBAL_MEM_UNROLL)))
-                    for (unsigned u = 0; u < GLOBAL_MEM_UNROLL; u++) {
-                        c_reorder_buffer[u] = c[(y_block * size + x_block) * BLOCK_SIZE + j * GLOBAL_MEM_UNROLL + i * size + u];
-                        matrix_block_part[u] = vload_half(0, &c_block[i/GEMM_BLOCK][(j * GLOBAL_MEM_UNROLL + u)/GEMM_BLOCK][i & (GEMM_BLOCK - 1)][u & (GEMM_BLOCK - 1)]);
-                    }
+                        // With half precision data type this algorithm still uses single precision for the last addition
+                        // to get rid of additional conversions
+                        float c_reorder_buffer[GLOBAL_MEM_UNROLL];
+                        float matrix_block_part[GLOBAL_MEM_UNROLL];
+                        __attribute__((opencl_unroll_hint(GLOBAL_MEM_UNROLL)))
+                        for (unsigned u = 0; u < GLOBAL_MEM_UNROLL; u++) {
+                            c_reorder_buffer[u] = c[c_offset + (y_block * ldb + x_block) * BLOCK_SIZE + j * GLOBAL_MEM_UNROLL + i * ldb + u];
+                            matrix_block_part[u] = vload_half(0, &c_block[i/GEMM_BLOCK][(j * GLOBAL_MEM_UNROLL + u)/GEMM_BLOCK][i & (GEMM_BLOCK - 1)][u & (GEMM_BLOCK - 1)]);
+                        }
 __attribute__((opencl_unroll_hint(GLOBAL_MEM_UNROLL)))
-                    for (unsigned u = 0; u < GLOBAL_MEM_UNROLL; u++) {
-                        c_out[(moved_y_block * size + x_block) * BLOCK_SIZE + j * GLOBAL_MEM_UNROLL + u
-                                + i * size] = beta * c_reorder_buffer[u] + alpha * c_block[i/GEMM_BLOCK][j * GLOBAL_MEM_UNROLL/ GEMM_BLOCK][i & (GEMM_BLOCK - 1)][u];
-                    }
+                        for (unsigned u = 0; u < GLOBAL_MEM_UNROLL; u++) {
+                            c_out[c_offset + (moved_y_block * ldb + x_block) * BLOCK_SIZE + j * GLOBAL_MEM_UNROLL + u
+                                    + i * ldb] = beta * c_reorder_buffer[u] + alpha * c_block[i/GEMM_BLOCK][j * GLOBAL_MEM_UNROLL/ GEMM_BLOCK][i & (GEMM_BLOCK - 1)][u];
+                        }
 #else
-                    DEVICE_DATA_TYPE c_reorder_buffer[GLOBAL_MEM_UNROLL];
+                        DEVICE_DATA_TYPE c_reorder_buffer[GLOBAL_MEM_UNROLL];
 __attribute__((opencl_unroll_hint(GLOBAL_MEM_UNROLL)))
-                    for (unsigned u = 0; u < GLOBAL_MEM_UNROLL; u++) {
-                        c_reorder_buffer[u] = c[(y_block * size + x_block) * BLOCK_SIZE + j * GLOBAL_MEM_UNROLL + i * size + u];
-                    }
+                        for (unsigned u = 0; u < GLOBAL_MEM_UNROLL; u++) {
+                            c_reorder_buffer[u] = c[c_offset + (y_block * ldb + x_block) * BLOCK_SIZE + j * GLOBAL_MEM_UNROLL + i * ldb + u];
+                        }
 __attribute__((opencl_unroll_hint(GLOBAL_MEM_UNROLL)))
-                    for (unsigned u = 0; u < GLOBAL_MEM_UNROLL; u++) {
-                        c_out[(moved_y_block * size + x_block) * BLOCK_SIZE + j * GLOBAL_MEM_UNROLL + u
-                                + i * size] = beta * c_reorder_buffer[u] +
-                                alpha * c_block[i/GEMM_BLOCK][(j * GLOBAL_MEM_UNROLL + u)/GEMM_BLOCK][i & (GEMM_BLOCK - 1)][(j * GLOBAL_MEM_UNROLL + u) & (GEMM_BLOCK - 1)];
-                    }
+                        for (unsigned u = 0; u < GLOBAL_MEM_UNROLL; u++) {
+                            c_out[c_offset + (moved_y_block * ldb + x_block) * BLOCK_SIZE + j * GLOBAL_MEM_UNROLL + u
+                                    + i * ldb] = beta * c_reorder_buffer[u] +
+                                    alpha * c_block[i/GEMM_BLOCK][(j * GLOBAL_MEM_UNROLL + u)/GEMM_BLOCK][i & (GEMM_BLOCK - 1)][(j * GLOBAL_MEM_UNROLL + u) & (GEMM_BLOCK - 1)];
+                        }
 #endif
+                    }
                 }
             }
         }
@@ -47,12 +47,101 @@ simple exchange of the different calculation methods.
 @param dataSize The size of the data array that may be used for benchmark
                 execution in number of items
 @param blockSize Size of a block that is calculated by the kernel
+@param a matrix A, converted to the input data type of the device
+@param b matrix B, converted to the input data type of the device
 
 @return The time measurements
 */
 std::map<std::string, std::vector<double>>
+calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings, cl::Device, cl::Context, cl::Program> const& config, HOST_INPUT_DATA_TYPE* a, HOST_INPUT_DATA_TYPE* b, HOST_DATA_TYPE* c,
+        HOST_DATA_TYPE* c_out, HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta);
+
+/**
+Calculate the placement of the device buffers for the default execution.
+The placement strategy depends on the target device and the memory interleaving and the sub-buffers are aligned
+to the base address alignment of the device.
+
+@param config The execution settings containing the device
+
+@return The memory plan that is used by the default execution
+*/
+gemm::GEMMMemoryPlan
+planMemory(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings, cl::Device, cl::Context, cl::Program> const& config);
+
+namespace batched {
+
+/**
+Execution of the GEMM for a batch of independent matrices.
+The matrices are stored contiguously and the batch is split into contiguous parts for every kernel replication.
+Every kernel replication calculates all matrices of its part with a single kernel execution.
+
+@param config The execution settings containing the batch size
+@param a batch of matrices A, converted to the input data type of the device
+@param b batch of matrices B, converted to the input data type of the device
+@param c batch of matrices C
+@param c_out batch of result matrices
+@param alpha scalar value used to scale A * B
+@param beta scalar value used to scale C
+
+@return The time measurements for the execution of the whole batch, the average time per matrix and the latency of
+        a single matrix that is calculated in its own kernel execution
+*/
+std::map<std::string, std::vector<double>>
+calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings, cl::Device, cl::Context, cl::Program> const& config, HOST_INPUT_DATA_TYPE* a, HOST_INPUT_DATA_TYPE* b, HOST_DATA_TYPE* c,
+        HOST_DATA_TYPE* c_out, HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta);
+
+}  // namespace batched
+
+namespace streaming {
+
+/**
+Out-of-core execution of the GEMM for matrices that do not fit into the device memory.
+The matrices are partitioned into square super-tiles that are streamed to the device. The partial results
+of a tile of C are accumulated on the device over all tiles of K. The transfers of the input tiles for the next step
+and the write-back of finished tiles of C overlap with the kernel execution.
+
+@param config The execution settings containing the size of the super-tiles
+@param a matrix A
+@param b matrix B
+@param c matrix C
+@param c_out the result matrix
+@param alpha scalar value used to scale A * B
+@param beta scalar value used to scale C
+
+@return The time measurements for the total execution including all transfers, the exposed transfers and the calculation
+*/
+std::map<std::string, std::vector<double>>
 calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings, cl::Device, cl::Context, cl::Program> const& config, HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, HOST_DATA_TYPE* c,
         HOST_DATA_TYPE* c_out, HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta);
+
+}  // namespace streaming
+
+#ifdef _USE_MPI_
+namespace pcie {
+
+/**
+Distributed execution of the GEMM using the SUMMA algorithm.
+The matrices are distributed block-cyclic over a square torus of ranks. In every step, the local tiles of A
+are broadcasted along the rows and the local tiles of B along the columns of the torus.
+The broadcast for the next step overlaps with the kernel execution of the current step.
+
+@param config The execution settings containing the torus configuration
+@param a local tile of matrix A
+@param b local tile of matrix B
+@param c local tile of matrix C
+@param c_out local tile of the result matrix
+@param alpha scalar value used to scale A * B
+@param beta scalar value used to scale C
+
+@return The time measurements for the total execution, the exposed communication and the calculation
+*/
+std::map<std::string, std::vector<double>>
+calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings, cl::Device, cl::Context, cl::Program> const& config, HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, HOST_DATA_TYPE* c,
+        HOST_DATA_TYPE* c_out, HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta);
+
+}  // namespace pcie
+#endif
+
 }  // namespace bm_execution
 
 #endif  // SRC_HOST_EXECUTION_H_
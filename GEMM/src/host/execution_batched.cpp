@@ -0,0 +1,223 @@
+/*
+Copyright (c) 2023 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* Related header files */
+#include "execution.h"
+
+/* C++ standard library headers */
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+/* External library headers */
+#ifdef INTEL_FPGA
+#include "CL/cl_ext_intelfpga.h"
+#endif
+
+
+namespace bm_execution {
+namespace batched {
+
+/*
+ Prepare kernels and execute the benchmark for a batch of matrices
+
+ @copydoc bm_execution::batched::calculate()
+*/
+std::map<std::string, std::vector<double>>
+calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings, cl::Device, cl::Context, cl::Program> const& config, HOST_INPUT_DATA_TYPE* a, HOST_INPUT_DATA_TYPE* b, HOST_DATA_TYPE* c, HOST_DATA_TYPE* c_out,
+        HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta) {
+
+    int err;
+
+    size_t matrix_elements = static_cast<size_t>(config.programSettings->matrixSize) * config.programSettings->matrixSize;
+    cl_int size_in_blocks = config.programSettings->matrixSize / config.programSettings->blockSize;
+    uint batch_size = config.programSettings->batchSize;
+    uint matrices_per_kernel = (batch_size + config.programSettings->kernelReplications - 1) / config.programSettings->kernelReplications;
+
+    // Create Command queues. Profiling is used to measure the execution time of every kernel replication
+    std::vector<cl::CommandQueue> compute_queues;
+    for (int i=0; i < config.programSettings->kernelReplications; i++) {
+        compute_queues.push_back(cl::CommandQueue(*config.context, *config.device, CL_QUEUE_PROFILING_ENABLE, &err));
+        ASSERT_CL(err)
+    }
+
+    int memory_bank_info[4] = {0};
+#ifdef INTEL_FPGA
+#ifdef USE_HBM
+    // For Intel HBM the buffers have to be created with a special flag
+    for (int& v : memory_bank_info) {
+                v = CL_MEM_HETEROGENEOUS_INTELFPGA;
+    }
+#else
+    // Set the memory bank bits if memory interleaving is not used
+    if (!config.programSettings->useMemoryInterleaving) {
+            for (int k = 0; k < 4; k++) {
+                memory_bank_info[k] = ((1 + k) << 16);
+            }
+    }
+#endif
+#endif
+
+    // Every kernel replication calculates a contiguous part of the batch, so every replication gets its own buffers
+    // containing only its matrices
+    std::vector<cl::Buffer> a_buffers;
+    std::vector<cl::Buffer> b_buffers;
+    std::vector<cl::Buffer> c_buffers;
+    std::vector<cl::Buffer> out_buffers;
+    std::vector<uint> batch_offsets;
+    std::vector<uint> batch_counts;
+    for (uint offset = 0; offset < batch_size; offset += matrices_per_kernel) {
+        uint count = std::min(matrices_per_kernel, batch_size - offset);
+        batch_offsets.push_back(offset);
+        batch_counts.push_back(count);
+        size_t bytes = sizeof(HOST_DATA_TYPE) * matrix_elements * count;
+        size_t input_bytes = sizeof(HOST_INPUT_DATA_TYPE) * matrix_elements * count;
+        a_buffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[0], input_bytes, NULL, &err));
+        ASSERT_CL(err)
+        b_buffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[1], input_bytes, NULL, &err));
+        ASSERT_CL(err)
+        c_buffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[2], bytes, NULL, &err));
+        ASSERT_CL(err)
+        out_buffers.push_back(cl::Buffer(*config.context, CL_MEM_WRITE_ONLY | memory_bank_info[3], bytes, NULL, &err));
+        ASSERT_CL(err)
+    }
+
+    std::vector<cl::Kernel> gemmkernels;
+    for (int i=0; i < batch_counts.size(); i++) {
+#ifdef INTEL_FPGA
+        // create the kernels
+        cl::Kernel gemmkernel(*config.program, (KERNEL_NAME + std::to_string(i)).c_str(),
+                                        &err);
+        ASSERT_CL(err);
+#endif
+#ifdef XILINX_FPGA
+        // create the kernels
+        cl::Kernel gemmkernel(*config.program, (std::string(KERNEL_NAME) + "0:{" + KERNEL_NAME + "0_" +  std::to_string(i + 1) + "}").c_str(),
+                                        &err);
+        ASSERT_CL(err);
+#endif
+        err = gemmkernel.setArg(0, a_buffers[i]);
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(1, b_buffers[i]);
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(2, c_buffers[i]);
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(3, out_buffers[i]);
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(4, alpha);
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(5, beta);
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(6, size_in_blocks);
+        ASSERT_CL(err);
+        // Every kernel calculates the whole matrices of its part of the batch
+        err = gemmkernel.setArg(7, static_cast<cl_uint>(0));
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(8, static_cast<cl_uint>(size_in_blocks));
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(9, static_cast<cl_uint>(batch_counts[i]));
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(10, size_in_blocks);
+        ASSERT_CL(err);
+        gemmkernels.push_back(gemmkernel);
+    }
+
+    /* --- Execute actual benchmark kernels --- */
+
+    std::vector<double> executionTimes;
+    std::vector<double> matrixTimes;
+    std::vector<double> latencyTimes;
+    for (int repetition = 0; repetition < config.programSettings->numRepetitions; repetition++) {
+        for (int i = 0; i < gemmkernels.size(); i++) {
+            size_t offset = matrix_elements * batch_offsets[i];
+            size_t bytes = sizeof(HOST_DATA_TYPE) * matrix_elements * batch_counts[i];
+            size_t input_bytes = sizeof(HOST_INPUT_DATA_TYPE) * matrix_elements * batch_counts[i];
+            err = compute_queues[i].enqueueWriteBuffer(a_buffers[i], CL_FALSE, 0, input_bytes, &a[offset]);
+            ASSERT_CL(err)
+            err = compute_queues[i].enqueueWriteBuffer(b_buffers[i], CL_FALSE, 0, input_bytes, &b[offset]);
+            ASSERT_CL(err)
+            err = compute_queues[i].enqueueWriteBuffer(c_buffers[i], CL_FALSE, 0, bytes, &c[offset]);
+            ASSERT_CL(err)
+        }
+        for (int i = 0; i < gemmkernels.size(); i++) {
+            compute_queues[i].finish();
+        }
+
+        // A single kernel execution per replication calculates all its matrices
+        std::vector<cl::Event> kernel_events(gemmkernels.size());
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < gemmkernels.size(); i++) {
+            err = compute_queues[i].enqueueNDRangeKernel(gemmkernels[i], cl::NullRange, cl::NDRange(1), cl::NullRange, nullptr, &kernel_events[i]);
+            ASSERT_CL(err);
+            compute_queues[i].flush();
+        }
+        for (int i = 0; i < gemmkernels.size(); i++) {
+            compute_queues[i].finish();
+        }
+        auto t2 = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> timespan = t2 - t1;
+        executionTimes.push_back(timespan.count());
+
+        // The matrices of a replication are calculated one after another, so the average time per matrix
+        // is the execution time of the kernel divided by the number of its matrices. The slowest replication is reported.
+        double matrix_time = 0.0;
+        for (int i = 0; i < gemmkernels.size(); i++) {
+            double kernel_time = static_cast<double>(kernel_events[i].getProfilingInfo<CL_PROFILING_COMMAND_END>() -
+                                                        kernel_events[i].getProfilingInfo<CL_PROFILING_COMMAND_START>()) * 1.0e-9;
+            matrix_time = std::max(matrix_time, kernel_time / batch_counts[i]);
+        }
+        matrixTimes.push_back(matrix_time);
+
+        // Measure the latency of a single matrix in its own kernel execution, which includes the overhead of the kernel call.
+        // The first matrix of the first replication is calculated again, so the result does not change
+        err = gemmkernels[0].setArg(9, static_cast<cl_uint>(1));
+        ASSERT_CL(err);
+        auto t_single_start = std::chrono::high_resolution_clock::now();
+        err = compute_queues[0].enqueueNDRangeKernel(gemmkernels[0], cl::NullRange, cl::NDRange(1), cl::NullRange);
+        ASSERT_CL(err);
+        compute_queues[0].finish();
+        auto t_single_end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> single_timespan = t_single_end - t_single_start;
+        latencyTimes.push_back(single_timespan.count());
+        err = gemmkernels[0].setArg(9, static_cast<cl_uint>(batch_counts[0]));
+        ASSERT_CL(err);
+    }
+
+    /* --- Read back results from Device --- */
+    for (int i = 0; i < gemmkernels.size(); i++) {
+        err = compute_queues[i].enqueueReadBuffer(out_buffers[i], CL_TRUE, 0,
+                                    sizeof(HOST_DATA_TYPE) * matrix_elements * batch_counts[i],
+                                    &c_out[matrix_elements * batch_offsets[i]]);
+        ASSERT_CL(err)
+    }
+
+    std::map<std::string, std::vector<double>> timings;
+
+    timings["execution"] = executionTimes;
+    timings["matrix"] = matrixTimes;
+    timings["latency"] = latencyTimes;
+    return timings;
+}
+
+}  // namespace batched
+}  // namespace bm_execution
@@ -24,6 +24,7 @@ SOFTWARE.
 #include "execution.h"
 
 /* C++ standard library headers */
+#include <algorithm>
 #include <chrono>
 #include <fstream>
 #include <memory>
@@ -43,7 +44,7 @@ namespace bm_execution {
  @copydoc bm_execution::calculate()
 */
 std::map<std::string, std::vector<double>>
-calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings, cl::Device, cl::Context, cl::Program> const& config, HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, HOST_DATA_TYPE* c, HOST_DATA_TYPE* c_out,
+calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings, cl::Device, cl::Context, cl::Program> const& config, HOST_INPUT_DATA_TYPE* a, HOST_INPUT_DATA_TYPE* b, HOST_DATA_TYPE* c, HOST_DATA_TYPE* c_out,
         HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta) {
 
     int err;
@@ -55,55 +56,69 @@ calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings, cl::Device, cl
         ASSERT_CL(err)
     }
 
-    cl_int size_in_blocks = config.programSettings->matrixSize / config.programSettings->blockSize;
-    size_t number_blocks_per_kernel = ((size_in_blocks + config.programSettings->kernelReplications - 1)/(config.programSettings->kernelReplications));
-    size_t out_buffer_size = config.programSettings->matrixSize * 
+    // The matrices are stored with sizes padded to a multiple of the block size
+    uint m_size = config.programSettings->getPaddedSize(config.programSettings->getM());
+    uint n_size = config.programSettings->getPaddedSize(config.programSettings->getN());
+    uint k_size = config.programSettings->getPaddedSize(config.programSettings->getK());
+    size_t a_elements = static_cast<size_t>(m_size) * k_size;
+    size_t b_elements = static_cast<size_t>(k_size) * n_size;
+    size_t c_elements = static_cast<size_t>(m_size) * n_size;
+    cl_int m_blocks = m_size / config.programSettings->blockSize;
+    cl_int n_blocks = n_size / config.programSettings->blockSize;
+    cl_int k_blocks = k_size / config.programSettings->blockSize;
+    size_t number_blocks_per_kernel = ((m_blocks + config.programSettings->kernelReplications - 1)/(config.programSettings->kernelReplications));
+    size_t out_buffer_size = n_size * 
                                 (number_blocks_per_kernel) * config.programSettings->blockSize;
 
-    std::vector<cl::Buffer> a_buffers;
-    std::vector<cl::Buffer> b_buffers;
-    std::vector<cl::Buffer> c_buffers;
-    std::vector<cl::Buffer> out_buffers;
-
-    // Create an output buffer for every kernel to still allow restrict optimizations
-    // For the other buffers this is not necessary, since they are read only
-    for (int i=0; i < config.programSettings->kernelReplications; i++) {
-        // Array of flags for each buffer that is allocated in this benchmark
+    // Allocate the buffers given by the memory plan.
+    // The result buffers of the kernel replications may be sub-buffers of a single allocation
+    gemm::GEMMMemoryPlan plan = planMemory(config);
+    std::vector<cl::Buffer> allocations;
+    for (size_t k = 0; k < plan.allocationBytes.size(); k++) {
         // The content of the flags will be changed according to the used compiler flags
         // to support different kinds of devices
-        int memory_bank_info[4] = {0};
+        int memory_bank_info = 0;
 #ifdef INTEL_FPGA
 #ifdef USE_HBM
         // For Intel HBM the buffers have to be created with a special flag
-        for (int& v : memory_bank_info) {
-                    v = CL_MEM_HETEROGENEOUS_INTELFPGA;
-        }
+        memory_bank_info = CL_MEM_HETEROGENEOUS_INTELFPGA;
 #else
         // Set the memory bank bits if memory interleaving is not used
         // Three bits are used to represent the target memory bank for the buffer on the FPGA by using the values 1-7.
         // This does also mean, that only up to 7 memory banks can be accessed with this functionality.
         // For boards with HBM, the selection of memory banks is done in the kernel code.
-        if (!config.programSettings->useMemoryInterleaving) {
-                for (int k = 0; k < 4; k++) {
-                    memory_bank_info[k] = ((1 + k) << 16);
-                }
-        }
+        memory_bank_info = (plan.allocationBanks[k] << 16);
 #endif
 #endif
-        if (i == 0 || config.programSettings->replicateInputBuffers) {
-            a_buffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[0],
-                                sizeof(HOST_DATA_TYPE) *config.programSettings->matrixSize*config.programSettings->matrixSize, NULL, &err));
-            ASSERT_CL(err)
-            b_buffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[1],
-                                sizeof(HOST_DATA_TYPE) *config.programSettings->matrixSize*config.programSettings->matrixSize, NULL, &err));
-            ASSERT_CL(err)
-            c_buffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[2],
-                                sizeof(HOST_DATA_TYPE) *config.programSettings->matrixSize*config.programSettings->matrixSize, NULL, &err));
-            ASSERT_CL(err)
+        allocations.push_back(cl::Buffer(*config.context, CL_MEM_READ_WRITE | memory_bank_info,
+                                plan.allocationBytes[k], NULL, &err));
+        ASSERT_CL(err)
+    }
+
+    // Create a buffer for a location of the plan. If the location covers the whole allocation, it is used directly
+    auto create_buffer = [&](gemm::GEMMBufferLocation const& location, cl_mem_flags flags) -> cl::Buffer {
+        cl::Buffer& allocation = allocations[location.allocation];
+        if (location.offset == 0 && location.bytes == plan.allocationBytes[location.allocation]) {
+            return allocation;
         }
-        out_buffers.push_back(cl::Buffer(*config.context, CL_MEM_WRITE_ONLY | memory_bank_info[3],
-                                    sizeof(HOST_DATA_TYPE) * out_buffer_size, NULL, &err));
+        cl_buffer_region region = {location.offset, location.bytes};
+        cl::Buffer sub_buffer = allocation.createSubBuffer(flags, CL_BUFFER_CREATE_TYPE_REGION, &region, &err);
         ASSERT_CL(err)
+        return sub_buffer;
+    };
+
+    std::vector<cl::Buffer> a_buffers;
+    std::vector<cl::Buffer> b_buffers;
+    std::vector<cl::Buffer> c_buffers;
+    std::vector<cl::Buffer> out_buffers;
+
+    // Every kernel writes to its own part of the result to still allow restrict optimizations
+    // The input buffers may be shared, since they are read only
+    for (int i=0; i < config.programSettings->kernelReplications; i++) {
+        a_buffers.push_back(create_buffer(plan.a[i], CL_MEM_READ_ONLY));
+        b_buffers.push_back(create_buffer(plan.b[i], CL_MEM_READ_ONLY));
+        c_buffers.push_back(create_buffer(plan.c[i], CL_MEM_READ_ONLY));
+        out_buffers.push_back(create_buffer(plan.out[i], CL_MEM_WRITE_ONLY));
     }
 
     std::vector<cl::Kernel> gemmkernels;
@@ -138,11 +153,11 @@ calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings, cl::Device, cl
                                         reinterpret_cast<void*>(&c_out[i * out_buffer_size]));
         ASSERT_CL(err)
     #else
-        err = gemmkernel.setArg(0, a_buffers[config.programSettings->replicateInputBuffers ? i : 0]);
+        err = gemmkernel.setArg(0, a_buffers[i]);
         ASSERT_CL(err);
-        err = gemmkernel.setArg(1, b_buffers[config.programSettings->replicateInputBuffers ? i : 0]);
+        err = gemmkernel.setArg(1, b_buffers[i]);
         ASSERT_CL(err);
-        err = gemmkernel.setArg(2, c_buffers[config.programSettings->replicateInputBuffers ? i : 0]);
+        err = gemmkernel.setArg(2, c_buffers[i]);
         ASSERT_CL(err);
         err = gemmkernel.setArg(3, out_buffers[i]);
         ASSERT_CL(err);
@@ -151,11 +166,15 @@ calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings, cl::Device, cl
         ASSERT_CL(err);
         err = gemmkernel.setArg(5, beta);
         ASSERT_CL(err);
-        err = gemmkernel.setArg(6, size_in_blocks);
+        err = gemmkernel.setArg(6, k_blocks);
         ASSERT_CL(err);
         err = gemmkernel.setArg(7, static_cast<cl_uint>(i * number_blocks_per_kernel));
         ASSERT_CL(err);
-        err = gemmkernel.setArg(8, static_cast<cl_uint>(std::min<cl_uint>(i * number_blocks_per_kernel + number_blocks_per_kernel, size_in_blocks)));
+        err = gemmkernel.setArg(8, static_cast<cl_uint>(std::min<cl_uint>(i * number_blocks_per_kernel + number_blocks_per_kernel, m_blocks)));
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(9, static_cast<cl_uint>(1));
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(10, n_blocks);
         ASSERT_CL(err);
 
         gemmkernels.push_back(gemmkernel);
@@ -170,43 +189,46 @@ calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings, cl::Device, cl
         err = clEnqueueSVMMap(compute_queues[0](), CL_TRUE,
                         CL_MAP_READ,
                         reinterpret_cast<void *>(a),
-                        sizeof(HOST_DATA_TYPE) *
-                        (config.programSettings->matrixSize * config.programSettings->matrixSize), 0,
+                        sizeof(HOST_INPUT_DATA_TYPE) * a_elements, 0,
                         NULL, NULL);
         ASSERT_CL(err)
         err = clEnqueueSVMMap(compute_queues[0](), CL_TRUE,
                         CL_MAP_READ,
                         reinterpret_cast<void *>(b),
-                        sizeof(HOST_DATA_TYPE) *
-                        (config.programSettings->matrixSize * config.programSettings->matrixSize), 0,
+                        sizeof(HOST_INPUT_DATA_TYPE) * b_elements, 0,
                         NULL, NULL);
         ASSERT_CL(err)
         err = clEnqueueSVMMap(compute_queues[0](), CL_TRUE,
                         CL_MAP_READ,
                         reinterpret_cast<void *>(c),
-                        sizeof(HOST_DATA_TYPE) *
-                        (config.programSettings->matrixSize * config.programSettings->matrixSize), 0,
+                        sizeof(HOST_DATA_TYPE) * c_elements, 0,
                         NULL, NULL);
         ASSERT_CL(err)
         err = clEnqueueSVMMap(compute_queues[0](), CL_TRUE,
                         CL_MAP_WRITE,
                         reinterpret_cast<void *>(c_out),
-                        sizeof(HOST_DATA_TYPE) *
-                        (config.programSettings->matrixSize * config.programSettings->matrixSize), 0,
+                        sizeof(HOST_DATA_TYPE) * c_elements, 0,
                         NULL, NULL);
         ASSERT_CL(err)
 #else
 
-        for (int i=0; i < (config.programSettings->replicateInputBuffers ? config.programSettings->kernelReplications : 1); i++) {
-            err = compute_queues[i].enqueueWriteBuffer(a_buffers[i], CL_TRUE, 0,
-                                        sizeof(HOST_DATA_TYPE)*config.programSettings->matrixSize*config.programSettings->matrixSize, a);
-            ASSERT_CL(err)
-            err = compute_queues[i].enqueueWriteBuffer(b_buffers[i], CL_TRUE, 0,
-                                        sizeof(HOST_DATA_TYPE)*config.programSettings->matrixSize*config.programSettings->matrixSize, b);
-            ASSERT_CL(err)
-            err = compute_queues[i].enqueueWriteBuffer(c_buffers[i], CL_TRUE, 0,
-                                        sizeof(HOST_DATA_TYPE)*config.programSettings->matrixSize*config.programSettings->matrixSize, c);
-            ASSERT_CL(err)
+        // Only write the inputs once for every location, since kernel replications may share the buffers
+        for (int i=0; i < config.programSettings->kernelReplications; i++) {
+            if (i == 0 || !(plan.a[i] == plan.a[0])) {
+                err = compute_queues[i].enqueueWriteBuffer(a_buffers[i], CL_TRUE, 0,
+                                            sizeof(HOST_INPUT_DATA_TYPE) * a_elements, a);
+                ASSERT_CL(err)
+            }
+            if (i == 0 || !(plan.b[i] == plan.b[0])) {
+                err = compute_queues[i].enqueueWriteBuffer(b_buffers[i], CL_TRUE, 0,
+                                            sizeof(HOST_INPUT_DATA_TYPE) * b_elements, b);
+                ASSERT_CL(err)
+            }
+            if (i == 0 || !(plan.c[i] == plan.c[0])) {
+                err = compute_queues[i].enqueueWriteBuffer(c_buffers[i], CL_TRUE, 0,
+                                            sizeof(HOST_DATA_TYPE) * c_elements, c);
+                ASSERT_CL(err)
+            }
         }
         for (int i=0; i < config.programSettings->kernelReplications; i++) {
             compute_queues[i].finish();
@@ -245,7 +267,7 @@ calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings, cl::Device, cl
 #else
         // The last buffer might only contain a little bit less data 
     for (int i=0; i < config.programSettings->kernelReplications; i++) {
-        long max_bytes_to_read = (static_cast<long>(sizeof(HOST_DATA_TYPE)*config.programSettings->matrixSize*config.programSettings->matrixSize))
+        long max_bytes_to_read = (static_cast<long>(sizeof(HOST_DATA_TYPE) * c_elements))
                                             - i * sizeof(HOST_DATA_TYPE) *  out_buffer_size;
         long bytes_to_read = std::min(max_bytes_to_read, static_cast<long>(sizeof(HOST_DATA_TYPE) * out_buffer_size));
         if (bytes_to_read > 0) {
@@ -263,4 +285,28 @@ calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings, cl::Device, cl
     return timings;
 }
 
+/*
+ Calculate the placement of the device buffers
+
+ @copydoc bm_execution::planMemory()
+*/
+gemm::GEMMMemoryPlan
+planMemory(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings, cl::Device, cl::Context, cl::Program> const& config) {
+    gemm::GEMMPlacement placement = gemm::GEMMPlacement::interleaved;
+#if defined(XILINX_FPGA) || defined(USE_HBM)
+    // The memory banks are given by the kernel attributes or the linker and may differ between the buffers
+    placement = gemm::GEMMPlacement::kernel;
+#elif defined(INTEL_FPGA)
+    if (!config.programSettings->useMemoryInterleaving) {
+        placement = gemm::GEMMPlacement::banks;
+    }
+#endif
+    // The alignment is given in bits
+    size_t alignment = std::max<size_t>(config.device->getInfo<CL_DEVICE_MEM_BASE_ADDR_ALIGN>() / 8, 1);
+    auto const& settings = *config.programSettings;
+    return gemm::planDeviceMemory(settings.getPaddedSize(settings.getM()), settings.getPaddedSize(settings.getN()),
+                                    settings.getPaddedSize(settings.getK()), settings.blockSize, settings.kernelReplications,
+                                    settings.replicateInputBuffers, placement, alignment);
+}
+
 }  // namespace bm_execution
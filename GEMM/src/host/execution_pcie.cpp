@@ -0,0 +1,261 @@
+/*
+Copyright (c) 2023 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* Related header files */
+#include "execution.h"
+
+/* C++ standard library headers */
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <vector>
+
+/* External library headers */
+#include "mpi.h"
+#ifdef INTEL_FPGA
+#include "CL/cl_ext_intelfpga.h"
+#endif
+
+
+namespace bm_execution {
+namespace pcie {
+
+/*
+ Prepare kernels and execute the distributed benchmark
+
+ @copydoc bm_execution::pcie::calculate()
+*/
+std::map<std::string, std::vector<double>>
+calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings, cl::Device, cl::Context, cl::Program> const& config, HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, HOST_DATA_TYPE* c, HOST_DATA_TYPE* c_out,
+        HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta) {
+
+    int err;
+
+    int steps = config.programSettings->torus_width;
+    uint local_size = config.programSettings->getLocalMatrixSize();
+    size_t tile_size = static_cast<size_t>(local_size) * local_size;
+    cl_int size_in_blocks = local_size / config.programSettings->blockSize;
+    size_t number_blocks_per_kernel = ((size_in_blocks + config.programSettings->kernelReplications - 1)/(config.programSettings->kernelReplications));
+    size_t out_buffer_size = static_cast<size_t>(local_size) * number_blocks_per_kernel * config.programSettings->blockSize;
+
+    MPI_Comm row_communicator;
+    MPI_Comm_split(MPI_COMM_WORLD, config.programSettings->torus_row, 0, &row_communicator);
+    MPI_Comm col_communicator;
+    MPI_Comm_split(MPI_COMM_WORLD, config.programSettings->torus_col, 0, &col_communicator);
+
+    // Create Command queues. The transfer queue is used to load the tiles of the next step during the calculation.
+    // Profiling is used to measure the calculation time of the kernels independent of the communication
+    std::vector<cl::CommandQueue> compute_queues;
+    for (int i=0; i < config.programSettings->kernelReplications; i++) {
+        compute_queues.push_back(cl::CommandQueue(*config.context, *config.device, CL_QUEUE_PROFILING_ENABLE, &err));
+        ASSERT_CL(err)
+    }
+    cl::CommandQueue transfer_queue(*config.context, *config.device, 0, &err);
+    ASSERT_CL(err)
+
+    int memory_bank_info[4] = {0};
+#ifdef INTEL_FPGA
+#ifdef USE_HBM
+    // For Intel HBM the buffers have to be created with a special flag
+    for (int& v : memory_bank_info) {
+                v = CL_MEM_HETEROGENEOUS_INTELFPGA;
+    }
+#else
+    // Set the memory bank bits if memory interleaving is not used
+    if (!config.programSettings->useMemoryInterleaving) {
+            for (int k = 0; k < 4; k++) {
+                memory_bank_info[k] = ((1 + k) << 16);
+            }
+    }
+#endif
+#endif
+
+    // Two buffers for the tiles of A and B, so the tiles for the next step can be transferred during the calculation.
+    // The partial results are accumulated by alternating between two buffers for C
+    std::vector<cl::Buffer> a_buffers;
+    std::vector<cl::Buffer> b_buffers;
+    std::vector<cl::Buffer> c_buffers;
+    // Sub-buffers of the C buffers that are used as output by the single kernel replications
+    std::vector<std::vector<cl::Buffer>> out_buffers(2);
+    for (int i = 0; i < 2; i++) {
+        a_buffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[0],
+                            sizeof(HOST_DATA_TYPE) * tile_size, NULL, &err));
+        ASSERT_CL(err)
+        b_buffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[1],
+                            sizeof(HOST_DATA_TYPE) * tile_size, NULL, &err));
+        ASSERT_CL(err)
+        c_buffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_WRITE | memory_bank_info[2 + i],
+                            sizeof(HOST_DATA_TYPE) * tile_size, NULL, &err));
+        ASSERT_CL(err)
+        for (int r = 0; r < config.programSettings->kernelReplications; r++) {
+            size_t offset = r * out_buffer_size;
+            if (offset >= tile_size) {
+                break;
+            }
+            cl_buffer_region region = {sizeof(HOST_DATA_TYPE) * offset,
+                                        sizeof(HOST_DATA_TYPE) * std::min(out_buffer_size, tile_size - offset)};
+            out_buffers[i].push_back(c_buffers[i].createSubBuffer(CL_MEM_READ_WRITE, CL_BUFFER_CREATE_TYPE_REGION, &region, &err));
+            ASSERT_CL(err)
+        }
+    }
+
+    std::vector<cl::Kernel> gemmkernels;
+    for (int i=0; i < out_buffers[0].size(); i++) {
+#ifdef INTEL_FPGA
+        // create the kernels
+        cl::Kernel gemmkernel(*config.program, (KERNEL_NAME + std::to_string(i)).c_str(),
+                                        &err);
+        ASSERT_CL(err);
+#endif
+#ifdef XILINX_FPGA
+        // create the kernels
+        cl::Kernel gemmkernel(*config.program, (std::string(KERNEL_NAME) + "0:{" + KERNEL_NAME + "0_" +  std::to_string(i + 1) + "}").c_str(),
+                                        &err);
+        ASSERT_CL(err);
+#endif
+        err = gemmkernel.setArg(4, alpha);
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(6, size_in_blocks);
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(7, static_cast<cl_uint>(i * number_blocks_per_kernel));
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(8, static_cast<cl_uint>(std::min<cl_uint>(i * number_blocks_per_kernel + number_blocks_per_kernel, size_in_blocks)));
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(9, static_cast<cl_uint>(1));
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(10, size_in_blocks);
+        ASSERT_CL(err);
+        gemmkernels.push_back(gemmkernel);
+    }
+
+    // Host buffers for the received tiles of the current and the next step
+    std::vector<std::vector<HOST_DATA_TYPE>> a_tiles(2, std::vector<HOST_DATA_TYPE>(tile_size));
+    std::vector<std::vector<HOST_DATA_TYPE>> b_tiles(2, std::vector<HOST_DATA_TYPE>(tile_size));
+    size_t tile_bytes = sizeof(HOST_DATA_TYPE) * tile_size;
+    // MPI only supports int as count for the broadcast of the tiles
+    if (tile_bytes > static_cast<size_t>(std::numeric_limits<int>::max())) {
+        throw std::runtime_error("The local tiles are too large to be broadcasted with MPI: " + std::to_string(tile_bytes) + " bytes");
+    }
+    HOST_DATA_TYPE one = OPTIONAL_CAST(1.0);
+
+    // Start the broadcast of the tiles for the given step
+    auto start_broadcast = [&](int step, MPI_Request* requests) {
+        if (config.programSettings->torus_col == step) {
+            std::copy(a, a + tile_size, a_tiles[step % 2].begin());
+        }
+        if (config.programSettings->torus_row == step) {
+            std::copy(b, b + tile_size, b_tiles[step % 2].begin());
+        }
+        MPI_Ibcast(a_tiles[step % 2].data(), static_cast<int>(tile_bytes), MPI_BYTE, step, row_communicator, &requests[0]);
+        MPI_Ibcast(b_tiles[step % 2].data(), static_cast<int>(tile_bytes), MPI_BYTE, step, col_communicator, &requests[1]);
+    };
+
+    /* --- Execute actual benchmark kernels --- */
+
+    std::vector<double> executionTimes;
+    std::vector<double> communicationTimes;
+    std::vector<double> calculationTimes;
+    for (int repetition = 0; repetition < config.programSettings->numRepetitions; repetition++) {
+        err = transfer_queue.enqueueWriteBuffer(c_buffers[0], CL_TRUE, 0, tile_bytes, c);
+        ASSERT_CL(err)
+
+        MPI_Barrier(MPI_COMM_WORLD);
+
+        double calculation_time = 0.0;
+        auto t1 = std::chrono::high_resolution_clock::now();
+
+        MPI_Request requests[2];
+        start_broadcast(0, requests);
+        MPI_Waitall(2, requests, MPI_STATUSES_IGNORE);
+        err = transfer_queue.enqueueWriteBuffer(a_buffers[0], CL_FALSE, 0, tile_bytes, a_tiles[0].data());
+        ASSERT_CL(err)
+        err = transfer_queue.enqueueWriteBuffer(b_buffers[0], CL_FALSE, 0, tile_bytes, b_tiles[0].data());
+        ASSERT_CL(err)
+        transfer_queue.finish();
+
+        for (int step = 0; step < steps; step++) {
+            // Calculate the partial result for the current step
+            std::vector<cl::Event> kernel_events(gemmkernels.size());
+            for (int i = 0; i < gemmkernels.size(); i++) {
+                err = gemmkernels[i].setArg(0, a_buffers[step % 2]);
+                ASSERT_CL(err);
+                err = gemmkernels[i].setArg(1, b_buffers[step % 2]);
+                ASSERT_CL(err);
+                err = gemmkernels[i].setArg(2, c_buffers[step % 2]);
+                ASSERT_CL(err);
+                err = gemmkernels[i].setArg(3, out_buffers[(step + 1) % 2][i]);
+                ASSERT_CL(err);
+                // C is only scaled with beta in the first step, afterwards the partial results are accumulated
+                err = gemmkernels[i].setArg(5, (step == 0) ? beta : one);
+                ASSERT_CL(err);
+                err = compute_queues[i].enqueueNDRangeKernel(gemmkernels[i], cl::NullRange, cl::NDRange(1), cl::NullRange, nullptr, &kernel_events[i]);
+                ASSERT_CL(err);
+                compute_queues[i].flush();
+            }
+            // Broadcast and transfer the tiles of the next step while the kernels are running
+            if (step + 1 < steps) {
+                start_broadcast(step + 1, requests);
+                MPI_Waitall(2, requests, MPI_STATUSES_IGNORE);
+                err = transfer_queue.enqueueWriteBuffer(a_buffers[(step + 1) % 2], CL_FALSE, 0, tile_bytes, a_tiles[(step + 1) % 2].data());
+                ASSERT_CL(err)
+                err = transfer_queue.enqueueWriteBuffer(b_buffers[(step + 1) % 2], CL_FALSE, 0, tile_bytes, b_tiles[(step + 1) % 2].data());
+                ASSERT_CL(err)
+            }
+            for (int i = 0; i < gemmkernels.size(); i++) {
+                compute_queues[i].finish();
+            }
+            transfer_queue.finish();
+            cl_ulong first_start = std::numeric_limits<cl_ulong>::max();
+            cl_ulong last_end = 0;
+            for (auto& e : kernel_events) {
+                first_start = std::min(first_start, e.getProfilingInfo<CL_PROFILING_COMMAND_START>());
+                last_end = std::max(last_end, e.getProfilingInfo<CL_PROFILING_COMMAND_END>());
+            }
+            calculation_time += static_cast<double>(last_end - first_start) * 1.0e-9;
+        }
+
+        auto t2 = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> timespan = t2 - t1;
+        executionTimes.push_back(timespan.count());
+        // Only the part of the communication that is not hidden by the calculation is counted as communication time
+        communicationTimes.push_back(timespan.count() - calculation_time);
+        calculationTimes.push_back(calculation_time);
+    }
+
+    /* --- Read back results from Device --- */
+    err = transfer_queue.enqueueReadBuffer(c_buffers[steps % 2], CL_TRUE, 0, tile_bytes, c_out);
+    ASSERT_CL(err)
+
+    MPI_Comm_free(&row_communicator);
+    MPI_Comm_free(&col_communicator);
+
+    std::map<std::string, std::vector<double>> timings;
+
+    timings["execution"] = executionTimes;
+    timings["communication"] = communicationTimes;
+    timings["calculation"] = calculationTimes;
+    return timings;
+}
+
+}  // namespace pcie
+}  // namespace bm_execution
@@ -0,0 +1,270 @@
+/*
+Copyright (c) 2023 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* Related header files */
+#include "execution.h"
+
+/* C++ standard library headers */
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <vector>
+
+/* External library headers */
+#ifdef INTEL_FPGA
+#include "CL/cl_ext_intelfpga.h"
+#endif
+
+
+namespace bm_execution {
+namespace streaming {
+
+/*
+ Prepare kernels and execute the benchmark with matrices that are streamed to the device in super-tiles
+
+ @copydoc bm_execution::streaming::calculate()
+*/
+std::map<std::string, std::vector<double>>
+calculate(hpcc_base::ExecutionSettings<gemm::GEMMProgramSettings, cl::Device, cl::Context, cl::Program> const& config, HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, HOST_DATA_TYPE* c, HOST_DATA_TYPE* c_out,
+        HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta) {
+
+    int err;
+
+    size_t matrix_size = config.programSettings->matrixSize;
+    size_t tile_width = static_cast<size_t>(config.programSettings->streamTileSize) * config.programSettings->blockSize;
+    size_t tile_size = tile_width * tile_width;
+    size_t tile_bytes = sizeof(HOST_DATA_TYPE) * tile_size;
+    int tiles_per_dim = matrix_size / tile_width;
+    cl_int size_in_blocks = config.programSettings->streamTileSize;
+    size_t number_blocks_per_kernel = ((size_in_blocks + config.programSettings->kernelReplications - 1)/(config.programSettings->kernelReplications));
+    size_t out_buffer_size = tile_width * number_blocks_per_kernel * config.programSettings->blockSize;
+
+    // Create Command queues. The write queue is used to load the tiles of the next step and the read queue to write back
+    // finished tiles of C during the calculation, so both directions of the transfers can overlap with each other.
+    // Profiling is used to measure the calculation time of the kernels independent of the transfers
+    std::vector<cl::CommandQueue> compute_queues;
+    for (int i=0; i < config.programSettings->kernelReplications; i++) {
+        compute_queues.push_back(cl::CommandQueue(*config.context, *config.device, CL_QUEUE_PROFILING_ENABLE, &err));
+        ASSERT_CL(err)
+    }
+    cl::CommandQueue write_queue(*config.context, *config.device, 0, &err);
+    ASSERT_CL(err)
+    cl::CommandQueue read_queue(*config.context, *config.device, 0, &err);
+    ASSERT_CL(err)
+
+    int memory_bank_info[4] = {0};
+#ifdef INTEL_FPGA
+#ifdef USE_HBM
+    // For Intel HBM the buffers have to be created with a special flag
+    for (int& v : memory_bank_info) {
+                v = CL_MEM_HETEROGENEOUS_INTELFPGA;
+    }
+#else
+    // Set the memory bank bits if memory interleaving is not used
+    if (!config.programSettings->useMemoryInterleaving) {
+            for (int k = 0; k < 4; k++) {
+                memory_bank_info[k] = ((1 + k) << 16);
+            }
+    }
+#endif
+#endif
+
+    // Two buffers for every input tile, so the tiles of the next step can be transferred during the calculation.
+    // The partial results of a tile of C are accumulated over the tiles of K by alternating between two buffers.
+    // Only these eight tiles have to fit into the device memory, independent of the matrix size.
+    std::vector<cl::Buffer> a_buffers;
+    std::vector<cl::Buffer> b_buffers;
+    std::vector<cl::Buffer> c_buffers;
+    std::vector<cl::Buffer> acc_buffers;
+    // Sub-buffers of the accumulation buffers that are used as output by the single kernel replications
+    std::vector<std::vector<cl::Buffer>> out_buffers(2);
+    for (int i = 0; i < 2; i++) {
+        a_buffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[0],
+                            tile_bytes, NULL, &err));
+        ASSERT_CL(err)
+        b_buffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[1],
+                            tile_bytes, NULL, &err));
+        ASSERT_CL(err)
+        c_buffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_ONLY | memory_bank_info[2],
+                            tile_bytes, NULL, &err));
+        ASSERT_CL(err)
+        acc_buffers.push_back(cl::Buffer(*config.context, CL_MEM_READ_WRITE | memory_bank_info[3],
+                            tile_bytes, NULL, &err));
+        ASSERT_CL(err)
+        for (int r = 0; r < config.programSettings->kernelReplications; r++) {
+            size_t offset = r * out_buffer_size;
+            if (offset >= tile_size) {
+                break;
+            }
+            cl_buffer_region region = {sizeof(HOST_DATA_TYPE) * offset,
+                                        sizeof(HOST_DATA_TYPE) * std::min(out_buffer_size, tile_size - offset)};
+            out_buffers[i].push_back(acc_buffers[i].createSubBuffer(CL_MEM_READ_WRITE, CL_BUFFER_CREATE_TYPE_REGION, &region, &err));
+            ASSERT_CL(err)
+        }
+    }
+
+    std::vector<cl::Kernel> gemmkernels;
+    for (int i=0; i < out_buffers[0].size(); i++) {
+#ifdef INTEL_FPGA
+        // create the kernels
+        cl::Kernel gemmkernel(*config.program, (KERNEL_NAME + std::to_string(i)).c_str(),
+                                        &err);
+        ASSERT_CL(err);
+#endif
+#ifdef XILINX_FPGA
+        // create the kernels
+        cl::Kernel gemmkernel(*config.program, (std::string(KERNEL_NAME) + "0:{" + KERNEL_NAME + "0_" +  std::to_string(i + 1) + "}").c_str(),
+                                        &err);
+        ASSERT_CL(err);
+#endif
+        err = gemmkernel.setArg(4, alpha);
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(6, size_in_blocks);
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(7, static_cast<cl_uint>(i * number_blocks_per_kernel));
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(8, static_cast<cl_uint>(std::min<cl_uint>(i * number_blocks_per_kernel + number_blocks_per_kernel, size_in_blocks)));
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(9, static_cast<cl_uint>(1));
+        ASSERT_CL(err);
+        err = gemmkernel.setArg(10, size_in_blocks);
+        ASSERT_CL(err);
+        gemmkernels.push_back(gemmkernel);
+    }
+
+    // Copy a tile between the host matrix and a device buffer without an additional copy on the host.
+    // The tiles are strided in the host matrix and stored contiguously on the device
+    auto transfer_tile = [&](cl::Buffer& buffer, HOST_DATA_TYPE* matrix, int tile_row, int tile_col, bool write) {
+        size_t buffer_origin[3] = {0, 0, 0};
+        size_t host_origin[3] = {sizeof(HOST_DATA_TYPE) * tile_col * tile_width, tile_row * tile_width, 0};
+        size_t region[3] = {sizeof(HOST_DATA_TYPE) * tile_width, tile_width, 1};
+        if (write) {
+            err = clEnqueueWriteBufferRect(write_queue(), buffer(), CL_FALSE, buffer_origin, host_origin, region,
+                                        sizeof(HOST_DATA_TYPE) * tile_width, 0, sizeof(HOST_DATA_TYPE) * matrix_size, 0,
+                                        matrix, 0, NULL, NULL);
+        }
+        else {
+            err = clEnqueueReadBufferRect(read_queue(), buffer(), CL_FALSE, buffer_origin, host_origin, region,
+                                        sizeof(HOST_DATA_TYPE) * tile_width, 0, sizeof(HOST_DATA_TYPE) * matrix_size, 0,
+                                        matrix, 0, NULL, NULL);
+        }
+        ASSERT_CL(err)
+        // Start the transfer immediately, so it overlaps with the running kernels
+        err = write ? write_queue.flush() : read_queue.flush();
+        ASSERT_CL(err)
+    };
+
+    // Every step calculates the product of a tile of A and a tile of B for a single tile of C.
+    // The tiles of C are calculated row by row and for every tile of C all tiles of K are accumulated
+    int total_steps = tiles_per_dim * tiles_per_dim * tiles_per_dim;
+    auto load_inputs = [&](int step) {
+        int tile = step / tiles_per_dim;
+        int k = step % tiles_per_dim;
+        int tile_row = tile / tiles_per_dim;
+        int tile_col = tile % tiles_per_dim;
+        transfer_tile(a_buffers[step % 2], a, tile_row, k, true);
+        transfer_tile(b_buffers[step % 2], b, k, tile_col, true);
+        if (k == 0) {
+            transfer_tile(c_buffers[tile % 2], c, tile_row, tile_col, true);
+        }
+    };
+    HOST_DATA_TYPE one = OPTIONAL_CAST(1.0);
+
+    /* --- Execute actual benchmark kernels --- */
+
+    std::vector<double> executionTimes;
+    std::vector<double> transferTimes;
+    std::vector<double> calculationTimes;
+    for (int repetition = 0; repetition < config.programSettings->numRepetitions; repetition++) {
+        double calculation_time = 0.0;
+        auto t1 = std::chrono::high_resolution_clock::now();
+
+        load_inputs(0);
+        write_queue.finish();
+
+        for (int step = 0; step < total_steps; step++) {
+            int tile = step / tiles_per_dim;
+            int k = step % tiles_per_dim;
+            // Calculate the partial result for the current step
+            std::vector<cl::Event> kernel_events(gemmkernels.size());
+            for (int i = 0; i < gemmkernels.size(); i++) {
+                err = gemmkernels[i].setArg(0, a_buffers[step % 2]);
+                ASSERT_CL(err);
+                err = gemmkernels[i].setArg(1, b_buffers[step % 2]);
+                ASSERT_CL(err);
+                // C is only scaled with beta for the first tile of K, afterwards the partial results are accumulated
+                err = gemmkernels[i].setArg(2, (k == 0) ? c_buffers[tile % 2] : acc_buffers[(step + 1) % 2]);
+                ASSERT_CL(err);
+                err = gemmkernels[i].setArg(3, out_buffers[step % 2][i]);
+                ASSERT_CL(err);
+                err = gemmkernels[i].setArg(5, (k == 0) ? beta : one);
+                ASSERT_CL(err);
+                err = compute_queues[i].enqueueNDRangeKernel(gemmkernels[i], cl::NullRange, cl::NDRange(1), cl::NullRange, nullptr, &kernel_events[i]);
+                ASSERT_CL(err);
+                compute_queues[i].flush();
+            }
+            // Write back the finished tile of C of the previous step while the kernels are running
+            if (k == 0 && step > 0) {
+                transfer_tile(acc_buffers[(step + 1) % 2], c_out, (tile - 1) / tiles_per_dim, (tile - 1) % tiles_per_dim, false);
+            }
+            // Transfer the tiles of the next step while the kernels are running
+            if (step + 1 < total_steps) {
+                load_inputs(step + 1);
+            }
+            for (int i = 0; i < gemmkernels.size(); i++) {
+                compute_queues[i].finish();
+            }
+            write_queue.finish();
+            read_queue.finish();
+            cl_ulong first_start = std::numeric_limits<cl_ulong>::max();
+            cl_ulong last_end = 0;
+            for (auto& e : kernel_events) {
+                first_start = std::min(first_start, e.getProfilingInfo<CL_PROFILING_COMMAND_START>());
+                last_end = std::max(last_end, e.getProfilingInfo<CL_PROFILING_COMMAND_END>());
+            }
+            calculation_time += static_cast<double>(last_end - first_start) * 1.0e-9;
+        }
+
+        // Write back the last tile of C
+        int last_tile = tiles_per_dim * tiles_per_dim - 1;
+        transfer_tile(acc_buffers[(total_steps - 1) % 2], c_out, last_tile / tiles_per_dim, last_tile % tiles_per_dim, false);
+        read_queue.finish();
+
+        auto t2 = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> timespan = t2 - t1;
+        executionTimes.push_back(timespan.count());
+        // Only the part of the transfers that is not hidden by the calculation is counted as transfer time
+        transferTimes.push_back(timespan.count() - calculation_time);
+        calculationTimes.push_back(calculation_time);
+    }
+
+    std::map<std::string, std::vector<double>> timings;
+
+    timings["execution"] = executionTimes;
+    timings["transfer"] = transferTimes;
+    timings["calculation"] = calculationTimes;
+    return timings;
+}
+
+}  // namespace streaming
+}  // namespace bm_execution
@@ -27,47 +27,196 @@ SOFTWARE.
 #include "gemm_benchmark.hpp"
 
 /* C++ standard library headers */
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <limits>
 #include <memory>
 #include <random>
+#include <string>
+#include <vector>
 
 /* Project's headers */
 #include "execution.h"
 #include "parameters.h"
 
+namespace {
+
+/**
+Generate the values of the global square matrices A, B and C. All ranks and the validation generate the values
+in the same order, so the global matrices are independent of the number of ranks and the distribution.
+
+@param global_size The size of the global matrices in one dimension
+@param gen The random number generator that is used for the values
+@param store Called with the row, the column and the values of A, B and C for every element of the global matrices
+*/
+template<typename StoreFunction>
+void
+generateGlobalMatrixValues(uint global_size, std::mt19937& gen, StoreFunction store) {
+    std::uniform_real_distribution<> dis(-1.0, 1.0);
+    for (uint j = 0; j < global_size; j++) {
+        for (uint i = 0; i < global_size; i++) {
+            HOST_DATA_TYPE a_value = OPTIONAL_CAST(static_cast<double>(dis(gen)));
+            HOST_DATA_TYPE b_value = OPTIONAL_CAST(static_cast<double>(dis(gen)));
+            HOST_DATA_TYPE c_value = OPTIONAL_CAST(static_cast<double>(dis(gen)));
+            store(i, j, a_value, b_value, c_value);
+        }
+    }
+}
+
+}
+
 gemm::GEMMProgramSettings::GEMMProgramSettings(cxxopts::ParseResult &results) : hpcc_base::BaseSettings(results),
     matrixSize(results["b"].as<uint>() * results["m"].as<uint>()), blockSize(results["b"].as<uint>()),
-    replicateInputBuffers(results["replicate-inputs"].count() > 0) {
+    replicateInputBuffers(results["replicate-inputs"].count() > 0), torus_width(results["p"].as<uint>()),
+    validationVectors(results["validation-vectors"].as<uint>()), streamTileSize(results["stream-tile"].as<uint>()),
+    batchSize(results["batch"].as<uint>()) {
+    int mpi_comm_rank = 0;
+    int mpi_comm_size = 1;
+#ifdef _USE_MPI_
+    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_comm_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &mpi_comm_size);
+#endif
+    // calculate the row and column of the MPI rank in the torus.
+    // The torus is only used by the distributed GEMM, otherwise every rank calculates its own matrices
+    if (communicationType == hpcc_base::CommunicationType::pcie_mpi && mpi_comm_size % torus_width != 0) {
+        throw std::runtime_error("MPI size not dividable by P=" + std::to_string(torus_width) + "!");
+    } 
+    torus_height = mpi_comm_size / torus_width;
+    torus_row = (mpi_comm_rank / torus_width);
+    torus_col = (mpi_comm_rank % torus_width);
+
+    // Use square matrices of the given matrix size, if no custom shape is given
+    matrixM = 0;
+    matrixN = 0;
+    matrixK = 0;
+    std::string shape = results["shape"].as<std::string>();
+    if (!shape.empty()) {
+        parseMatrixShape(shape, matrixM, matrixN, matrixK);
+    }
+}
+
+void
+gemm::parseMatrixShape(std::string const& shape, uint& m, uint& n, uint& k) {
+    // Parse the dimensions as signed integers, so negative values are detected instead of wrapping around
+    auto parseDimension = [&shape](std::string const& value) {
+        size_t parsed_chars = 0;
+        long long dimension = 0;
+        if (!value.empty() && std::isdigit(static_cast<unsigned char>(value.front()))) {
+            try {
+                dimension = std::stoll(value, &parsed_chars);
+            } catch (std::exception const&) {
+                parsed_chars = 0;
+            }
+        }
+        else if (!value.empty() && value.front() == '-') {
+            throw std::runtime_error("Invalid matrix shape " + shape + ". All dimensions have to be larger than 0");
+        }
+        if (parsed_chars == 0 || parsed_chars != value.size() || dimension > std::numeric_limits<uint>::max()) {
+            throw std::runtime_error("Invalid matrix shape " + shape + ". Expected format: MxNxK");
+        }
+        if (dimension <= 0) {
+            throw std::runtime_error("Invalid matrix shape " + shape + ". All dimensions have to be larger than 0");
+        }
+        return static_cast<uint>(dimension);
+    };
+    size_t first_separator = shape.find('x');
+    size_t second_separator = (first_separator == std::string::npos) ? std::string::npos : shape.find('x', first_separator + 1);
+    if (second_separator == std::string::npos) {
+        throw std::runtime_error("Invalid matrix shape " + shape + ". Expected format: MxNxK");
+    }
+    m = parseDimension(shape.substr(0, first_separator));
+    n = parseDimension(shape.substr(first_separator + 1, second_separator - first_separator - 1));
+    k = parseDimension(shape.substr(second_separator + 1));
+}
+
+bool
+gemm::GEMMProgramSettings::isRectangular() const {
+    return matrixM > 0 || matrixN > 0 || matrixK > 0;
+}
+
+uint
+gemm::GEMMProgramSettings::getM() const {
+    return isRectangular() ? matrixM : matrixSize;
+}
+
+uint
+gemm::GEMMProgramSettings::getN() const {
+    return isRectangular() ? matrixN : matrixSize;
+}
+
+uint
+gemm::GEMMProgramSettings::getK() const {
+    return isRectangular() ? matrixK : matrixSize;
+}
+
+uint
+gemm::GEMMProgramSettings::getPaddedSize(uint size) const {
+    return (size + blockSize - 1) / blockSize * blockSize;
+}
+
+uint
+gemm::GEMMProgramSettings::getLocalMatrixSize() const {
+    if (communicationType == hpcc_base::CommunicationType::pcie_mpi) {
+        return matrixSize / torus_width;
+    }
+    return matrixSize;
+}
 
+uint
+gemm::GEMMProgramSettings::getMatrixCount() const {
+    return (batchSize > 0) ? batchSize : 1;
 }
 
 std::map<std::string, std::string>
 gemm::GEMMProgramSettings::getSettingsMap() {
         auto map = hpcc_base::BaseSettings::getSettingsMap();
-        map["Matrix Size"] = std::to_string(matrixSize);
+        if (isRectangular()) {
+            map["Matrix Shape"] = std::to_string(matrixM) + "x" + std::to_string(matrixN) + "x" + std::to_string(matrixK);
+        }
+        else {
+            map["Matrix Size"] = std::to_string(matrixSize);
+        }
         map["Block Size"] = std::to_string(blockSize);
         map["Replicate Inputs"] = replicateInputBuffers ? "Yes" : "No";
+#ifdef MIXED_PRECISION_INPUTS
+        map["Input Type"] = std::string(getInputPrecisionClass()) + " with FP32 accumulation";
+#endif
+        map["Validation"] = (validationVectors > 0) ? "Probabilistic with " + std::to_string(validationVectors) + " vectors" : "Full";
+        if (batchSize > 0) {
+            map["Batch Size"] = std::to_string(batchSize);
+        }
+        if (streamTileSize > 0) {
+            map["Stream Tile Size"] = std::to_string(streamTileSize * blockSize);
+        }
+        if (communicationType == hpcc_base::CommunicationType::pcie_mpi) {
+            map["FPGA Torus"] = "P=" + std::to_string(torus_width) +
+                                ", Q=" + std::to_string(torus_height);
+        }
         return map;
 }
 
-gemm::GEMMData::GEMMData(cl::Context context, uint size) : normtotal(0.0), alpha(0.5), beta(2.0), context(context) {
+gemm::GEMMData::GEMMData(cl::Context context, uint size, uint count) : GEMMData(context, size, size, size, count) {}
+
+gemm::GEMMData::GEMMData(cl::Context context, uint m, uint n, uint k, uint count) : normtotal(0.0), alpha(0.5), beta(2.0), context(context) {
 #ifdef USE_SVM
     A = reinterpret_cast<HOST_DATA_TYPE*>(
                         clSVMAlloc(context(), 0 ,
-                        size * size * sizeof(HOST_DATA_TYPE), 1024));
+                        static_cast<size_t>(count) * m * k * sizeof(HOST_DATA_TYPE), 1024));
     B = reinterpret_cast<HOST_DATA_TYPE*>(
                         clSVMAlloc(context(), 0 ,
-                        size * size * sizeof(HOST_DATA_TYPE), 1024));
+                        static_cast<size_t>(count) * k * n * sizeof(HOST_DATA_TYPE), 1024));
     C = reinterpret_cast<HOST_DATA_TYPE*>(
                         clSVMAlloc(context(), 0 ,
-                        size * size * sizeof(HOST_DATA_TYPE), 1024));
+                        static_cast<size_t>(count) * m * n * sizeof(HOST_DATA_TYPE), 1024));
     C_out = reinterpret_cast<HOST_DATA_TYPE*>(
                         clSVMAlloc(context(), 0 ,
-                        size * size * sizeof(HOST_DATA_TYPE), 1024));
+                        static_cast<size_t>(count) * m * n * sizeof(HOST_DATA_TYPE), 1024));
 #else
-    posix_memalign(reinterpret_cast<void**>(&A), 4096, size * size * sizeof(HOST_DATA_TYPE));
-    posix_memalign(reinterpret_cast<void**>(&B), 4096, size * size * sizeof(HOST_DATA_TYPE));
-    posix_memalign(reinterpret_cast<void**>(&C), 4096, size * size * sizeof(HOST_DATA_TYPE));
-    posix_memalign(reinterpret_cast<void**>(&C_out), 4096, size * size * sizeof(HOST_DATA_TYPE));
+    posix_memalign(reinterpret_cast<void**>(&A), 4096, static_cast<size_t>(count) * m * k * sizeof(HOST_DATA_TYPE));
+    posix_memalign(reinterpret_cast<void**>(&B), 4096, static_cast<size_t>(count) * k * n * sizeof(HOST_DATA_TYPE));
+    posix_memalign(reinterpret_cast<void**>(&C), 4096, static_cast<size_t>(count) * m * n * sizeof(HOST_DATA_TYPE));
+    posix_memalign(reinterpret_cast<void**>(&C_out), 4096, static_cast<size_t>(count) * m * n * sizeof(HOST_DATA_TYPE));
 #endif
 }
 
@@ -96,12 +245,55 @@ gemm::GEMMBenchmark::addAdditionalParseOptions(cxxopts::Options &options) {
              cxxopts::value<cl_uint>()->default_value(std::to_string(DEFAULT_MATRIX_SIZE)))
             ("b", "Block size in number of values in one dimension",
              cxxopts::value<cl_uint>()->default_value(std::to_string(BLOCK_SIZE)))
-            ("replicate-inputs", "Also replicates the input buffer for each kernel");
+            ("replicate-inputs", "Also replicates the input buffer for each kernel")
+            ("p", "Width of the FPGA grid for the distributed GEMM (PCIE only). The heigth (Q) will be calculated from mpi_size / P.",
+             cxxopts::value<uint>()->default_value(std::to_string(DEFAULT_P_VALUE)))
+            ("validation-vectors", "Number of random vectors used for the probabilistic validation of the result. If 0, the full reference GEMM is calculated on the host.",
+             cxxopts::value<uint>()->default_value(std::to_string(DEFAULT_VALIDATION_VECTORS)))
+            ("stream-tile", "Size of the super-tiles in number of blocks for the out-of-core execution. The matrices are streamed to the device tile by tile. If 0, the whole matrices are stored on the device.",
+             cxxopts::value<uint>()->default_value("0"))
+            ("shape", "Shape of the matrices given as MxNxK in number of values, where A has the size MxK, B KxN and C MxN. The matrices are padded to a multiple of the block size. If not given, square matrices of the given matrix size are used.",
+             cxxopts::value<std::string>()->default_value(""))
+            ("batch", "Number of independent matrices that are calculated in a batch. The matrices are distributed over the kernel replications. If 0, a single matrix is calculated.",
+             cxxopts::value<uint>()->default_value("0"));
 }
 
 void
 gemm::GEMMBenchmark::executeKernel(GEMMData &data) {
-    timings = bm_execution::calculate(*executionSettings, data.A, data.B, data.C, data.C_out, data.alpha, data.beta);
+    HOST_INPUT_DATA_TYPE* a = data.A;
+    HOST_INPUT_DATA_TYPE* b = data.B;
+#ifdef MIXED_PRECISION_INPUTS
+    // Convert the input matrices to the reduced precision format that is used on the device
+    auto settings = executionSettings->programSettings.get();
+    size_t a_elements = static_cast<size_t>(settings->getMatrixCount()) * settings->getPaddedSize(settings->getM())
+                            * settings->getPaddedSize(settings->getK());
+    size_t b_elements = static_cast<size_t>(settings->getMatrixCount()) * settings->getPaddedSize(settings->getK())
+                            * settings->getPaddedSize(settings->getN());
+    std::vector<HOST_INPUT_DATA_TYPE> a_input(a_elements);
+    std::vector<HOST_INPUT_DATA_TYPE> b_input(b_elements);
+    convertToInputType(data.A, a_input.data(), a_elements);
+    convertToInputType(data.B, b_input.data(), b_elements);
+    a = a_input.data();
+    b = b_input.data();
+#endif
+    switch (executionSettings->programSettings->communicationType) {
+#ifdef _USE_MPI_
+        case hpcc_base::CommunicationType::pcie_mpi:
+            timings = bm_execution::pcie::calculate(*executionSettings, data.A, data.B, data.C, data.C_out, data.alpha, data.beta); break;
+#endif
+        case hpcc_base::CommunicationType::unsupported:
+            if (executionSettings->programSettings->batchSize > 0) {
+                timings = bm_execution::batched::calculate(*executionSettings, a, b, data.C, data.C_out, data.alpha, data.beta);
+            }
+            else if (executionSettings->programSettings->streamTileSize > 0) {
+                timings = bm_execution::streaming::calculate(*executionSettings, data.A, data.B, data.C, data.C_out, data.alpha, data.beta);
+            }
+            else {
+                timings = bm_execution::calculate(*executionSettings, a, b, data.C, data.C_out, data.alpha, data.beta);
+            }
+            break;
+        default: throw std::runtime_error("No calculate method implemented for communication type " + commToString(executionSettings->programSettings->communicationType));
+    }
 }
 
 void
@@ -122,9 +314,13 @@ gemm::GEMMBenchmark::collectResults() {
         double tmean = 0;
         double tmin = std::numeric_limits<double>::max();
 
-        double gflops = mpi_comm_size * 2.0 * (static_cast<double>(executionSettings->programSettings->matrixSize)
-                            *static_cast<double>(executionSettings->programSettings->matrixSize)
-                            *static_cast<double>(executionSettings->programSettings->matrixSize))/1.0e9;
+        // The distributed GEMM calculates a single matrix over all ranks, otherwise every rank calculates its own matrix
+        bool is_distributed = executionSettings->programSettings->communicationType == hpcc_base::CommunicationType::pcie_mpi;
+        // The operations are counted for the actual shape of the matrices without padding
+        auto settings = executionSettings->programSettings.get();
+        double gflops = (is_distributed ? 1 : mpi_comm_size) * settings->getMatrixCount() * 2.0 * (static_cast<double>(settings->getM())
+                            *static_cast<double>(settings->getN())
+                            *static_cast<double>(settings->getK()))/1.0e9;
         for (double currentTime : avg_measures) {
             tmean +=  currentTime;
             if (currentTime < tmin) {
@@ -135,6 +331,48 @@ gemm::GEMMBenchmark::collectResults() {
         results.emplace("t_mean", hpcc_base::HpccResult(tmean, "s"));
         results.emplace("t_min", hpcc_base::HpccResult(tmin, "s"));
         results.emplace("gflops", hpcc_base::HpccResult(gflops / tmin, "GFLOP/s"));
+#ifdef MIXED_PRECISION_INPUTS
+        // Report the performance also in the performance class of the reduced precision inputs, e.g. as BF16 TFLOP/s
+        std::string precision_class(getInputPrecisionClass());
+        std::transform(precision_class.begin(), precision_class.end(), precision_class.begin(), ::tolower);
+        results.emplace("tflops_" + precision_class, hpcc_base::HpccResult(gflops / tmin / 1.0e3, "TFLOP/s"));
+#endif
+        if (settings->isRectangular()) {
+            // Fraction of the operations calculated by the kernel that are part of the actual shape
+            double padded_operations = static_cast<double>(settings->getPaddedSize(settings->getM()))
+                                        * static_cast<double>(settings->getPaddedSize(settings->getN()))
+                                        * static_cast<double>(settings->getPaddedSize(settings->getK()));
+            double efficiency = static_cast<double>(settings->getM()) * static_cast<double>(settings->getN())
+                                        * static_cast<double>(settings->getK()) / padded_operations;
+            results.emplace("padding_efficiency", hpcc_base::HpccResult(efficiency, ""));
+        }
+        if (settings->communicationType == hpcc_base::CommunicationType::unsupported && settings->batchSize == 0
+                && settings->streamTileSize == 0) {
+            // Report the device memory of every allocation of the default execution
+            gemm::GEMMMemoryPlan plan = bm_execution::planMemory(*executionSettings);
+            for (size_t k = 0; k < plan.allocationNames.size(); k++) {
+                results.emplace("memory_" + plan.allocationNames[k], hpcc_base::HpccResult(plan.allocationBytes[k], "B"));
+            }
+        }
+    }
+    // Report the mean time spent in the communication or transfers and the calculation, if they are measured separately.
+    // The slowest rank determines the execution time
+    for (std::string key : {"communication", "transfer", "calculation", "matrix", "latency"}) {
+        if (timings.count(key) == 0) {
+            continue;
+        }
+        double local_mean = 0.0;
+        for (double t : timings.at(key)) {
+            local_mean += t;
+        }
+        local_mean /= timings.at(key).size();
+        double max_mean = local_mean;
+#ifdef _USE_MPI_
+        MPI_Reduce(&local_mean, &max_mean, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+#endif
+        if (mpi_comm_rank == 0) {
+            results.emplace("t_" + key + "_mean", hpcc_base::HpccResult(max_mean, "s"));
+        }
     }
 }
 
@@ -148,24 +386,129 @@ gemm::GEMMBenchmark::printResults() {
         std::cout << std::setw(ENTRY_SPACE)
                 << results.at("t_min") << results.at("t_mean") << results.at("gflops")
                 << std::endl;
+#ifdef MIXED_PRECISION_INPUTS
+        std::string precision_class(getInputPrecisionClass());
+        std::string tflops_key = "tflops_" + precision_class;
+        std::transform(tflops_key.begin(), tflops_key.end(), tflops_key.begin(), ::tolower);
+        std::cout << std::left << std::setw(ENTRY_SPACE)
+                << " " + precision_class + " TFLOPS" << std::right << std::endl;
+        std::cout << std::setw(ENTRY_SPACE)
+                << results.at(tflops_key)
+                << std::endl;
+#endif
+        if (results.count("padding_efficiency") > 0) {
+            std::cout << std::left << std::setw(ENTRY_SPACE)
+                    << " padding eff." << std::right << std::endl;
+            std::cout << std::setw(ENTRY_SPACE)
+                    << results.at("padding_efficiency")
+                    << std::endl;
+        }
+        // Print the allocated device memory for every bank in a single table
+        std::vector<std::string> memory_keys;
+        for (auto const& result : results) {
+            if (result.first.rfind("memory_", 0) == 0) {
+                memory_keys.push_back(result.first);
+            }
+        }
+        if (!memory_keys.empty()) {
+            std::cout << std::left;
+            for (auto const& key : memory_keys) {
+                std::cout << std::setw(ENTRY_SPACE) << " " + key.substr(7);
+            }
+            std::cout << std::right << std::endl;
+            for (auto const& key : memory_keys) {
+                std::cout << std::setw(ENTRY_SPACE) << results.at(key);
+            }
+            std::cout << std::endl;
+        }
+        if (results.count("t_communication_mean") > 0) {
+            std::cout << std::left << std::setw(ENTRY_SPACE)
+                    << " comm. mean" << std::setw(ENTRY_SPACE) << " calc. mean" << std::right << std::endl;
+            std::cout << std::setw(ENTRY_SPACE)
+                    << results.at("t_communication_mean") << results.at("t_calculation_mean")
+                    << std::endl;
+        }
+        if (results.count("t_latency_mean") > 0) {
+            std::cout << std::left << std::setw(ENTRY_SPACE)
+                    << " time/matrix" << std::setw(ENTRY_SPACE) << " latency" << std::right << std::endl;
+            std::cout << std::setw(ENTRY_SPACE)
+                    << results.at("t_matrix_mean") << results.at("t_latency_mean")
+                    << std::endl;
+        }
+        if (results.count("t_transfer_mean") > 0) {
+            std::cout << std::left << std::setw(ENTRY_SPACE)
+                    << " transfer mean" << std::setw(ENTRY_SPACE) << " calc. mean" << std::right << std::endl;
+            std::cout << std::setw(ENTRY_SPACE)
+                    << results.at("t_transfer_mean") << results.at("t_calculation_mean")
+                    << std::endl;
+        }
     }
 }
 
 std::unique_ptr<gemm::GEMMData>
 gemm::GEMMBenchmark::generateInputData() {
-    auto d = std::unique_ptr<gemm::GEMMData>(new gemm::GEMMData(*executionSettings->context, executionSettings->programSettings->matrixSize));
+    uint global_size = executionSettings->programSettings->matrixSize;
+    uint local_size = executionSettings->programSettings->getLocalMatrixSize();
+    uint block_size = executionSettings->programSettings->blockSize;
+    uint matrix_count = executionSettings->programSettings->getMatrixCount();
     std::mt19937 gen(7);
-    std::uniform_real_distribution<> dis(-1.0, 1.0);
-    for (int j = 0; j < executionSettings->programSettings->matrixSize; j++) {
-        for (int i = 0; i < executionSettings->programSettings->matrixSize; i++) {
-            d->A[executionSettings->programSettings->matrixSize*i+j] = OPTIONAL_CAST(static_cast<double>(dis(gen)));
-            d->B[executionSettings->programSettings->matrixSize*i+j] = OPTIONAL_CAST(static_cast<double>(dis(gen)));
-            d->C[executionSettings->programSettings->matrixSize*i+j] = OPTIONAL_CAST(static_cast<double>(dis(gen)));
-            d->C_out[executionSettings->programSettings->matrixSize*i+j] = OPTIONAL_CAST(0.0);
-            d->normtotal = std::max(std::max(d->normtotal, d->A[executionSettings->programSettings->matrixSize*i+j]), 
-                                        std::max(d->B[executionSettings->programSettings->matrixSize*i+j], 
-                                        d->C[executionSettings->programSettings->matrixSize*i+j]));
+
+    if (executionSettings->programSettings->isRectangular()) {
+        std::uniform_real_distribution<> dis(-1.0, 1.0);
+        // The matrices are stored with sizes padded to a multiple of the block size.
+        // The padding is filled with zeros, so it does not change the result within the actual shape
+        auto settings = executionSettings->programSettings.get();
+        uint m = settings->getPaddedSize(settings->getM());
+        uint n = settings->getPaddedSize(settings->getN());
+        uint k = settings->getPaddedSize(settings->getK());
+        auto d = std::unique_ptr<gemm::GEMMData>(new gemm::GEMMData(*executionSettings->context, m, n, k, matrix_count));
+        auto fill_matrix = [&](HOST_DATA_TYPE* matrix, uint rows, uint cols, uint padded_rows, uint padded_cols) {
+            for (uint i = 0; i < padded_rows; i++) {
+                for (uint j = 0; j < padded_cols; j++) {
+                    HOST_DATA_TYPE value = OPTIONAL_CAST(0.0);
+                    if (i < rows && j < cols) {
+                        value = OPTIONAL_CAST(static_cast<double>(dis(gen)));
+                    }
+                    d->normtotal = std::max(d->normtotal, value);
+                    matrix[static_cast<size_t>(i) * padded_cols + j] = value;
+                }
+            }
+        };
+        for (uint b = 0; b < matrix_count; b++) {
+            fill_matrix(&d->A[static_cast<size_t>(b) * m * k], settings->getM(), settings->getK(), m, k);
+            fill_matrix(&d->B[static_cast<size_t>(b) * k * n], settings->getK(), settings->getN(), k, n);
+            fill_matrix(&d->C[static_cast<size_t>(b) * m * n], settings->getM(), settings->getN(), m, n);
+            std::fill(&d->C_out[static_cast<size_t>(b) * m * n], &d->C_out[static_cast<size_t>(b + 1) * m * n], OPTIONAL_CAST(0.0));
         }
+        return d;
+    }
+
+    auto d = std::unique_ptr<gemm::GEMMData>(new gemm::GEMMData(*executionSettings->context, local_size, matrix_count));
+    bool is_distributed = executionSettings->programSettings->communicationType == hpcc_base::CommunicationType::pcie_mpi;
+    int torus_width = executionSettings->programSettings->torus_width;
+    int torus_height = executionSettings->programSettings->torus_height;
+    // All ranks generate the values of the whole matrix, so the global matrix is independent of the number of ranks.
+    // In the distributed case, the blocks are distributed block-cyclic over the torus and every rank only keeps its own blocks.
+    // In the batched case, the matrices are generated one after another and stored contiguously.
+    for (uint m = 0; m < matrix_count; m++) {
+    size_t matrix_offset = static_cast<size_t>(m) * local_size * local_size;
+    generateGlobalMatrixValues(global_size, gen, [&](uint i, uint j, HOST_DATA_TYPE a_value, HOST_DATA_TYPE b_value, HOST_DATA_TYPE c_value) {
+            d->normtotal = std::max(std::max(d->normtotal, a_value), std::max(b_value, c_value));
+            size_t local_i = i;
+            size_t local_j = j;
+            if (is_distributed) {
+                if ((i / block_size) % torus_height != executionSettings->programSettings->torus_row ||
+                        (j / block_size) % torus_width != executionSettings->programSettings->torus_col) {
+                    return;
+                }
+                local_i = (i / block_size) / torus_height * block_size + (i % block_size);
+                local_j = (j / block_size) / torus_width * block_size + (j % block_size);
+            }
+            d->A[matrix_offset+local_size*local_i+local_j] = a_value;
+            d->B[matrix_offset+local_size*local_i+local_j] = b_value;
+            d->C[matrix_offset+local_size*local_i+local_j] = c_value;
+            d->C_out[matrix_offset+local_size*local_i+local_j] = OPTIONAL_CAST(0.0);
+    });
     }
     return d;
 }
@@ -173,28 +516,70 @@ gemm::GEMMBenchmark::generateInputData() {
 bool  
 gemm::GEMMBenchmark::validateOutput(gemm::GEMMData &data) {
     auto ref_data = generateInputData();
-
-    gemm_ref(ref_data->A, ref_data->B, ref_data->C, executionSettings->programSettings->matrixSize, OPTIONAL_CAST(0.5), OPTIONAL_CAST(2.0));
+    auto settings = executionSettings->programSettings.get();
+    bool is_distributed = settings->communicationType == hpcc_base::CommunicationType::pcie_mpi;
+    // The distributed GEMM only supports square matrices. Otherwise, the matrices are stored with padded sizes
+    uint local_m = is_distributed ? settings->getLocalMatrixSize() : settings->getPaddedSize(settings->getM());
+    uint local_n = is_distributed ? settings->getLocalMatrixSize() : settings->getPaddedSize(settings->getN());
+    uint local_k = is_distributed ? settings->getLocalMatrixSize() : settings->getPaddedSize(settings->getK());
+    size_t a_elements = static_cast<size_t>(local_m) * local_k;
+    size_t b_elements = static_cast<size_t>(local_k) * local_n;
+    size_t c_elements = static_cast<size_t>(local_m) * local_n;
+    uint matrix_count = settings->getMatrixCount();
 
     double resid = OPTIONAL_CAST(0.0);
     double normx = OPTIONAL_CAST(0.0);
+    // Additional scaling of the residual error depending on the validation method
+    double error_scaling = 1.0;
 
-    for (int i = 0; i < executionSettings->programSettings->matrixSize * executionSettings->programSettings->matrixSize; i++) {
-        resid = (resid > fabs(data.C_out[i] - ref_data->C[i])) ? resid : fabs(data.C_out[i] - ref_data->C[i]);
+    for (size_t i = 0; i < c_elements * matrix_count; i++) {
         normx = (normx > fabs(data.C_out[i])) ? normx : fabs(data.C_out[i]);
     }
 
+    // All matrices of a batch are validated independently and the maximum error is reported
+    for (uint m = 0; m < matrix_count; m++) {
+        HOST_DATA_TYPE* a = &ref_data->A[m * a_elements];
+        HOST_DATA_TYPE* b = &ref_data->B[m * b_elements];
+        HOST_DATA_TYPE* c = &ref_data->C[m * c_elements];
+        HOST_DATA_TYPE* c_out = &data.C_out[m * c_elements];
+        if (executionSettings->programSettings->validationVectors > 0) {
+            // Probabilistic validation that only requires matrix-vector products.
+            // Every element of the residual vector is the sum of n element errors multiplied with +-1.
+            // For rounding errors this sum grows with sqrt(n), while a single wrong element of the result is still fully visible
+            resid = std::max(resid, freivalds_residual(a, b, c, c_out, *executionSettings->programSettings,
+                                        OPTIONAL_CAST(0.5), OPTIONAL_CAST(2.0)));
+            error_scaling = std::sqrt(static_cast<double>(settings->getN()));
+        }
+#ifdef _USE_MPI_
+        else if (is_distributed) {
+            resid = std::max(resid, gathered_gemm_residual(c_out, *settings, OPTIONAL_CAST(0.5), OPTIONAL_CAST(2.0)));
+        }
+#endif
+        else {
+            gemm_ref(a, b, c, local_m, local_n, local_k, OPTIONAL_CAST(0.5), OPTIONAL_CAST(2.0));
+
+            for (size_t i = 0; i < c_elements; i++) {
+                resid = (resid > fabs(c_out[i] - c[i])) ? resid : fabs(c_out[i] - c[i]);
+            }
+        }
+    }
+
 #ifdef _USE_MPI_
     double max_resid = 0.0;
     MPI_Reduce(&resid, &max_resid, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
     resid = max_resid;
+    double max_normx = 0.0;
+    MPI_Reduce(&normx, &max_normx, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    normx = max_normx;
 #endif
 
     // Calculate the overall error only on rank 0
     if (mpi_comm_rank == 0) {
         // Calculate the residual error normalized to the total matrix size, input values and machine epsilon
-        double eps = std::numeric_limits<HOST_DATA_TYPE>::epsilon();
-        double residn = resid / (executionSettings->programSettings->matrixSize*executionSettings->programSettings->matrixSize*ref_data->normtotal*normx*eps);
+        // The accuracy is limited by the precision of the inputs on the device, which may be lower than on the host
+        double eps = getInputEpsilon();
+        double size_scaling = static_cast<double>(settings->getK()) * std::max(settings->getM(), settings->getN());
+        double residn = resid / (size_scaling*ref_data->normtotal*normx*eps*error_scaling);
 
         errors.emplace("epsilon", eps);
         errors.emplace("residual", resid);
@@ -214,72 +599,347 @@ gemm::GEMMBenchmark::printError() {
     }
 }
 
+bool
+gemm::GEMMBenchmark::checkInputParameters() {
+    bool validationResult = true;
+    if (executionSettings->programSettings->communicationType == hpcc_base::CommunicationType::pcie_mpi) {
+        if (executionSettings->programSettings->torus_width != executionSettings->programSettings->torus_height) {
+            // The kernel only calculates square matrices, so the local tiles also have to be square
+            std::cerr << "ERROR: The distributed GEMM requires a square torus, but P=" << executionSettings->programSettings->torus_width
+                        << " and Q=" << executionSettings->programSettings->torus_height << "!" << std::endl;
+            validationResult = false;
+        }
+        if ((executionSettings->programSettings->matrixSize / executionSettings->programSettings->blockSize) % executionSettings->programSettings->torus_width != 0) {
+            std::cerr << "ERROR: The matrix size in blocks has to be a multiple of P=" << executionSettings->programSettings->torus_width << "!" << std::endl;
+            validationResult = false;
+        }
+        // The tiles are broadcasted as bytes and MPI only supports int as count
+        size_t local_size = executionSettings->programSettings->getLocalMatrixSize();
+        if (sizeof(HOST_DATA_TYPE) * local_size * local_size > static_cast<size_t>(std::numeric_limits<int>::max())) {
+            std::cerr << "ERROR: The local tiles of the distributed GEMM are too large to be broadcasted with MPI. Use a larger torus or a smaller matrix!" << std::endl;
+            validationResult = false;
+        }
+#ifdef USE_SVM
+        std::cerr << "ERROR: The distributed GEMM does not support SVM!" << std::endl;
+        validationResult = false;
+#endif
+    }
+    if (executionSettings->programSettings->isRectangular()) {
+        if (executionSettings->programSettings->communicationType != hpcc_base::CommunicationType::unsupported ||
+                executionSettings->programSettings->streamTileSize > 0 || executionSettings->programSettings->batchSize > 0) {
+            std::cerr << "ERROR: Custom matrix shapes are only supported for the communication type " << commToString(hpcc_base::CommunicationType::unsupported)
+                        << " without batched or out-of-core execution!" << std::endl;
+            validationResult = false;
+        }
+        if (executionSettings->programSettings->matrixM == 0 || executionSettings->programSettings->matrixN == 0 || executionSettings->programSettings->matrixK == 0) {
+            std::cerr << "ERROR: All dimensions of the matrix shape have to be larger than 0!" << std::endl;
+            validationResult = false;
+        }
+    }
+    if (executionSettings->programSettings->batchSize > 0) {
+        if (executionSettings->programSettings->communicationType != hpcc_base::CommunicationType::unsupported ||
+                executionSettings->programSettings->streamTileSize > 0) {
+            std::cerr << "ERROR: The batched execution is only supported for the communication type " << commToString(hpcc_base::CommunicationType::unsupported)
+                        << " without out-of-core execution!" << std::endl;
+            validationResult = false;
+        }
+#ifdef USE_SVM
+        std::cerr << "ERROR: The batched execution does not support SVM!" << std::endl;
+        validationResult = false;
+#endif
+    }
+#ifdef MIXED_PRECISION_INPUTS
+    if (executionSettings->programSettings->communicationType != hpcc_base::CommunicationType::unsupported ||
+            executionSettings->programSettings->streamTileSize > 0) {
+        std::cerr << "ERROR: Reduced precision inputs are only supported by the default and batched execution!" << std::endl;
+        validationResult = false;
+    }
+#endif
+    if (executionSettings->programSettings->streamTileSize > 0) {
+        if (executionSettings->programSettings->communicationType != hpcc_base::CommunicationType::unsupported) {
+            std::cerr << "ERROR: The out-of-core execution is only supported for the communication type " << commToString(hpcc_base::CommunicationType::unsupported) << "!" << std::endl;
+            validationResult = false;
+        }
+        if ((executionSettings->programSettings->matrixSize / executionSettings->programSettings->blockSize) % executionSettings->programSettings->streamTileSize != 0) {
+            std::cerr << "ERROR: The matrix size in blocks has to be a multiple of the stream tile size " << executionSettings->programSettings->streamTileSize << "!" << std::endl;
+            validationResult = false;
+        }
+#ifdef USE_SVM
+        std::cerr << "ERROR: The out-of-core execution does not support SVM!" << std::endl;
+        validationResult = false;
+#endif
+    }
+    return validationResult;
+}
+
+double
+gemm::getInputEpsilon() {
+#if defined(INPUT_DATA_TYPE_BFLOAT16)
+    // bfloat16 has 7 explicit bits in the mantissa
+    return std::ldexp(1.0, -7);
+#elif defined(INPUT_DATA_TYPE_HALF) || DATA_TYPE_SIZE == 2
+    // Also used for the mixed precision kernel, which calculates in half precision on the device
+    return static_cast<double>(std::numeric_limits<half_float::half>::epsilon());
+#else
+    return std::numeric_limits<HOST_DATA_TYPE>::epsilon();
+#endif
+}
+
+#ifdef MIXED_PRECISION_INPUTS
+const char*
+gemm::getInputPrecisionClass() {
+#ifdef INPUT_DATA_TYPE_BFLOAT16
+    return "BF16";
+#else
+    return "FP16";
+#endif
+}
+#endif
+
+#ifdef _USE_MPI_
+double
+gemm::gathered_gemm_residual(HOST_DATA_TYPE* c_out, GEMMProgramSettings const& settings, HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta) {
+    int mpi_comm_rank;
+    int mpi_comm_size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_comm_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &mpi_comm_size);
+    uint global_size = settings.matrixSize;
+    uint local_size = settings.getLocalMatrixSize();
+    uint block_size = settings.blockSize;
+    size_t tile_size = static_cast<size_t>(local_size) * local_size;
+
+    // Gather the local tiles of the result on rank 0. The size of the tiles is checked in checkInputParameters
+    std::vector<HOST_DATA_TYPE> tiles((mpi_comm_rank == 0) ? tile_size * mpi_comm_size : 0);
+    MPI_Gather(c_out, static_cast<int>(sizeof(HOST_DATA_TYPE) * tile_size), MPI_BYTE, tiles.data(),
+                static_cast<int>(sizeof(HOST_DATA_TYPE) * tile_size), MPI_BYTE, 0, MPI_COMM_WORLD);
+    if (mpi_comm_rank != 0) {
+        return 0.0;
+    }
+
+    // Calculate the reference on the global matrices without any distribution
+    size_t global_elements = static_cast<size_t>(global_size) * global_size;
+    std::unique_ptr<HOST_DATA_TYPE[]> a(new HOST_DATA_TYPE[global_elements]);
+    std::unique_ptr<HOST_DATA_TYPE[]> b(new HOST_DATA_TYPE[global_elements]);
+    std::unique_ptr<HOST_DATA_TYPE[]> c(new HOST_DATA_TYPE[global_elements]);
+    std::mt19937 gen(7);
+    generateGlobalMatrixValues(global_size, gen, [&](uint i, uint j, HOST_DATA_TYPE a_value, HOST_DATA_TYPE b_value, HOST_DATA_TYPE c_value) {
+        a[static_cast<size_t>(global_size) * i + j] = a_value;
+        b[static_cast<size_t>(global_size) * i + j] = b_value;
+        c[static_cast<size_t>(global_size) * i + j] = c_value;
+    });
+    gemm_ref(a.get(), b.get(), c.get(), global_size, alpha, beta);
+
+    // Compare every value of the gathered tiles with the value at its position in the block-cyclic distribution
+    double resid = 0.0;
+    for (int rank = 0; rank < mpi_comm_size; rank++) {
+        uint torus_row = rank / settings.torus_width;
+        uint torus_col = rank % settings.torus_width;
+        for (uint local_i = 0; local_i < local_size; local_i++) {
+            size_t i = ((local_i / block_size) * settings.torus_height + torus_row) * block_size + local_i % block_size;
+            for (uint local_j = 0; local_j < local_size; local_j++) {
+                size_t j = ((local_j / block_size) * settings.torus_width + torus_col) * block_size + local_j % block_size;
+                double value = tiles[rank * tile_size + static_cast<size_t>(local_i) * local_size + local_j];
+                resid = std::max(resid, std::abs(value - static_cast<double>(c[global_size * i + j])));
+            }
+        }
+    }
+    return resid;
+}
+#endif
+
+double
+gemm::freivalds_residual(HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, HOST_DATA_TYPE* c, HOST_DATA_TYPE* c_out,
+                                GEMMProgramSettings const& settings, HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta) {
+    uint block_size = settings.blockSize;
+    bool is_distributed = settings.communicationType == hpcc_base::CommunicationType::pcie_mpi;
+    // The distributed GEMM only supports square matrices. Otherwise, the matrices are stored with padded sizes
+    uint local_m = is_distributed ? settings.getLocalMatrixSize() : settings.getPaddedSize(settings.getM());
+    uint local_n = is_distributed ? settings.getLocalMatrixSize() : settings.getPaddedSize(settings.getN());
+    uint local_k = is_distributed ? settings.getLocalMatrixSize() : settings.getPaddedSize(settings.getK());
+    uint global_n = is_distributed ? settings.matrixSize : local_n;
+#ifdef _USE_MPI_
+    MPI_Comm row_communicator;
+    MPI_Comm col_communicator;
+    if (is_distributed) {
+        MPI_Comm_split(MPI_COMM_WORLD, settings.torus_row, 0, &row_communicator);
+        MPI_Comm_split(MPI_COMM_WORLD, settings.torus_col, 0, &col_communicator);
+    }
+#endif
+
+    // Calculate y = M * x for the local matrix in double precision
+    auto matrix_vector = [](HOST_DATA_TYPE* m, int rows, int cols, std::vector<double> const& x, std::vector<double>& y) {
+        #pragma omp parallel for
+        for (int i = 0; i < rows; i++) {
+            double sum = 0.0;
+            for (int j = 0; j < cols; j++) {
+                sum += static_cast<double>(m[static_cast<size_t>(i) * cols + j]) * x[j];
+            }
+            y[i] = sum;
+        }
+    };
+
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<> dis(0, 1);
+    std::vector<double> x(local_n);
+    std::vector<double> bx(local_k);
+    std::vector<double> abx(local_m);
+    std::vector<double> cx(local_m);
+    std::vector<double> c_out_x(local_m);
+    double resid = 0.0;
+    for (uint v = 0; v < settings.validationVectors; v++) {
+        // All ranks generate the same random vector with values -1 or 1 and keep their own part of it
+        for (uint j = 0; j < global_n; j++) {
+            double value = 2.0 * dis(gen) - 1.0;
+            if (!is_distributed) {
+                x[j] = value;
+            }
+            else if ((j / block_size) % settings.torus_width == settings.torus_col) {
+                x[(j / block_size) / settings.torus_width * block_size + (j % block_size)] = value;
+            }
+        }
+        matrix_vector(b, local_k, local_n, x, bx);
+        matrix_vector(c, local_m, local_n, x, cx);
+        matrix_vector(c_out, local_m, local_n, x, c_out_x);
+#ifdef _USE_MPI_
+        if (is_distributed) {
+            // Sum up the partial results along the rows. Afterwards B*x for the rows of B stored in this torus row is
+            // available on every rank of the row. The rank on the diagonal forwards it to the ranks that hold
+            // the matching columns of A
+            MPI_Allreduce(MPI_IN_PLACE, bx.data(), local_k, MPI_DOUBLE, MPI_SUM, row_communicator);
+            MPI_Bcast(bx.data(), local_k, MPI_DOUBLE, settings.torus_col, col_communicator);
+        }
+#endif
+        matrix_vector(a, local_m, local_k, bx, abx);
+#ifdef _USE_MPI_
+        if (is_distributed) {
+            MPI_Allreduce(MPI_IN_PLACE, abx.data(), local_m, MPI_DOUBLE, MPI_SUM, row_communicator);
+            MPI_Allreduce(MPI_IN_PLACE, cx.data(), local_m, MPI_DOUBLE, MPI_SUM, row_communicator);
+            MPI_Allreduce(MPI_IN_PLACE, c_out_x.data(), local_m, MPI_DOUBLE, MPI_SUM, row_communicator);
+        }
+#endif
+        for (uint i = 0; i < local_m; i++) {
+            double r = std::abs(c_out_x[i] - static_cast<double>(alpha) * abx[i] - static_cast<double>(beta) * cx[i]);
+            resid = std::max(resid, r);
+        }
+    }
+
+#ifdef _USE_MPI_
+    if (is_distributed) {
+        MPI_Comm_free(&row_communicator);
+        MPI_Comm_free(&col_communicator);
+    }
+#endif
+    return resid;
+}
+
 void 
 gemm::gemm_ref(HOST_DATA_TYPE* a,HOST_DATA_TYPE* b, HOST_DATA_TYPE* c,
                                 int n, HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta) {
+    gemm_ref(a, b, c, n, n, n, alpha, beta);
+}
+
+void 
+gemm::gemm_ref(HOST_DATA_TYPE* a,HOST_DATA_TYPE* b, HOST_DATA_TYPE* c,
+                                int m, int n, int k, HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta) {
 #ifdef _USE_BLAS_
+    // BLAS expects column-major matrices, so C^T = B^T * A^T is calculated
     char ta = 'N';
     char tb = 'N';
 #endif
 #if (defined(_USE_BLAS_) && DATA_TYPE_SIZE == 2) 
         // convert matrices to single precision to allow the use of BLAS routine
-        std::unique_ptr<float[]> temp_a = std::unique_ptr<float[]>(new float[n * n]);
-        std::unique_ptr<float[]> temp_b = std::unique_ptr<float[]>(new float[n * n]);
-        std::unique_ptr<float[]> temp_c = std::unique_ptr<float[]>(new float[n * n]);
-        for (int i=0; i < n; i++) {
-            for (int j=0; j < n; j++) {
-                temp_a[i * n + j] = half_float::half_cast<float, half_float::half>(a[i*n + j]);
-                temp_b[i * n + j] = half_float::half_cast<float, half_float::half>(b[i*n + j]);
-                temp_c[i * n + j] = half_float::half_cast<float, half_float::half>(c[i*n + j]);
-            }
+        std::unique_ptr<float[]> temp_a = std::unique_ptr<float[]>(new float[m * k]);
+        std::unique_ptr<float[]> temp_b = std::unique_ptr<float[]>(new float[k * n]);
+        std::unique_ptr<float[]> temp_c = std::unique_ptr<float[]>(new float[m * n]);
+        for (int i=0; i < m * k; i++) {
+            temp_a[i] = half_float::half_cast<float, half_float::half>(a[i]);
+        }
+        for (int i=0; i < k * n; i++) {
+            temp_b[i] = half_float::half_cast<float, half_float::half>(b[i]);
+        }
+        for (int i=0; i < m * n; i++) {
+            temp_c[i] = half_float::half_cast<float, half_float::half>(c[i]);
         }
         float alpha_sp = half_float::half_cast<float, half_float::half>(alpha);
         float beta_sp = half_float::half_cast<float, half_float::half>(beta);
         // Use single precision for validation
-        sgemm_(&ta, &tb, &n, &n, &n, &alpha_sp, temp_b.get(), &n, temp_a.get(), &n, &beta_sp, temp_c.get(), &n);
+        sgemm_(&ta, &tb, &n, &m, &k, &alpha_sp, temp_b.get(), &n, temp_a.get(), &k, &beta_sp, temp_c.get(), &n);
         // convert the result back to half precision
-        for (int i=0; i < n; i++) {
-            for (int j=0; j < n; j++) {
-                c[i * n + j] = half_float::half_cast<half_float::half, float>(temp_c[i*n + j]);
-            }
+        for (int i=0; i < m * n; i++) {
+            c[i] = half_float::half_cast<half_float::half, float>(temp_c[i]);
         }
 #endif
 #if (defined(_USE_BLAS_) && DATA_TYPE_SIZE == 4) 
         // Use single precision for validation
-        sgemm_(&ta, &tb, &n, &n, &n, &alpha, b, &n, a, &n, &beta, c, &n);
+        sgemm_(&ta, &tb, &n, &m, &k, &alpha, b, &n, a, &k, &beta, c, &n);
 #endif
 #if (defined(_USE_BLAS_) && DATA_TYPE_SIZE == 8) 
         // use double precision for validation
-        dgemm_(&ta, &tb, &n, &n, &n, &alpha, b, &n, a, &n, &beta, c, &n);
+        dgemm_(&ta, &tb, &n, &m, &k, &alpha, b, &n, a, &k, &beta, c, &n);
 #endif
 #if (!defined(_USE_BLAS_) || (DATA_TYPE_SIZE != 2 && DATA_TYPE_SIZE != 4 && DATA_TYPE_SIZE != 8)) 
-        // Caclulate manually. Thisi s the default, if BLAS is not found
-        #pragma omp parallel
-        {
-        #pragma omp for
-        for (int i=0; i < n; i++) {
-            for (int j=0; j < n; j++) {
-                c[i * n + j] = beta * c[i*n + j];
-            }
-        }
+        // Calculate with the packed host implementation. This is the default, if BLAS is not found
+        gemm_packed(a, b, c, m, n, k, alpha, beta);
+#endif
+}
 
-#define HOST_MM_BLOCK_SIZE 256
-
-        #pragma omp for collapse(2)
-        for (int i=0; i < n; i+=HOST_MM_BLOCK_SIZE) {
-            for (int j=0; j < n; j+=HOST_MM_BLOCK_SIZE) {
-                for (int k=0; k < n; k+=HOST_MM_BLOCK_SIZE) {
-                     for (int ii=i; ii < std::min(i + HOST_MM_BLOCK_SIZE, n); ii++) {
-                        for (int kk=k; kk < std::min(k + HOST_MM_BLOCK_SIZE, n); kk++) {  
-                            HOST_DATA_TYPE scaled_a =  alpha * a[ii*n + kk];
-                            for (int jj=j; jj < std::min(j + HOST_MM_BLOCK_SIZE, n); jj++) {   
-                                c[ii*n + jj] += scaled_a * b[kk*n + jj];
-                            }
-                        }
-                     }
-                }
-            }
+gemm::GEMMMemoryPlan
+gemm::planDeviceMemory(uint m_size, uint n_size, uint k_size, uint block_size, uint replications,
+                        bool replicate_inputs, GEMMPlacement placement, size_t alignment) {
+    GEMMMemoryPlan plan;
+
+    size_t m_blocks = m_size / block_size;
+    size_t number_blocks_per_kernel = (m_blocks + replications - 1) / replications;
+    size_t a_bytes = sizeof(HOST_INPUT_DATA_TYPE) * m_size * k_size;
+    size_t b_bytes = sizeof(HOST_INPUT_DATA_TYPE) * k_size * n_size;
+    size_t c_bytes = sizeof(HOST_DATA_TYPE) * m_size * n_size;
+    size_t out_bytes = sizeof(HOST_DATA_TYPE) * n_size * number_blocks_per_kernel * block_size;
+
+    // Every buffer 0-3 (A, B, C, result) gets its own allocation, so no allocation is larger than a single matrix.
+    // If the host places the buffers, the allocations are named after the memory bank they are located in
+    std::string buffer_names[4] = {"a", "b", "c", "out"};
+    auto allocate = [&](int buffer, std::string const& suffix, size_t bytes) -> GEMMBufferLocation {
+        plan.allocationNames.push_back(placement == GEMMPlacement::banks ? "bank" + std::to_string(buffer + 1)
+                                                                        : buffer_names[buffer] + suffix);
+        plan.allocationBanks.push_back(placement == GEMMPlacement::banks ? buffer + 1 : 0);
+        plan.allocationBytes.push_back(bytes);
+        return {static_cast<uint>(plan.allocationBytes.size() - 1), 0, bytes};
+    };
+
+    // Replicas of the inputs only make sense if the kernel places them in different memory banks.
+    // Otherwise, all replicas would be stored in the same memory, so the inputs are only stored once
+    bool replicated = replicate_inputs && placement == GEMMPlacement::kernel;
+    for (uint i = 0; i < replications; i++) {
+        bool new_replica = (i == 0 || replicated);
+        std::string suffix = replicated ? std::to_string(i) : "";
+        plan.a.push_back(new_replica ? allocate(0, suffix, a_bytes) : plan.a[0]);
+        plan.b.push_back(new_replica ? allocate(1, suffix, b_bytes) : plan.b[0]);
+        plan.c.push_back(new_replica ? allocate(2, suffix, c_bytes) : plan.c[0]);
+    }
+
+    if (placement == GEMMPlacement::kernel) {
+        // The kernel may select a different memory bank for the result of every replication
+        for (uint i = 0; i < replications; i++) {
+            plan.out.push_back(allocate(3, std::to_string(i), out_bytes));
         }
+        return plan;
+    }
+
+    // All results are located in the same memory, so they are stored as aligned sub-buffers of a single allocation.
+    // The last replications may calculate less or no blocks, so the allocation does not exceed the size of C
+    // much, instead of being replications times the size of a full result buffer
+    GEMMBufferLocation out_allocation = allocate(3, "", 0);
+    for (uint i = 0; i < replications; i++) {
+        size_t remaining_bytes = (c_bytes > i * out_bytes) ? c_bytes - i * out_bytes : 0;
+        if (remaining_bytes == 0) {
+            // The kernel does not write any block, so it reuses the location of the first replication
+            plan.out.push_back(plan.out[0]);
+            continue;
         }
-#endif
+        size_t offset = (plan.allocationBytes[out_allocation.allocation] + alignment - 1) / alignment * alignment;
+        size_t bytes = std::min(out_bytes, remaining_bytes);
+        plan.allocationBytes[out_allocation.allocation] = offset + bytes;
+        plan.out.push_back({out_allocation.allocation, offset, bytes});
+    }
+    return plan;
 }
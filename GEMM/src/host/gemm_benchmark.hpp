@@ -26,6 +26,8 @@ SOFTWARE.
 /* C++ standard library headers */
 #include <complex>
 #include <memory>
+#include <string>
+#include <vector>
 
 /* Project's headers */
 #include "hpcc_benchmark.hpp"
@@ -76,6 +78,119 @@ public:
      */
     bool replicateInputBuffers;
 
+    /**
+     * @brief The row position of this MPI rank in the torus
+     * 
+     */
+    int torus_row;
+
+    /**
+     * @brief The column position of this MPI rank in the torus
+     * 
+     */
+    int torus_col;
+
+    /**
+     * @brief Width of the torus in number of ranks
+     * 
+     */
+    int torus_width;
+
+    /**
+     * @brief Height of the torus in number of ranks
+     * 
+     */
+    int torus_height;
+
+    /**
+     * @brief Number of random vectors used for the probabilistic validation. If 0, the full reference GEMM is calculated
+     * 
+     */
+    uint validationVectors;
+
+    /**
+     * @brief Size of the super-tiles in blocks that are streamed to the device. If 0, the whole matrices are stored on the device
+     * 
+     */
+    uint streamTileSize;
+
+    /**
+     * @brief Number of rows of A and C, if a custom shape is given. Otherwise 0
+     * 
+     */
+    uint matrixM;
+
+    /**
+     * @brief Number of columns of B and C, if a custom shape is given. Otherwise 0
+     * 
+     */
+    uint matrixN;
+
+    /**
+     * @brief Number of columns of A and rows of B, if a custom shape is given. Otherwise 0
+     * 
+     */
+    uint matrixK;
+
+    /**
+     * @brief Check if a custom shape is used instead of square matrices of the given matrix size
+     * 
+     * @return true if the shape is given with M, N and K
+     */
+    bool isRectangular() const;
+
+    /**
+     * @brief Get the number of rows of A and C
+     * 
+     * @return uint M of the custom shape or the matrix size
+     */
+    uint getM() const;
+
+    /**
+     * @brief Get the number of columns of B and C
+     * 
+     * @return uint N of the custom shape or the matrix size
+     */
+    uint getN() const;
+
+    /**
+     * @brief Get the number of columns of A and rows of B
+     * 
+     * @return uint K of the custom shape or the matrix size
+     */
+    uint getK() const;
+
+    /**
+     * @brief Get the size of a matrix dimension padded to a multiple of the block size.
+     *          The matrices are stored with padded sizes, so the kernel can calculate on whole blocks.
+     * 
+     * @param size The size of the matrix dimension
+     * @return uint the padded size
+     */
+    uint getPaddedSize(uint size) const;
+
+    /**
+     * @brief Number of independent matrices that are calculated in the batched execution. If 0, a single matrix is calculated
+     * 
+     */
+    uint batchSize;
+
+    /**
+     * @brief Get the number of matrices that are stored on a single rank
+     * 
+     * @return uint the batch size or 1, if the batched execution is not used
+     */
+    uint getMatrixCount() const;
+
+    /**
+     * @brief Get the size of the matrices that are stored on a single rank in one dimension.
+     *          For the distributed GEMM, the matrices are distributed over the torus.
+     *          Otherwise, every rank calculates on independent matrices of the full size.
+     * 
+     * @return uint the local matrix size
+     */
+    uint getLocalMatrixSize() const;
+
     /**
      * @brief Construct a new GEMM Program Settings object
      * 
@@ -92,6 +207,93 @@ public:
 
 };
 
+/**
+ * @brief Strategy that is used to place the device buffers of the default execution in the global memory
+ * 
+ */
+enum class GEMMPlacement {
+    /**
+     * @brief The memory bank of every buffer is selected by the host
+     * 
+     */
+    banks,
+
+    /**
+     * @brief All buffers are placed in the same interleaved global memory
+     * 
+     */
+    interleaved,
+
+    /**
+     * @brief The memory bank of every buffer is selected by the kernel attributes or the linker,
+     *          so every buffer of every replication needs its own allocation
+     * 
+     */
+    kernel
+};
+
+/**
+ * @brief Location of a device buffer within an allocation of the memory plan
+ * 
+ */
+struct GEMMBufferLocation {
+
+    /**
+     * @brief Index of the allocation that contains the buffer
+     * 
+     */
+    uint allocation;
+
+    /**
+     * @brief Offset of the buffer in the allocation in bytes
+     * 
+     */
+    size_t offset;
+
+    /**
+     * @brief Size of the buffer in bytes
+     * 
+     */
+    size_t bytes;
+
+    bool operator==(GEMMBufferLocation const& other) const {
+        return allocation == other.allocation && offset == other.offset && bytes == other.bytes;
+    }
+};
+
+/**
+ * @brief Device allocations that are needed by the default execution.
+ *          The buffers that are used by the kernel replications are these allocations or sub-buffers of them.
+ * 
+ */
+struct GEMMMemoryPlan {
+
+    /**
+     * @brief Name of every allocation. For the placement in banks, this is the name of the memory bank
+     * 
+     */
+    std::vector<std::string> allocationNames;
+
+    /**
+     * @brief Memory bank of every allocation that is selected by the host, counting from 1. If 0, the default memory is used
+     * 
+     */
+    std::vector<int> allocationBanks;
+
+    /**
+     * @brief Size of every allocation in bytes
+     * 
+     */
+    std::vector<size_t> allocationBytes;
+
+    /**
+     * @brief Location of the buffers for A, B, C and the result for every kernel replication.
+     *          Kernel replications may share the same location.
+     * 
+     */
+    std::vector<GEMMBufferLocation> a, b, c, out;
+};
+
 /**
  * @brief Data class containing all data needed by the kernel to calculate
  *          \f$C\_out = \alpha * A * B + \beta * C\f$
@@ -153,8 +355,20 @@ public:
      * 
      * @param context The OpenCL context used to allocate memory in SVM mode
      * @param size Size of the allocated square matrices
+     * @param count Number of matrices that are stored contiguously in every array
+     */
+    GEMMData(cl::Context context, uint size, uint count = 1);
+
+    /**
+     * @brief Construct a new GEMM Data object for rectangular matrices
+     * 
+     * @param context The OpenCL context used to allocate memory in SVM mode
+     * @param m Number of rows of A and C
+     * @param n Number of columns of B and C
+     * @param k Number of columns of A and rows of B
+     * @param count Number of matrices that are stored contiguously in every array
      */
-    GEMMData(cl::Context context, uint size);
+    GEMMData(cl::Context context, uint m, uint n, uint k, uint count = 1);
 
     /**
      * @brief Destroy the GEMM Data object. Free the allocated memory
@@ -216,6 +430,14 @@ public:
     void
     printError() override;
 
+    /**
+     * @brief Check the given benchmark configuration and its validity
+     * 
+     * @return true if the validation is successful, false otherwise
+     */
+    bool
+    checkInputParameters() override;
+
     void collectResults() override;
     /**
      * @brief GEMM specific implementation of printing the execution results
@@ -255,6 +477,146 @@ C = alpha * A * B + beta * C
 void gemm_ref( HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, HOST_DATA_TYPE* c,
                                 int n, HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta);
 
+/**
+Multiply rectangular matrices and add the result to another matrix.
+
+C = alpha * A * B + beta * C
+
+@param a matrix A with m rows and k columns
+@param b matrix B with k rows and n columns
+@param c matrix C with m rows and n columns that will also be the result matrix
+@param m number of rows of A and C
+@param n number of columns of B and C
+@param k number of columns of A and rows of B
+@param alpha scalar value used to scale A * B
+@param beta scalar value used to scale C
+*/
+void gemm_ref(HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, HOST_DATA_TYPE* c,
+                int m, int n, int k, HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta);
+
+/**
+Calculate C = alpha * A * B + beta * C on the host without BLAS.
+The matrices are packed into cache-blocked panels and multiplied with a
+register-blocked microkernel, parallelized with OpenMP over macro-tiles of C.
+Half precision matrices are converted to single precision for the calculation.
+
+@param a matrix A
+@param b matrix B
+@param c matrix C that will also be the result matrix
+@param n size of all quadratic matrices
+@param alpha scalar value used to scale A * B
+@param beta scalar value used to scale C
+*/
+void gemm_packed(HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, HOST_DATA_TYPE* c,
+                    int n, HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta);
+
+/**
+Calculate C = alpha * A * B + beta * C on the host without BLAS for rectangular matrices.
+
+@param a matrix A with m rows and k columns
+@param b matrix B with k rows and n columns
+@param c matrix C with m rows and n columns that will also be the result matrix
+@param m number of rows of A and C
+@param n number of columns of B and C
+@param k number of columns of A and rows of B
+@param alpha scalar value used to scale A * B
+@param beta scalar value used to scale C
+*/
+void gemm_packed(HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, HOST_DATA_TYPE* c,
+                    int m, int n, int k, HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta);
+
+/**
+Calculate the device allocations for the default execution.
+Every matrix is stored in its own allocation, so no allocation exceeds the size of a single matrix.
+A, B and C are only stored once per kernel replication if the input buffers are replicated and the kernel
+selects the memory bank. Otherwise, all replicas would be located in the same memory and the inputs are shared.
+If the host selects the memory, the results of all replications are aligned sub-buffers of a single allocation.
+
+@param m_size The padded number of rows of A and C
+@param n_size The padded number of columns of B and C
+@param k_size The padded number of columns of A and rows of B
+@param block_size The block size used by the kernel
+@param replications The number of kernel replications
+@param replicate_inputs If true, the input buffers are replicated for every kernel replication
+@param placement The strategy used to place the buffers in the global memory
+@param alignment Alignment of the sub-buffers in bytes
+@return the memory plan
+*/
+GEMMMemoryPlan planDeviceMemory(uint m_size, uint n_size, uint k_size, uint block_size, uint replications,
+                                bool replicate_inputs, GEMMPlacement placement, size_t alignment);
+
+/**
+Parse a matrix shape given in the format MxNxK. Throws a runtime error if the format is invalid or
+a dimension is not larger than 0.
+
+@param shape the string containing the matrix shape
+@param m the parsed number of rows of A and C
+@param n the parsed number of columns of B and C
+@param k the parsed number of columns of A and rows of B
+*/
+void parseMatrixShape(std::string const& shape, uint& m, uint& n, uint& k);
+
+/**
+Get the machine epsilon of the input matrices on the device.
+This is lower than the epsilon of the host data type, if the inputs are converted to a reduced precision format.
+
+@return the machine epsilon of the input data type
+*/
+double getInputEpsilon();
+
+#ifdef MIXED_PRECISION_INPUTS
+/**
+Get the name of the performance class of the reduced precision inputs
+
+@return FP16 or BF16
+*/
+const char* getInputPrecisionClass();
+
+/**
+Convert values to the reduced precision format of the inputs on the device, rounding to the nearest even value.
+The conversion is vectorized and uses F16C instructions for half precision, if available.
+
+@param in the single precision input values
+@param out the converted values
+@param count number of values to convert
+*/
+void convertToInputType(const HOST_DATA_TYPE* in, HOST_INPUT_DATA_TYPE* out, size_t count);
+#endif
+
+/**
+Probabilistic validation of the result following Freivalds' algorithm.
+The result is multiplied with random vectors x with values -1 or 1 and compared
+to alpha * A * (B * x) + beta * C * x. This only requires O(n^2) operations per vector.
+For the distributed GEMM, the partial matrix-vector products are reduced over the torus.
+
+@param a local part of matrix A
+@param b local part of matrix B
+@param c local part of matrix C
+@param c_out local part of the calculated result matrix
+@param settings The program settings containing the number of vectors and the torus configuration
+@param alpha scalar value used to scale A * B
+@param beta scalar value used to scale C
+@return the maximum absolute value of the residual vectors of this rank
+*/
+double freivalds_residual(HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, HOST_DATA_TYPE* c, HOST_DATA_TYPE* c_out,
+                                GEMMProgramSettings const& settings, HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta);
+
+#ifdef _USE_MPI_
+/**
+Validate the result of the distributed GEMM against a non-distributed reference.
+The local tiles of the result are gathered on rank 0, which calculates the reference with gemm_ref
+on the global matrices and compares every value at its position in the block-cyclic distribution.
+The global matrices are stored on rank 0, so this is only feasible for small matrices.
+
+@param c_out local tile of the calculated result matrix
+@param settings The program settings containing the torus configuration
+@param alpha scalar value used to scale A * B
+@param beta scalar value used to scale C
+@return the maximum absolute error of the result on rank 0 and 0 on all other ranks
+*/
+double gathered_gemm_residual(HOST_DATA_TYPE* c_out, GEMMProgramSettings const& settings, HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta);
+#endif
+
 } // namespace gemm
 
 
@@ -0,0 +1,301 @@
+/*
+Copyright (c) 2023 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* Related header files */
+#include "gemm_benchmark.hpp"
+
+/* C++ standard library headers */
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+/* External library headers */
+#ifdef _OPENMP
+#include "omp.h"
+#endif
+#ifdef __F16C__
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Number of rows of C that are calculated by a single call of the microkernel
+ *
+ */
+#define HOST_MM_MR 6
+
+/**
+ * @brief Size of the vectors in bytes that are used for a row of the microkernel.
+ *          The number of columns calculated by the microkernel is this size divided by the size of the data type.
+ *
+ */
+#define HOST_MM_NR_BYTES 64
+
+/**
+ * @brief Number of rows of A that are packed into a panel by a single thread. Has to be a multiple of HOST_MM_MR.
+ *          The packed panel should fit into the L2 cache.
+ *
+ */
+#define HOST_MM_MC 96
+
+/**
+ * @brief Number of columns of A and rows of B that are packed at once
+ *
+ */
+#define HOST_MM_KC 256
+
+/**
+ * @brief Number of columns of B that are packed at once and shared by all threads.
+ *          The packed panel should fit into the L3 cache.
+ *
+ */
+#define HOST_MM_NC 2048
+
+namespace {
+
+/**
+ * @brief Calculate a HOST_MM_MR x NR block of C from packed panels of A and B.
+ *          The accumulators are kept in registers and only the valid part of the block is added to C.
+ *
+ * @tparam T The data type used for the calculation
+ * @param kc Number of columns of the panel of A
+ * @param a_panel The packed panel of A in the format [kc][HOST_MM_MR]
+ * @param b_panel The packed panel of B in the format [kc][NR]
+ * @param c Pointer to the first value of the block in C
+ * @param ldc Leading dimension of C
+ * @param mr Number of valid rows of the block
+ * @param nr Number of valid columns of the block
+ */
+template<typename T>
+void
+microkernel(int kc, const T* __restrict__ a_panel, const T* __restrict__ b_panel, T* c, int ldc, int mr, int nr) {
+    constexpr int NR = HOST_MM_NR_BYTES / sizeof(T);
+    T acc[HOST_MM_MR][NR] = {};
+    for (int k = 0; k < kc; k++) {
+        for (int i = 0; i < HOST_MM_MR; i++) {
+            T a_value = a_panel[k * HOST_MM_MR + i];
+            #pragma omp simd
+            for (int j = 0; j < NR; j++) {
+                acc[i][j] += a_value * b_panel[k * NR + j];
+            }
+        }
+    }
+    if (mr == HOST_MM_MR && nr == NR) {
+        for (int i = 0; i < HOST_MM_MR; i++) {
+            #pragma omp simd
+            for (int j = 0; j < NR; j++) {
+                c[i * ldc + j] += acc[i][j];
+            }
+        }
+    }
+    else {
+        for (int i = 0; i < mr; i++) {
+            for (int j = 0; j < nr; j++) {
+                c[i * ldc + j] += acc[i][j];
+            }
+        }
+    }
+}
+
+/**
+ * @brief Calculate C = alpha * A * B + beta * C for row-major matrices with a packed and cache-blocked algorithm.
+ *          A block of B is packed into panels of NR columns that are shared by all threads.
+ *          Every thread packs blocks of A scaled by alpha into panels of HOST_MM_MR rows and calculates the
+ *          matching macro-tile of C with the microkernel.
+ *
+ * @tparam T The data type used for the calculation
+ */
+template<typename T>
+void
+gemm_packed_impl(const T* a, const T* b, T* c, int m, int n, int k, int lda, int ldb, int ldc, T alpha, T beta) {
+    constexpr int NR = HOST_MM_NR_BYTES / sizeof(T);
+    int nc_max = std::min(HOST_MM_NC, (n + NR - 1) / NR * NR);
+    int kc_max = std::min(HOST_MM_KC, k);
+    std::vector<T> b_packed(static_cast<size_t>(nc_max) * kc_max);
+
+    #pragma omp parallel
+    {
+        std::vector<T> a_packed(static_cast<size_t>(HOST_MM_MC) * kc_max);
+
+        #pragma omp for
+        for (int i = 0; i < m; i++) {
+            for (int j = 0; j < n; j++) {
+                c[static_cast<size_t>(i) * ldc + j] *= beta;
+            }
+        }
+
+        for (int jc = 0; jc < n; jc += HOST_MM_NC) {
+            int nc = std::min(HOST_MM_NC, n - jc);
+            for (int pc = 0; pc < k; pc += HOST_MM_KC) {
+                int kc = std::min(HOST_MM_KC, k - pc);
+
+                // Pack the block of B into panels of NR columns padded with zeros
+                #pragma omp for
+                for (int jr = 0; jr < nc; jr += NR) {
+                    int nr = std::min(NR, nc - jr);
+                    T* panel = b_packed.data() + static_cast<size_t>(jr) * kc;
+                    for (int p = 0; p < kc; p++) {
+                        const T* b_row = b + static_cast<size_t>(pc + p) * ldb + jc + jr;
+                        for (int j = 0; j < nr; j++) {
+                            panel[p * NR + j] = b_row[j];
+                        }
+                        for (int j = nr; j < NR; j++) {
+                            panel[p * NR + j] = T(0);
+                        }
+                    }
+                }
+
+                // Every thread calculates the macro-tiles of C for its own blocks of A
+                #pragma omp for schedule(dynamic)
+                for (int ic = 0; ic < m; ic += HOST_MM_MC) {
+                    int mc = std::min(HOST_MM_MC, m - ic);
+                    for (int ir = 0; ir < mc; ir += HOST_MM_MR) {
+                        int mr = std::min(HOST_MM_MR, mc - ir);
+                        T* panel = a_packed.data() + static_cast<size_t>(ir) * kc;
+                        for (int p = 0; p < kc; p++) {
+                            for (int i = 0; i < mr; i++) {
+                                panel[p * HOST_MM_MR + i] = alpha * a[static_cast<size_t>(ic + ir + i) * lda + pc + p];
+                            }
+                            for (int i = mr; i < HOST_MM_MR; i++) {
+                                panel[p * HOST_MM_MR + i] = T(0);
+                            }
+                        }
+                    }
+                    for (int jr = 0; jr < nc; jr += NR) {
+                        int nr = std::min(NR, nc - jr);
+                        for (int ir = 0; ir < mc; ir += HOST_MM_MR) {
+                            int mr = std::min(HOST_MM_MR, mc - ir);
+                            microkernel<T>(kc, a_packed.data() + static_cast<size_t>(ir) * kc,
+                                            b_packed.data() + static_cast<size_t>(jr) * kc,
+                                            c + static_cast<size_t>(ic + ir) * ldc + jc + jr, ldc, mr, nr);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Convert half precision values to single precision using F16C instructions, if available
+ *
+ * @param in The half precision input values
+ * @param out The single precision output values
+ * @param count Number of values to convert
+ */
+void
+halfToFloat(const half_float::half* in, float* out, size_t count) {
+    #pragma omp parallel for
+    for (size_t block = 0; block < count; block += 8) {
+        size_t i = block;
+#ifdef __F16C__
+        if (i + 8 <= count) {
+            __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            _mm256_storeu_ps(out + i, _mm256_cvtph_ps(h));
+            continue;
+        }
+#endif
+        for (; i < std::min(block + 8, count); i++) {
+            out[i] = half_float::half_cast<float, half_float::half>(in[i]);
+        }
+    }
+}
+
+/**
+ * @brief Convert single precision values to half precision using F16C instructions, if available
+ *
+ * @param in The single precision input values
+ * @param out The half precision output values
+ * @param count Number of values to convert
+ */
+void
+floatToHalf(const float* in, half_float::half* out, size_t count) {
+    #pragma omp parallel for
+    for (size_t block = 0; block < count; block += 8) {
+        size_t i = block;
+#ifdef __F16C__
+        if (i + 8 <= count) {
+            __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), h);
+            continue;
+        }
+#endif
+        for (; i < std::min(block + 8, count); i++) {
+            out[i] = half_float::half_cast<half_float::half, float>(in[i]);
+        }
+    }
+}
+
+/**
+ * @brief Half precision matrices are converted to single precision and multiplied in single precision
+ *
+ */
+void
+gemm_packed_impl(const half_float::half* a, const half_float::half* b, half_float::half* c, int m, int n, int k,
+                    int lda, int ldb, int ldc, half_float::half alpha, half_float::half beta) {
+    std::vector<float> a_sp(static_cast<size_t>(m) * lda);
+    std::vector<float> b_sp(static_cast<size_t>(k) * ldb);
+    std::vector<float> c_sp(static_cast<size_t>(m) * ldc);
+    halfToFloat(a, a_sp.data(), a_sp.size());
+    halfToFloat(b, b_sp.data(), b_sp.size());
+    halfToFloat(c, c_sp.data(), c_sp.size());
+    gemm_packed_impl<float>(a_sp.data(), b_sp.data(), c_sp.data(), m, n, k, lda, ldb, ldc,
+                            half_float::half_cast<float, half_float::half>(alpha),
+                            half_float::half_cast<float, half_float::half>(beta));
+    floatToHalf(c_sp.data(), c, c_sp.size());
+}
+
+}  // namespace
+
+void
+gemm::gemm_packed(HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, HOST_DATA_TYPE* c,
+                    int n, HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta) {
+    gemm_packed_impl(a, b, c, n, n, n, n, n, n, alpha, beta);
+}
+
+void
+gemm::gemm_packed(HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, HOST_DATA_TYPE* c,
+                    int m, int n, int k, HOST_DATA_TYPE alpha, HOST_DATA_TYPE beta) {
+    gemm_packed_impl(a, b, c, m, n, k, k, n, n, alpha, beta);
+}
+
+#ifdef MIXED_PRECISION_INPUTS
+void
+gemm::convertToInputType(const HOST_DATA_TYPE* in, HOST_INPUT_DATA_TYPE* out, size_t count) {
+#ifdef INPUT_DATA_TYPE_HALF
+    floatToHalf(in, reinterpret_cast<half_float::half*>(out), count);
+#else
+    // bfloat16 values are the upper 16 bits of the single precision values.
+    // The lower bits are rounded to the nearest even value with integer operations, which are vectorized by the compiler
+    #pragma omp parallel for simd
+    for (size_t i = 0; i < count; i++) {
+        uint32_t bits;
+        std::memcpy(&bits, &in[i], sizeof(bits));
+        uint32_t rounded = (bits + 0x7FFFu + ((bits >> 16) & 1u)) >> 16;
+        // Keep NaNs quiet, since rounding may turn them into infinity
+        bool is_nan = (bits & 0x7FFFFFFFu) > 0x7F800000u;
+        out[i] = static_cast<HOST_INPUT_DATA_TYPE>(is_nan ? ((bits >> 16) | 0x40u) : rounded);
+    }
+#endif
+}
+#endif
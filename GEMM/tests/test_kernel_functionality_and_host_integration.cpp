@@ -1,7 +1,9 @@
 //
 // Created by Marius Meyer on 04.12.19.
 //
+#include <cmath>
 #include <memory>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "gemm_benchmark.hpp"
@@ -180,6 +182,179 @@ TEST_P(GEMMKernelTest, FPGACorrectbetaCplusalphaAB) {
     }
 }
 
+/**
+ * Tests if the probabilistic validation accepts the correct result and detects a single wrong value
+ */
+TEST_P(GEMMKernelTest, FPGAProbabilisticValidationDetectsErrors) {
+    bm->getExecutionSettings().programSettings->validationVectors = 4;
+    bm->executeKernel(*data);
+    EXPECT_TRUE(bm->validateOutput(*data));
+    data->C_out[matrix_size + 1] += OPTIONAL_CAST(1.0);
+    EXPECT_FALSE(bm->validateOutput(*data));
+}
+
+/**
+ * Tests if the out-of-core execution with super-tiles of a single block calculates the correct result
+ */
+TEST_P(GEMMKernelTest, FPGAStreamingExecutionIsCorrect) {
+    bm->getExecutionSettings().programSettings->streamTileSize = 1;
+    bm->getExecutionSettings().programSettings->numRepetitions = 1;
+    bm->executeKernel(*data);
+    EXPECT_EQ(bm->getTimingsMap().at("execution").size(), 1);
+    EXPECT_EQ(bm->getTimingsMap().at("transfer").size(), 1);
+    EXPECT_TRUE(bm->validateOutput(*data));
+}
+
+/**
+ * Tests if the batched execution calculates the correct results for all matrices of the batch
+ */
+TEST_P(GEMMKernelTest, FPGABatchedExecutionIsCorrect) {
+    bm->getExecutionSettings().programSettings->batchSize = 3;
+    bm->getExecutionSettings().programSettings->numRepetitions = 1;
+    data = bm->generateInputData();
+    bm->executeKernel(*data);
+    EXPECT_EQ(bm->getTimingsMap().at("matrix").size(), 1);
+    EXPECT_EQ(bm->getTimingsMap().at("latency").size(), 1);
+    EXPECT_TRUE(bm->validateOutput(*data));
+}
+
+/**
+ * Tests if matrices with a rectangular shape that is not a multiple of the block size are calculated correctly
+ */
+TEST_P(GEMMKernelTest, FPGARectangularShapeIsCorrect) {
+    auto& settings = *bm->getExecutionSettings().programSettings;
+    settings.matrixM = matrix_size + 1;
+    settings.matrixN = matrix_size / 2 + 1;
+    settings.matrixK = 2 * matrix_size - 1;
+    settings.numRepetitions = 1;
+    data = bm->generateInputData();
+    bm->executeKernel(*data);
+    EXPECT_TRUE(bm->validateOutput(*data));
+    bm->collectResults();
+    auto results = bm->getResultsJson();
+    EXPECT_TRUE(results.contains("padding_efficiency"));
+    if (results.contains("padding_efficiency")) {
+        EXPECT_LT(results["padding_efficiency"]["value"].get<double>(), 1.0);
+    }
+}
+
+/**
+ * Tests if valid matrix shapes are parsed and invalid shapes are rejected
+ */
+TEST(GEMMHostTest, MatrixShapeParsingRejectsInvalidShapes) {
+    uint m = 0, n = 0, k = 0;
+    gemm::parseMatrixShape("4x8x16", m, n, k);
+    EXPECT_EQ(m, 4u);
+    EXPECT_EQ(n, 8u);
+    EXPECT_EQ(k, 16u);
+    for (std::string shape : {"-4x8x8", "0x8x8", "4x8", "4x8x8x8", "4x8x8abc", "4,8,8", "4xx8", " 4x8x8", "4x8x99999999999"}) {
+        EXPECT_THROW(gemm::parseMatrixShape(shape, m, n, k), std::runtime_error) << shape;
+    }
+}
+
+/**
+ * Tests if the packed host implementation calculates the same result as a simple loop for sizes that are not a multiple of the blocking
+ */
+TEST(GEMMHostTest, PackedGEMMMatchesSimpleLoop) {
+    const int size = 67;
+    std::unique_ptr<HOST_DATA_TYPE[]> a(new HOST_DATA_TYPE[size * size]);
+    std::unique_ptr<HOST_DATA_TYPE[]> b(new HOST_DATA_TYPE[size * size]);
+    std::unique_ptr<HOST_DATA_TYPE[]> c(new HOST_DATA_TYPE[size * size]);
+    std::unique_ptr<double[]> c_ref(new double[size * size]);
+    for (int i = 0; i < size * size; i++) {
+        a[i] = OPTIONAL_CAST((i % 7) * 0.25);
+        b[i] = OPTIONAL_CAST((i % 5) * 0.5);
+        c[i] = OPTIONAL_CAST((i % 3) * 1.0);
+    }
+    for (int i = 0; i < size; i++) {
+        for (int j = 0; j < size; j++) {
+            double sum = 0.0;
+            for (int k = 0; k < size; k++) {
+                sum += static_cast<double>(a[i * size + k]) * static_cast<double>(b[k * size + j]);
+            }
+            c_ref[i * size + j] = 0.5 * sum + 2.0 * static_cast<double>(c[i * size + j]);
+        }
+    }
+    gemm::gemm_packed(a.get(), b.get(), c.get(), size, OPTIONAL_CAST(0.5), OPTIONAL_CAST(2.0));
+    for (int i = 0; i < size * size; i++) {
+        EXPECT_NEAR(static_cast<double>(c[i]), c_ref[i], std::numeric_limits<HOST_DATA_TYPE>::epsilon() * size * std::abs(c_ref[i]));
+    }
+}
+
+/**
+ * Tests if the memory plan uses one allocation per matrix, shares the inputs if the replicas would be in the same memory,
+ * and places the results of all replications in separate regions of a single allocation
+ */
+TEST(GEMMHostTest, MemoryPlanSharesBuffers) {
+    const uint block_size = 8;
+    const uint size = 5 * block_size;
+    size_t matrix_bytes = sizeof(HOST_DATA_TYPE) * size * size;
+    size_t input_bytes = sizeof(HOST_INPUT_DATA_TYPE) * size * size;
+    size_t out_bytes = sizeof(HOST_DATA_TYPE) * size * 3 * block_size;
+
+    // The replicas of the inputs would be located in the same memory, so they are only stored once
+    auto plan = gemm::planDeviceMemory(size, size, size, block_size, 2, true, gemm::GEMMPlacement::interleaved, 64);
+    ASSERT_EQ(plan.allocationBytes.size(), 4);
+    EXPECT_EQ(plan.allocationBytes[0], input_bytes);
+    EXPECT_EQ(plan.allocationBytes[1], input_bytes);
+    EXPECT_EQ(plan.allocationBytes[2], matrix_bytes);
+    EXPECT_EQ(plan.a[0], plan.a[1]);
+    EXPECT_EQ(plan.c[0], plan.c[1]);
+    // The second replication only calculates the remaining two block rows
+    EXPECT_EQ(plan.out[0].bytes, out_bytes);
+    EXPECT_EQ(plan.out[1].bytes, matrix_bytes - out_bytes);
+    EXPECT_EQ(plan.out[1].offset % 64, 0);
+    EXPECT_GE(plan.out[1].offset, plan.out[0].offset + plan.out[0].bytes);
+    EXPECT_EQ(plan.allocationBytes[3], plan.out[1].offset + plan.out[1].bytes);
+    // The kernel accesses C and the result as restrict pointers, so they must not share an allocation
+    for (auto const& out : plan.out) {
+        EXPECT_NE(out.allocation, plan.c[0].allocation);
+    }
+
+    // Replications without any block reuse the location of the first replication
+    plan = gemm::planDeviceMemory(size, size, size, block_size, 8, false, gemm::GEMMPlacement::banks, 64);
+    ASSERT_EQ(plan.allocationBytes.size(), 4);
+    EXPECT_EQ(plan.allocationBanks[3], 4);
+    EXPECT_EQ(plan.out[7], plan.out[0]);
+
+    // If the kernel selects the memory banks, every replica needs its own allocation
+    plan = gemm::planDeviceMemory(size, size, size, block_size, 2, true, gemm::GEMMPlacement::kernel, 64);
+    EXPECT_EQ(plan.allocationBytes.size(), 8);
+    EXPECT_NE(plan.a[0], plan.a[1]);
+    plan = gemm::planDeviceMemory(size, size, size, block_size, 2, false, gemm::GEMMPlacement::kernel, 64);
+    EXPECT_EQ(plan.allocationBytes.size(), 5);
+    EXPECT_EQ(plan.c[0], plan.c[1]);
+}
+
+#ifdef MIXED_PRECISION_INPUTS
+/**
+ * Tests if the conversion to the reduced precision inputs rounds to the nearest even value
+ */
+TEST(GEMMHostTest, InputConversionRoundsToNearestEven) {
+#ifdef INPUT_DATA_TYPE_BFLOAT16
+    // bfloat16 has 7 bits in the mantissa
+    std::vector<HOST_DATA_TYPE> base_values = {1.0f, 1.0f + std::ldexp(1.0f, -8), 1.0f + 3 * std::ldexp(1.0f, -8), -2.0f};
+    std::vector<HOST_INPUT_DATA_TYPE> base_expected = {0x3F80, 0x3F80, 0x3F82, 0xC000};
+#else
+    // half precision has 10 bits in the mantissa
+    std::vector<HOST_DATA_TYPE> base_values = {1.0f, 1.0f + std::ldexp(1.0f, -11), 1.0f + 3 * std::ldexp(1.0f, -11), -2.0f};
+    std::vector<HOST_INPUT_DATA_TYPE> base_expected = {0x3C00, 0x3C00, 0x3C02, 0xC000};
+#endif
+    // Repeat the values to also test the vectorized conversion
+    std::vector<HOST_DATA_TYPE> values;
+    std::vector<HOST_INPUT_DATA_TYPE> expected;
+    for (int i = 0; i < 5; i++) {
+        values.insert(values.end(), base_values.begin(), base_values.end());
+        expected.insert(expected.end(), base_expected.begin(), base_expected.end());
+    }
+    std::vector<HOST_INPUT_DATA_TYPE> converted(values.size());
+    gemm::convertToInputType(values.data(), converted.data(), values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+        EXPECT_EQ(converted[i], expected[i]);
+    }
+}
+#endif
+
 using json = nlohmann::json;
 
 TEST_P(GEMMKernelTest, JsonDump) {
@@ -29,6 +29,7 @@ SOFTWARE.
 #include <vector>
 #include <list>
 #include <thread>
+#include <stdexcept>
 
 /* External library headers */
 #if QUARTUS_MAJOR_VERSION > 18
@@ -56,6 +57,14 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings, cl
 
     cl_int err;
 
+    // MPI is called from different OpenMP threads below. All of these calls are placed in omp single constructs
+    // that end with an implicit barrier, so they are serialized.
+    int mpi_thread_support;
+    MPI_Query_thread(&mpi_thread_support);
+    if (mpi_thread_support < MPI_THREAD_SERIALIZED) {
+        throw std::runtime_error("The PCIe execution requires MPI to be initialized with at least MPI_THREAD_SERIALIZED!");
+    }
+
     int num_omp_threads = 1;
 #ifdef _OPENMP
     num_omp_threads = omp_get_num_threads();
@@ -166,6 +175,11 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings, cl
 
 
         int kernel_offset = 0;
+        // Requests of the non-blocking broadcasts. They are shared by all threads, but only used within single sections.
+        // A request may be completed by a different thread than the one that started it.
+        MPI_Request lu_requests[2];
+        std::vector<MPI_Request> block_requests;
+        int num_left_requests = 0;
         #pragma omp parallel
         {
 
@@ -207,6 +221,13 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings, cl
             #pragma omp single
             {
 
+            if (config.programSettings->lookAhead == 0 && block_row > 0) {
+                // Without look-ahead, the LU, top and left updates additionally wait for the trailing updates
+                // of the previous block row and are not overlapped with them
+                auto& panel_events = *std::prev(std::prev(all_events.end()));
+                panel_events.insert(panel_events.end(), all_events.back().begin(), all_events.back().end());
+            }
+
             // Create Command queues
             lu_queues.emplace_back(*config.context, *config.device, 0, &err);
             ASSERT_CL(err)
@@ -249,9 +270,9 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings, cl
             lu_queues.back().finish();
 
             // Broadcast LU block in column to update all left blocks
-            MPI_Bcast(lu_block, config.programSettings->blockSize*config.programSettings->blockSize, MPI_DATA_TYPE, local_block_row_remainder, col_communicator);
+            MPI_Ibcast(lu_block, config.programSettings->blockSize*config.programSettings->blockSize, MPI_DATA_TYPE, local_block_row_remainder, col_communicator, &lu_requests[0]);
             // Broadcast LU block in row to update all top blocks
-            MPI_Bcast(lu_trans_block, config.programSettings->blockSize*config.programSettings->blockSize, MPI_DATA_TYPE, local_block_col_remainder, row_communicator);
+            MPI_Ibcast(lu_trans_block, config.programSettings->blockSize*config.programSettings->blockSize, MPI_DATA_TYPE, local_block_col_remainder, row_communicator, &lu_requests[1]);
            }
 
             if (num_top_blocks > 0) {
@@ -259,6 +280,8 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings, cl
                 #pragma omp single
                 {
                 cl::Event write_lu_trans_done;
+                // The top updates can already start while the LU block is still broadcast within the column
+                MPI_Wait(&lu_requests[1], MPI_STATUS_IGNORE);
                 // Copy LU block to FPGA for calulation of top blocks only if required
                 err = top_queues.back().enqueueWriteBuffer(Buffer_lu1, CL_FALSE, 0, sizeof(HOST_DATA_TYPE)*config.programSettings->blockSize * (config.programSettings->blockSize), lu_trans_block, NULL, &write_lu_trans_done);
                 ASSERT_CL(err)
@@ -304,6 +327,7 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings, cl
                 #pragma omp single
                 {
                 cl::Event write_lu_done;
+                MPI_Wait(&lu_requests[0], MPI_STATUS_IGNORE);
                 // Copy LU block to FPGA for calulation of left blocks only if required
                 err = left_queues.back().enqueueWriteBuffer(Buffer_lu2, CL_FALSE, 0, sizeof(HOST_DATA_TYPE)*config.programSettings->blockSize * (config.programSettings->blockSize), lu_block, NULL, &write_lu_done);
                 ASSERT_CL(err)
@@ -347,16 +371,22 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings, cl
 
             #pragma omp single
             {
-            // Wait until all top and left blocks are calculated
-            top_queues.back().finish();
-            left_queues.back().finish();
+            // Complete the LU broadcasts also on ranks that do not calculate top or left blocks
+            MPI_Waitall(2, lu_requests, MPI_STATUSES_IGNORE);
 
-            // Send the left and top blocks to all other ranks so they can be used to update all inner blocks
+            // Send the left and top blocks to all other ranks so they can be used to update all inner blocks.
+            // The broadcasts of the left blocks are already started while the top blocks are still calculated
+            block_requests.clear();
+            left_queues.back().finish();
             for (int lbi=0; lbi < std::max(static_cast<int>(blocks_per_col - local_block_col), 0); lbi++) {
-                MPI_Bcast(left_blocks[lbi], config.programSettings->blockSize*config.programSettings->blockSize, MPI_DATA_TYPE, local_block_col_remainder, row_communicator);
+                block_requests.emplace_back();
+                MPI_Ibcast(left_blocks[lbi], config.programSettings->blockSize*config.programSettings->blockSize, MPI_DATA_TYPE, local_block_col_remainder, row_communicator, &block_requests.back());
             }
+            num_left_requests = block_requests.size();
+            top_queues.back().finish();
             for (int tbi=0; tbi < std::max(static_cast<int>(blocks_per_row  - local_block_row), 0); tbi++) {
-                MPI_Bcast(top_blocks[tbi], config.programSettings->blockSize*config.programSettings->blockSize, MPI_DATA_TYPE, local_block_row_remainder, col_communicator);
+                block_requests.emplace_back();
+                MPI_Ibcast(top_blocks[tbi], config.programSettings->blockSize*config.programSettings->blockSize, MPI_DATA_TYPE, local_block_row_remainder, col_communicator, &block_requests.back());
             }
 
             // update all remaining inner blocks using only global memory
@@ -368,16 +398,39 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings, cl
             
             cl::CommandQueue buffer_transfer_queue(*config.context, *config.device, 0, &err);
 
-            // Write all left and top blocks to FPGA memory
             for (int lbi=0; lbi < num_inner_block_rows; lbi++) {
                 left_buffers.back().emplace_back(*config.context, CL_MEM_READ_ONLY,
                                         sizeof(HOST_DATA_TYPE)*config.programSettings->blockSize * (config.programSettings->blockSize));
-                err = buffer_transfer_queue.enqueueWriteBuffer(left_buffers.back().back(), CL_FALSE, 0, sizeof(HOST_DATA_TYPE)*config.programSettings->blockSize * (config.programSettings->blockSize), left_blocks[lbi]);
             }
             for (int tbi=0; tbi < num_inner_block_cols; tbi++) {
                 top_buffers.back().emplace_back(*config.context, CL_MEM_READ_ONLY,
                         sizeof(HOST_DATA_TYPE)*config.programSettings->blockSize * config.programSettings->blockSize);
-                err = buffer_transfer_queue.enqueueWriteBuffer(top_buffers.back().back(), CL_FALSE, 0, sizeof(HOST_DATA_TYPE)*config.programSettings->blockSize * (config.programSettings->blockSize), top_blocks[tbi]);
+            }
+
+            // Write the left and top blocks to FPGA memory in the order they are received, so the transfers overlap with
+            // the remaining broadcasts
+            for (int r=0; r < block_requests.size(); r++) {
+                int request_index;
+                MPI_Waitany(block_requests.size(), block_requests.data(), &request_index, MPI_STATUS_IGNORE);
+                if (request_index < num_left_requests) {
+                    if (request_index < num_inner_block_rows) {
+                        err = buffer_transfer_queue.enqueueWriteBuffer(left_buffers.back()[request_index], CL_FALSE, 0, sizeof(HOST_DATA_TYPE)*config.programSettings->blockSize * (config.programSettings->blockSize), left_blocks[request_index]);
+                        ASSERT_CL(err)
+                    }
+                }
+                else if (request_index - num_left_requests < num_inner_block_cols) {
+                    err = buffer_transfer_queue.enqueueWriteBuffer(top_buffers.back()[request_index - num_left_requests], CL_FALSE, 0, sizeof(HOST_DATA_TYPE)*config.programSettings->blockSize * (config.programSettings->blockSize), top_blocks[request_index - num_left_requests]);
+                    ASSERT_CL(err)
+                }
+            }
+            // Write the remaining blocks that are not received in this block row
+            for (int lbi=num_left_requests; lbi < num_inner_block_rows; lbi++) {
+                err = buffer_transfer_queue.enqueueWriteBuffer(left_buffers.back()[lbi], CL_FALSE, 0, sizeof(HOST_DATA_TYPE)*config.programSettings->blockSize * (config.programSettings->blockSize), left_blocks[lbi]);
+                ASSERT_CL(err)
+            }
+            for (int tbi=block_requests.size() - num_left_requests; tbi < num_inner_block_cols; tbi++) {
+                err = buffer_transfer_queue.enqueueWriteBuffer(top_buffers.back()[tbi], CL_FALSE, 0, sizeof(HOST_DATA_TYPE)*config.programSettings->blockSize * (config.programSettings->blockSize), top_blocks[tbi]);
+                ASSERT_CL(err)
             }
 
             kernel_offset = kernels.back().size();
@@ -596,6 +649,7 @@ calculate(const hpcc_base::ExecutionSettings<linpack::LinpackProgramSettings, cl
 #endif
 
 #ifndef NDEBUG
+            #pragma omp single
             MPI_Barrier(MPI_COMM_WORLD);
             if (is_calulating_lu_block) std::cout << "---------------" << std::endl;
 
@@ -24,6 +24,7 @@ SOFTWARE.
 #define SRC_HOST_LINPACK_BENCHMARK_H_
 
 /* C++ standard library headers */
+#include <chrono>
 #include <complex>
 #include <memory>
 #include <random>
@@ -52,6 +53,18 @@ class LinpackBenchmark : public hpcc_base::HpccFpgaBenchmark<LinpackProgramSetti
 
 protected:
 
+    /**
+     * @brief The local part of the solution refined to double precision in the mixed-precision mode
+     * 
+     */
+    std::vector<double> refined_solution;
+
+    /**
+     * @brief Number of GMRES iterations of the last refinement in the mixed-precision mode
+     * 
+     */
+    uint gmres_iterations = 0;
+
     /**
      * @brief Additional input parameters of the Linpack benchmark
      * 
@@ -66,120 +79,157 @@ protected:
             cxxopts::value<uint>()->default_value(std::to_string(LOCAL_MEM_BLOCK_LOG)))
         ("p", "Width of the FPGA grid. The heigth (Q) will be calculated from mpi_size / P.",
             cxxopts::value<uint>()->default_value(std::to_string(DEFAULT_P_VALUE)))
+        ("look-ahead", "Look-ahead depth used by the PCIe execution. With 1, the next diagonal block is factorized while the trailing updates of the current block row are still running. Can be 0 or 1.",
+            cxxopts::value<uint>()->default_value(std::to_string(DEFAULT_LOOK_AHEAD)))
         ("uniform", "Generate a uniform matrix instead of a diagonally dominant. This has to be supported by the FPGA kernel!")
-        ("emulation", "Use kernel arguments for emulation. This may be necessary to simulate persistent local memory on the FPGA");
+        ("emulation", "Use kernel arguments for emulation. This may be necessary to simulate persistent local memory on the FPGA")
+        ("mxp", "Run the mixed-precision benchmark following HPL-MxP. The LU factorization is calculated in the FPGA data type and the solution is refined to double precision with GMRES on the host");
     }
 
     /**
-     * @brief Distributed solving of l*y=b and u*x = y 
+     * @brief Distributed solving of l*y=b and u*x = y using a blocked triangular solve.
+     *          The solution of a block is calculated on the rank holding the diagonal block and broadcast as a whole
+     *          segment within its torus row. The partial updates of the next block are reduced within the torus column
+     *          with non-blocking collectives, while the remaining blocks are updated locally.
      * 
      * @param data The local data. b will contain the solution for the unknows that were handeled by this rank
+     * @param row_communicator Communicator of all ranks in the same torus row
+     * @param col_communicator Communicator of all ranks in the same torus column
      */
     void 
-    distributed_gesl_nopvt_ref(linpack::LinpackData<TContext>& data) {
+    distributed_gesl_nopvt_ref(linpack::LinpackData<TContext>& data, MPI_Comm row_communicator, MPI_Comm col_communicator) {
     uint global_matrix_size = this->executionSettings->programSettings->matrixSize;
     uint matrix_width = data.matrix_width;
-    uint matrix_height = data.matrix_height;
     uint block_size = this->executionSettings->programSettings->blockSize;
-    // create a communicator to exchange the rows
-    MPI_Comm row_communicator;
-    MPI_Comm_split(MPI_COMM_WORLD, this->executionSettings->programSettings->torus_row, 0,&row_communicator);
-    MPI_Comm col_communicator;
-    MPI_Comm_split(MPI_COMM_WORLD, this->executionSettings->programSettings->torus_col, 0,&col_communicator);
-    std::vector<HOST_DATA_TYPE> b_tmp(matrix_width);
-
-    for (int k = 0; k < b_tmp.size(); k++) {
-        b_tmp[k] = data.b[k];
-    }
+    int torus_row = this->executionSettings->programSettings->torus_row;
+    int torus_col = this->executionSettings->programSettings->torus_col;
+    int torus_width = this->executionSettings->programSettings->torus_width;
+    int torus_height = this->executionSettings->programSettings->torus_height;
+    int num_blocks = global_matrix_size / block_size;
+    int local_blocks = matrix_width / block_size;
+
+    // Partial updates of the local segments of b from the blocks that are already solved
+    std::vector<HOST_DATA_TYPE> update(matrix_width);
+    // Solved segment of the current block and the reduced updates of the next block on the diagonal rank
+    std::vector<HOST_DATA_TYPE> segment(block_size);
+    std::vector<HOST_DATA_TYPE> reduced_update(block_size);
+    MPI_Request reduce_request = MPI_REQUEST_NULL;
+    std::vector<MPI_Request> replication_requests;
+
+    // Offsets of a block of b in the local b and of a block column of A in the local matrix.
+    // The matrix is stored transposed, so the local rows of data.A are the columns of A
+    auto b_offset = [&](int block) { return (block / torus_width) * block_size; };
+    auto a_offset = [&](int block) { return (block / torus_height) * block_size; };
+
+    // Sum up the partial updates of a block of b on the rank that holds the diagonal block
+    auto start_reduction = [&](int block) {
+        if (block % torus_width == torus_col) {
+            MPI_Ireduce(&update[b_offset(block)], reduced_update.data(), block_size, MPI_DATA_TYPE, MPI_SUM,
+                        block % torus_height, col_communicator, &reduce_request);
+        }
+    };
+
+    // Add the product of the local block (block_row, block_col) of A with the solved segment to the updates
+    auto update_block = [&](int block_row, int block_col, HOST_DATA_TYPE sign) {
+        const HOST_DATA_TYPE* a = &data.A[static_cast<size_t>(matrix_width) * a_offset(block_col) + b_offset(block_row)];
+        HOST_DATA_TYPE* u = &update[b_offset(block_row)];
+        for (int k = 0; k < block_size; k++) {
+            HOST_DATA_TYPE scale = sign * segment[k];
+            #pragma omp simd
+            for (int i = 0; i < block_size; i++) {
+                u[i] += scale * a[static_cast<size_t>(matrix_width) * k + i];
+            }
+        }
+    };
 
     // solve l*y = b
-    // For each row in matrix
-    for (int k = 0; k < global_matrix_size - 1; k++) {
-        size_t local_k_index_col =  k / (block_size * this->executionSettings->programSettings->torus_width) * block_size;
-        size_t local_k_index_row =  k / (block_size * this->executionSettings->programSettings->torus_height) * block_size;
-        size_t remaining_k_col = k % (block_size * this->executionSettings->programSettings->torus_width);
-        size_t remaining_k_row = k % (block_size * this->executionSettings->programSettings->torus_height);
-        size_t start_offset = local_k_index_col;
-        if (remaining_k_col / block_size > this->executionSettings->programSettings->torus_col){
-            local_k_index_col += block_size;
-            start_offset = local_k_index_col;
-        }
-        else if (remaining_k_col / block_size == this->executionSettings->programSettings->torus_col) {
-            local_k_index_col += (remaining_k_col % block_size);
-            start_offset = local_k_index_col + 1;
-        }
-        if (remaining_k_row / block_size > this->executionSettings->programSettings->torus_row){
-            local_k_index_row += block_size;
-        }
-        else if (remaining_k_row / block_size == this->executionSettings->programSettings->torus_row) {
-            local_k_index_row += (remaining_k_row % block_size);
-        }
-
-        int row_diagonal_rank = (k / block_size) % this->executionSettings->programSettings->torus_height;
-        int col_diagonal_rank = (k / block_size) % this->executionSettings->programSettings->torus_width;
-        std::vector<HOST_DATA_TYPE> tmp_scaled_b(matrix_width, 0.0);
-        if (row_diagonal_rank == this->executionSettings->programSettings->torus_row) {
-            HOST_DATA_TYPE current_k;
-            current_k = (local_k_index_col < matrix_width) ? b_tmp[local_k_index_col] : 0.0;
-            MPI_Bcast(&current_k, 1, MPI_DATA_TYPE,  col_diagonal_rank, row_communicator);
-            // For each row below add
-            for (int i = start_offset; i < matrix_width; i++) {
-                // add solved upper row to current row
-                tmp_scaled_b[i] = current_k * data.A[matrix_width * local_k_index_row + i];
+    std::fill(update.begin(), update.end(), 0.0);
+    start_reduction(0);
+    for (int block = 0; block < num_blocks; block++) {
+        int diagonal_row = block % torus_height;
+        int diagonal_col = block % torus_width;
+        MPI_Wait(&reduce_request, MPI_STATUS_IGNORE);
+        if (diagonal_row == torus_row && diagonal_col == torus_col) {
+            // Solve the lower triangular diagonal block with unit diagonal
+            const HOST_DATA_TYPE* a = &data.A[static_cast<size_t>(matrix_width) * a_offset(block) + b_offset(block)];
+            for (int i = 0; i < block_size; i++) {
+                segment[i] = data.b[b_offset(block) + i] + reduced_update[i];
+            }
+            for (int k = 0; k < block_size - 1; k++) {
+                for (int i = k + 1; i < block_size; i++) {
+                    segment[i] += segment[k] * a[static_cast<size_t>(matrix_width) * k + i];
+                }
             }
+            std::copy(segment.begin(), segment.end(), &data.b[b_offset(block)]);
+        }
+        if (diagonal_row == torus_row) {
+            MPI_Bcast(segment.data(), block_size, MPI_DATA_TYPE, diagonal_col, row_communicator);
+            // Update the next block first, so its reduction can overlap with the remaining updates
+            if (block + 1 < num_blocks && (block + 1) % torus_width == torus_col) {
+                update_block(block + 1, block, 1.0);
+            }
+        }
+        if (block + 1 < num_blocks) {
+            start_reduction(block + 1);
         }
-        MPI_Bcast(&tmp_scaled_b.data()[start_offset], matrix_width - start_offset, MPI_DATA_TYPE, row_diagonal_rank, col_communicator);
-        for (int i = start_offset; i < matrix_width; i++) {
-            // add solved upper row to current row
-            b_tmp[i] += tmp_scaled_b[i];
+        if (diagonal_row == torus_row) {
+            #pragma omp parallel for
+            for (int lb = 0; lb < local_blocks; lb++) {
+                int block_row = lb * torus_width + torus_col;
+                if (block_row > block + 1) {
+                    update_block(block_row, block, 1.0);
+                }
+            }
         }
     }
 
     // now solve  u*x = y
-    for (int k = global_matrix_size - 1; k >= 0; k--) {
-        size_t local_k_index_col =  k / (block_size * this->executionSettings->programSettings->torus_width) * block_size;
-        size_t local_k_index_row =  k / (block_size * this->executionSettings->programSettings->torus_height) * block_size;
-        size_t remaining_k_col = k % (block_size * this->executionSettings->programSettings->torus_width);
-        size_t remaining_k_row = k % (block_size * this->executionSettings->programSettings->torus_height);
-        if (remaining_k_col / block_size > this->executionSettings->programSettings->torus_col){
-            local_k_index_col += block_size;
-        }
-        else if (remaining_k_col / block_size == this->executionSettings->programSettings->torus_col) {
-            local_k_index_col += remaining_k_col % block_size;
-        }
-        if (remaining_k_row / block_size > this->executionSettings->programSettings->torus_row){
-            local_k_index_row += block_size;
-        }
-        else if (remaining_k_row / block_size == this->executionSettings->programSettings->torus_row) {
-            local_k_index_row += remaining_k_row % block_size;
-        }
-
-        HOST_DATA_TYPE scale_element = (local_k_index_col < matrix_width && local_k_index_row < matrix_height) ? b_tmp[local_k_index_col] * data.A[matrix_width * local_k_index_row + local_k_index_col] : 0.0;
-        int row_diagonal_rank = (k / block_size) % this->executionSettings->programSettings->torus_height;
-        int col_diagonal_rank = (k / block_size) % this->executionSettings->programSettings->torus_width;
-        MPI_Bcast(&scale_element, 1, MPI_DATA_TYPE, row_diagonal_rank, col_communicator);
-        if (col_diagonal_rank == this->executionSettings->programSettings->torus_col) {
-            b_tmp[local_k_index_col] = -scale_element;
-        }
-        MPI_Bcast(&scale_element, 1, MPI_DATA_TYPE, col_diagonal_rank, row_communicator);
-        size_t end_offset = local_k_index_col;
-
-        std::vector<HOST_DATA_TYPE> tmp_scaled_b(matrix_width, 0.0);
-        if (row_diagonal_rank == this->executionSettings->programSettings->torus_row) {
-            // For each row below add
-            for (int i = 0; i < end_offset; i++) {
-                tmp_scaled_b[i] = scale_element * data.A[matrix_width * local_k_index_row + i];
+    std::fill(update.begin(), update.end(), 0.0);
+    start_reduction(num_blocks - 1);
+    for (int block = num_blocks - 1; block >= 0; block--) {
+        int diagonal_row = block % torus_height;
+        int diagonal_col = block % torus_width;
+        MPI_Wait(&reduce_request, MPI_STATUS_IGNORE);
+        if (diagonal_row == torus_row && diagonal_col == torus_col) {
+            // Solve the upper triangular diagonal block. The diagonal contains the negative inverse of its elements
+            const HOST_DATA_TYPE* a = &data.A[static_cast<size_t>(matrix_width) * a_offset(block) + b_offset(block)];
+            for (int i = 0; i < block_size; i++) {
+                segment[i] = data.b[b_offset(block) + i] + reduced_update[i];
+            }
+            for (int k = block_size - 1; k >= 0; k--) {
+                HOST_DATA_TYPE scale = segment[k] * a[static_cast<size_t>(matrix_width) * k + k];
+                segment[k] = -scale;
+                for (int i = 0; i < k; i++) {
+                    segment[i] += scale * a[static_cast<size_t>(matrix_width) * k + i];
+                }
             }
+            std::copy(segment.begin(), segment.end(), &data.b[b_offset(block)]);
         }
-        MPI_Bcast(tmp_scaled_b.data(), end_offset, MPI_DATA_TYPE, row_diagonal_rank, col_communicator);
-        for (int i = 0; i < end_offset; i++) {
-            // add solved upper row to current row
-            b_tmp[i] += tmp_scaled_b[i];
+        if (diagonal_row == torus_row) {
+            MPI_Bcast(segment.data(), block_size, MPI_DATA_TYPE, diagonal_col, row_communicator);
+            if (block > 0 && (block - 1) % torus_width == torus_col) {
+                update_block(block - 1, block, -1.0);
+            }
+        }
+        if (block > 0) {
+            start_reduction(block - 1);
+        }
+        if (diagonal_row == torus_row) {
+            #pragma omp parallel for
+            for (int lb = 0; lb < local_blocks; lb++) {
+                int block_row = lb * torus_width + torus_col;
+                if (block_row < block - 1) {
+                    update_block(block_row, block, -1.0);
+                }
+            }
+        }
+        // Every rank of the torus column needs the solution of the block, but it is only required after the solve
+        if (diagonal_col == torus_col) {
+            replication_requests.emplace_back();
+            MPI_Ibcast(&data.b[b_offset(block)], block_size, MPI_DATA_TYPE, diagonal_row, col_communicator, &replication_requests.back());
         }
     }
-    for (int k = 0; k < b_tmp.size(); k++) {
-        data.b[k] = b_tmp[k];
-    }
+    MPI_Waitall(replication_requests.size(), replication_requests.data(), MPI_STATUSES_IGNORE);
 
 #ifndef NDEBUG
     MPI_Barrier(MPI_COMM_WORLD);
@@ -200,6 +250,207 @@ protected:
 #endif
 }
 
+    /**
+     * @brief Distributed restarted GMRES in double precision that refines the solution of the low precision LU factorization
+     *          as defined by HPL-MxP. The LU factors are used as left preconditioner by applying the distributed triangular solve.
+     *          Vectors are distributed like b over the torus columns. The refinement stops as soon as the scaled residual
+     *          of the solution passes the HPL-MxP threshold.
+     * 
+     * @param data The local data. A has to contain the LU factors. b is overwritten, since it is used for the triangular solves
+     * @param reference The regenerated local input matrix and right-hand side
+     * @param x The local part of the solution. It has to contain the low precision solution and will contain the refined solution
+     * @param row_communicator Communicator of all ranks in the same torus row
+     * @param col_communicator Communicator of all ranks in the same torus column
+     * @return uint The number of GMRES iterations
+     */
+    uint
+    distributed_gmres_mxp(linpack::LinpackData<TContext>& data, const linpack::LinpackData<TContext>& reference, std::vector<double>& x,
+                            MPI_Comm row_communicator, MPI_Comm col_communicator) {
+    uint n = this->executionSettings->programSettings->matrixSize;
+    uint matrix_width = data.matrix_width;
+    uint matrix_height = data.matrix_height;
+    uint block_size = this->executionSettings->programSettings->blockSize;
+    int torus_row = this->executionSettings->programSettings->torus_row;
+    int torus_width = this->executionSettings->programSettings->torus_width;
+    int torus_height = this->executionSettings->programSettings->torus_height;
+    uint m = std::min(static_cast<uint>(GMRES_RESTART), n);
+    const double eps = std::numeric_limits<double>::epsilon() / 2;
+    const double threshold = 16.0;
+
+    // Position of the values that belong to the local columns of A in the vectors gathered within the torus row
+    std::vector<size_t> column_index(matrix_height);
+    for (size_t j = 0; j < matrix_height; j++) {
+        size_t global_index = (j / block_size) * block_size * torus_height + torus_row * block_size + j % block_size;
+        int owner_col = (global_index / block_size) % torus_width;
+        column_index[j] = owner_col * matrix_width + (global_index / (block_size * torus_width)) * block_size + global_index % block_size;
+    }
+    std::vector<double> v_row(matrix_width * torus_width);
+    std::vector<double> v_local(matrix_height);
+
+    // Calculate A * v in double precision with the original matrix
+    auto matvec = [&](const std::vector<double>& v, std::vector<double>& result) {
+        MPI_Allgather(v.data(), matrix_width, MPI_DOUBLE, v_row.data(), matrix_width, MPI_DOUBLE, row_communicator);
+        for (size_t j = 0; j < matrix_height; j++) {
+            v_local[j] = v_row[column_index[j]];
+        }
+        std::fill(result.begin(), result.end(), 0.0);
+        #pragma omp parallel for
+        for (size_t block_start = 0; block_start < matrix_width; block_start += block_size) {
+            for (size_t j = 0; j < matrix_height; j++) {
+                const HOST_DATA_TYPE* a_column = &reference.A[matrix_width * j];
+                #pragma omp simd
+                for (size_t i = block_start; i < block_start + block_size; i++) {
+                    result[i] += a_column[i] * v_local[j];
+                }
+            }
+        }
+        MPI_Allreduce(MPI_IN_PLACE, result.data(), matrix_width, MPI_DOUBLE, MPI_SUM, col_communicator);
+    };
+
+    // Every rank of a torus row holds a different part of the vectors, so the reductions are done within the row
+    auto dot = [&](const std::vector<double>& a, const std::vector<double>& b) {
+        double sum = 0.0;
+        #pragma omp parallel for reduction(+:sum)
+        for (size_t i = 0; i < matrix_width; i++) {
+            sum += a[i] * b[i];
+        }
+        MPI_Allreduce(MPI_IN_PLACE, &sum, 1, MPI_DOUBLE, MPI_SUM, row_communicator);
+        return sum;
+    };
+    auto max_norm = [&](const std::vector<double>& v) {
+        double max = 0.0;
+        for (size_t i = 0; i < matrix_width; i++) {
+            max = std::max(max, std::abs(v[i]));
+        }
+        MPI_Allreduce(MPI_IN_PLACE, &max, 1, MPI_DOUBLE, MPI_MAX, row_communicator);
+        return max;
+    };
+
+    // Apply the low precision LU factors. The vector is scaled before it is converted to the data type of the factorization
+    // so small residuals do not underflow
+    auto precondition = [&](std::vector<double>& v) {
+        double scale = max_norm(v);
+        if (scale == 0.0) {
+            return;
+        }
+        for (size_t i = 0; i < matrix_width; i++) {
+            data.b[i] = static_cast<HOST_DATA_TYPE>(v[i] / scale);
+        }
+        distributed_gesl_nopvt_ref(data, row_communicator, col_communicator);
+        for (size_t i = 0; i < matrix_width; i++) {
+            v[i] = scale * static_cast<double>(data.b[i]);
+        }
+    };
+
+    // Infinity norms of A and b that are required for the scaled residual
+    std::vector<double> b(reference.b, reference.b + matrix_width);
+    std::vector<double> row_sums(matrix_width, 0.0);
+    for (size_t j = 0; j < matrix_height; j++) {
+        for (size_t i = 0; i < matrix_width; i++) {
+            row_sums[i] += std::abs(reference.A[matrix_width * j + i]);
+        }
+    }
+    MPI_Allreduce(MPI_IN_PLACE, row_sums.data(), matrix_width, MPI_DOUBLE, MPI_SUM, col_communicator);
+    double norm_a = max_norm(row_sums);
+    double norm_b = max_norm(b);
+
+    // Krylov basis, Hessenberg matrix stored column-wise and the Givens rotations
+    std::vector<std::vector<double>> V(m + 1, std::vector<double>(matrix_width));
+    std::vector<double> H((m + 1) * m);
+    std::vector<double> cs(m), sn(m), s(m + 1), y(m);
+    std::vector<double> r(matrix_width);
+    std::vector<double> w(matrix_width);
+
+    uint iterations = 0;
+    for (int restart = 0; ; restart++) {
+        // r = b - A * x
+        matvec(x, r);
+        for (size_t i = 0; i < matrix_width; i++) {
+            r[i] = b[i] - r[i];
+        }
+        double residual = max_norm(r) / ((norm_a * max_norm(x) + norm_b) * n * eps);
+#ifndef NDEBUG
+        if (this->mpi_comm_rank == 0) {
+            std::cout << "Scaled residual after " << iterations << " GMRES iterations: " << residual << std::endl;
+        }
+#endif
+        if (residual <= threshold || restart == GMRES_MAX_RESTARTS) {
+            break;
+        }
+
+        // The preconditioned residual approximates the error of x, so the cycle can stop as soon as it is small enough to
+        // pass the threshold. Further iterations would only stagnate at the precision of the LU factors
+        double tolerance = threshold * n * eps * max_norm(x);
+
+        // V0 = U \ (L \ r) / |U \ (L \ r)|
+        precondition(r);
+        double beta = std::sqrt(dot(r, r));
+        for (size_t i = 0; i < matrix_width; i++) {
+            V[0][i] = r[i] / beta;
+        }
+        std::fill(H.begin(), H.end(), 0.0);
+        std::fill(s.begin(), s.end(), 0.0);
+        s[0] = beta;
+
+        uint steps = 0;
+        while (steps < m) {
+            uint i = steps;
+            // w = U \ (L \ (A * Vi))
+            matvec(V[i], w);
+            precondition(w);
+            iterations++;
+            steps++;
+
+            // Modified Gram-Schmidt
+            for (uint k = 0; k <= i; k++) {
+                H[i * (m + 1) + k] = dot(w, V[k]);
+                for (size_t j = 0; j < matrix_width; j++) {
+                    w[j] -= H[i * (m + 1) + k] * V[k][j];
+                }
+            }
+            H[i * (m + 1) + i + 1] = std::sqrt(dot(w, w));
+            if (H[i * (m + 1) + i + 1] > 0.0) {
+                for (size_t j = 0; j < matrix_width; j++) {
+                    V[i + 1][j] = w[j] / H[i * (m + 1) + i + 1];
+                }
+            }
+
+            // Apply the previous Givens rotations to the new column and eliminate the subdiagonal element
+            for (uint k = 0; k < i; k++) {
+                double temp = cs[k] * H[i * (m + 1) + k] + sn[k] * H[i * (m + 1) + k + 1];
+                H[i * (m + 1) + k + 1] = -sn[k] * H[i * (m + 1) + k] + cs[k] * H[i * (m + 1) + k + 1];
+                H[i * (m + 1) + k] = temp;
+            }
+            double norm = std::hypot(H[i * (m + 1) + i], H[i * (m + 1) + i + 1]);
+            cs[i] = H[i * (m + 1) + i] / norm;
+            sn[i] = H[i * (m + 1) + i + 1] / norm;
+            H[i * (m + 1) + i] = norm;
+            H[i * (m + 1) + i + 1] = 0.0;
+            s[i + 1] = -sn[i] * s[i];
+            s[i] = cs[i] * s[i];
+
+            if (std::abs(s[i + 1]) <= tolerance) {
+                break;
+            }
+        }
+
+        // x = x + V * (H \ s)
+        for (int k = steps - 1; k >= 0; k--) {
+            y[k] = s[k];
+            for (uint l = k + 1; l < steps; l++) {
+                y[k] -= H[l * (m + 1) + k] * y[l];
+            }
+            y[k] /= H[k * (m + 1) + k];
+        }
+        for (uint k = 0; k < steps; k++) {
+            for (size_t j = 0; j < matrix_width; j++) {
+                x[j] += y[k] * V[k][j];
+            }
+        }
+    }
+    return iterations;
+}
+
 
 public:
 
@@ -318,16 +569,55 @@ public:
 #endif
         default: throw std::runtime_error("No calculate method implemented for communication type " + commToString(this->executionSettings->programSettings->communicationType));
     }
-#ifdef DISTRIBUTED_VALIDATION
-    distributed_gesl_nopvt_ref(data);
-#endif
+    // The solve is done distributed on the host and measured for every repetition with the same right hand side
+    bool mixed_precision = this->executionSettings->programSettings->isMixedPrecision;
+    std::vector<HOST_DATA_TYPE> b_original(data.b, data.b + data.matrix_width);
+    std::vector<double> geslExecutionTimes;
+    std::vector<double> gmresExecutionTimes;
+    std::unique_ptr<LinpackData<TContext>> reference;
+    if (mixed_precision) {
+        // The refinement requires the original matrix, which is regenerated before the time measurement
+        reference = generateInputData();
+        refined_solution.resize(data.matrix_width);
+    }
+    // The communicators are created once, so they are not part of the measured solve and refinement
+    MPI_Comm row_communicator;
+    MPI_Comm_split(MPI_COMM_WORLD, this->executionSettings->programSettings->torus_row, 0, &row_communicator);
+    MPI_Comm col_communicator;
+    MPI_Comm_split(MPI_COMM_WORLD, this->executionSettings->programSettings->torus_col, 0, &col_communicator);
+    for (int repetition = 0; repetition < this->executionSettings->programSettings->numRepetitions; repetition++) {
+        std::copy(b_original.begin(), b_original.end(), data.b);
+        MPI_Barrier(MPI_COMM_WORLD);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        distributed_gesl_nopvt_ref(data, row_communicator, col_communicator);
+        auto t2 = std::chrono::high_resolution_clock::now();
+        geslExecutionTimes.push_back(std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1).count());
+        if (mixed_precision) {
+            std::copy(data.b, data.b + data.matrix_width, refined_solution.begin());
+            MPI_Barrier(MPI_COMM_WORLD);
+            t1 = std::chrono::high_resolution_clock::now();
+            gmres_iterations = distributed_gmres_mxp(data, *reference, refined_solution, row_communicator, col_communicator);
+            t2 = std::chrono::high_resolution_clock::now();
+            gmresExecutionTimes.push_back(std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1).count());
+            std::copy(refined_solution.begin(), refined_solution.end(), data.b);
+        }
+    }
+    MPI_Comm_free(&row_communicator);
+    MPI_Comm_free(&col_communicator);
+    this->timings["gesl"] = geslExecutionTimes;
+    if (mixed_precision) {
+        this->timings["gmres"] = gmresExecutionTimes;
+    }
 }
 
 
     /**
-     * @brief Linpack specific implementation of the execution validation
+     * @brief Linpack specific implementation of the execution validation.
+     *          Every rank regenerates its local block of the input matrix and calculates its part of A * x - b,
+     *          so the matrix is never gathered on a single rank.
      * 
-     * @param data The input and output data of the benchmark
+     * @param data The input and output data of the benchmark. b has to contain the local part of the solution x.
+     *          In the mixed-precision mode, the refined solution is validated with double precision instead.
      * @return true If validation is successful
      * @return false otherwise
      */
@@ -336,85 +626,98 @@ public:
         uint n= this->executionSettings->programSettings->matrixSize;
     uint matrix_width = data.matrix_width;
     uint matrix_height = data.matrix_height;
+    uint block_size = this->executionSettings->programSettings->blockSize;
+    int torus_width = this->executionSettings->programSettings->torus_width;
+    int torus_height = this->executionSettings->programSettings->torus_height;
     double residn;
     double resid = 0.0;
     double normx = 0.0;
-#ifndef DISTRIBUTED_VALIDATION
-    if (this->mpi_comm_rank > 0) {
-        for (int j = 0; j < matrix_height; j++) {
-            for (int i = 0; i < matrix_width; i+= this->executionSettings->programSettings->blockSize) {
-                MPI_Send(&data.A[matrix_width * j + i], this->executionSettings->programSettings->blockSize, MPI_DATA_TYPE, 0, 0, MPI_COMM_WORLD);
-            }
-        }
-        if (this->executionSettings->programSettings->torus_row == 0) {
-            for (int i = 0; i < matrix_width; i+= this->executionSettings->programSettings->blockSize) {
-                MPI_Send(&data.b[i], this->executionSettings->programSettings->blockSize, MPI_DATA_TYPE, 0, 0, MPI_COMM_WORLD);
-            }
-        }
-        residn = 0;
+    double norma = 0.0;
+    double normb = 0.0;
+
+    // Regenerate the local blocks of A and b, since A was overwritten by the LU factorization.
+    // The matrix is stored transposed, so the local rows of data.A belong to the columns of A
+    // and b as well as x are distributed over the torus columns.
+    auto reference = generateInputData();
+
+    MPI_Comm row_communicator;
+    MPI_Comm_split(MPI_COMM_WORLD, this->executionSettings->programSettings->torus_row, 0, &row_communicator);
+    MPI_Comm col_communicator;
+    MPI_Comm_split(MPI_COMM_WORLD, this->executionSettings->programSettings->torus_col, 0, &col_communicator);
+
+    bool mixed_precision = this->executionSettings->programSettings->isMixedPrecision && refined_solution.size() == matrix_width;
+    std::vector<double> x(data.b, data.b + matrix_width);
+    if (mixed_precision) {
+        x = refined_solution;
     }
-    else {
-        MPI_Status status;
-        size_t current_offset = 0;
-        std::vector<HOST_DATA_TYPE> total_b_original(n);
-        std::vector<HOST_DATA_TYPE> total_b(n);
-        std::vector<HOST_DATA_TYPE> total_a(n*n);
-        for (int j = 0; j < n; j++) {
-            for (int i = 0; i < n; i+= this->executionSettings->programSettings->blockSize) {
-                int recvcol= (i / this->executionSettings->programSettings->blockSize) % this->executionSettings->programSettings->torus_width;
-                int recvrow= (j / this->executionSettings->programSettings->blockSize) % this->executionSettings->programSettings->torus_height;
-                int recvrank = this->executionSettings->programSettings->torus_width * recvrow + recvcol;
-                if (recvrank > 0) {
-                    MPI_Recv(&total_a[j * n + i], this->executionSettings->programSettings->blockSize, MPI_DATA_TYPE, recvrank, 0, MPI_COMM_WORLD,  &status);
-                }
-                else {
-                    for (int k=0; k < this->executionSettings->programSettings->blockSize; k++) {
-                        total_a[j * n + i + k] = data.A[current_offset + k];
-                    }
-                    current_offset += this->executionSettings->programSettings->blockSize;
-                }
-            }
-        }
-        current_offset = 0;
-        for (int i = 0; i < n; i+= this->executionSettings->programSettings->blockSize) {
-            int recvcol= (i / this->executionSettings->programSettings->blockSize) % this->executionSettings->programSettings->torus_width;
-            if (recvcol > 0) {
-                MPI_Recv(&total_b[i], this->executionSettings->programSettings->blockSize, MPI_DATA_TYPE, recvcol, 0, MPI_COMM_WORLD, &status);
-            }
-            else {
-                for (int k=0; k < this->executionSettings->programSettings->blockSize; k++) {
-                    total_b[i + k] = data.b[current_offset + k];
-                }
-                current_offset += this->executionSettings->programSettings->blockSize;
-            }
-        }
 
-        std::copy(total_b.begin(), total_b.end(), total_b_original.begin());
-        gesl_ref_nopvt(total_a.data(), total_b.data(), n, n);
+    // Every rank of a torus row holds the part of x of its torus column, so x is complete in every torus row.
+    // Only x is exchanged, which is O(n) instead of O(n^2) for the matrix
+    std::vector<double> x_row(matrix_width * torus_width);
+    MPI_Allgather(x.data(), matrix_width, MPI_DOUBLE, x_row.data(), matrix_width, MPI_DOUBLE, row_communicator);
+
+    // Select the values of x that belong to the local columns of A
+    std::vector<double> x_local(matrix_height);
+    for (size_t j = 0; j < matrix_height; j++) {
+        size_t global_index = (j / block_size) * block_size * torus_height + this->executionSettings->programSettings->torus_row * block_size + j % block_size;
+        int owner_col = (global_index / block_size) % torus_width;
+        size_t owner_index = (global_index / (block_size * torus_width)) * block_size + global_index % block_size;
+        x_local[j] = x_row[owner_col * matrix_width + owner_index];
+    }
 
-        for (int i = 0; i < n; i++) {
-            resid = (resid > std::abs(total_b[i] - 1)) ? resid : std::abs(total_b[i] - 1);
-            normx = (normx > std::abs(total_b_original[i])) ? normx : std::abs(total_b_original[i]);
+    // Calculate the partial product of the local block of A with x and the partial absolute row sums of A,
+    // which are stored in the second half of the vector. Every thread works on a block of rows of A
+    std::vector<double> ax(2 * matrix_width, 0.0);
+    #pragma omp parallel for
+    for (size_t block_start = 0; block_start < matrix_width; block_start += block_size) {
+        // The last block may be smaller, if the matrix size is not a multiple of the block size
+        size_t block_end = std::min(block_start + block_size, static_cast<size_t>(matrix_width));
+        for (size_t j = 0; j < matrix_height; j++) {
+            const HOST_DATA_TYPE* a_column = &reference->A[matrix_width * j];
+            #pragma omp simd
+            for (size_t i = block_start; i < block_end; i++) {
+                ax[i] += a_column[i] * x_local[j];
+                ax[matrix_width + i] += std::abs(a_column[i]);
+            }
         }
     }
-#else
-    double local_resid = 0;
-    double local_normx = data.normb;
-    #pragma omp parallel for reduction(max:local_resid)
-    for (int i = 0; i < data.matrix_width; i++) {
-        local_resid = (local_resid > std::abs(data.b[i] - 1)) ? local_resid : std::abs(data.b[i] - 1);
+    // Sum up the partial results of all blocks in the same torus column to get A * x and the row sums
+    MPI_Allreduce(MPI_IN_PLACE, ax.data(), 2 * matrix_width, MPI_DOUBLE, MPI_SUM, col_communicator);
+
+    double local_resid = 0.0;
+    double local_normx = 0.0;
+    double local_norma = 0.0;
+    double local_normb = 0.0;
+    #pragma omp parallel for reduction(max:local_resid,local_normx,local_norma,local_normb)
+    for (size_t i = 0; i < matrix_width; i++) {
+        local_resid = std::max(local_resid, std::abs(ax[i] - reference->b[i]));
+        local_normx = std::max(local_normx, std::abs(x[i]));
+        local_norma = std::max(local_norma, ax[matrix_width + i]);
+        local_normb = std::max(local_normb, std::abs(static_cast<double>(reference->b[i])));
     }
 #ifndef NDEBUG
-    std::cout << "Rank " << this->mpi_comm_rank << ": resid=" << local_resid << ", normx=" << local_normx << std::endl;
+    std::cout << "Rank " << this->mpi_comm_rank << ": resid=" << local_resid << ", normx=" << local_normx << ", norma=" << local_norma << std::endl;
 #endif
 
-    MPI_Reduce(&local_resid, &resid, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
-    MPI_Reduce(&local_normx, &normx, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
-#endif
-
-
-    HOST_DATA_TYPE eps = std::numeric_limits<HOST_DATA_TYPE>::epsilon();
-    residn = resid / (static_cast<double>(n)*normx*eps);
+    double local_norms[4] = {local_resid, local_normx, local_norma, local_normb};
+    double norms[4];
+    MPI_Reduce(local_norms, norms, 4, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    resid = norms[0];
+    normx = norms[1];
+    norma = norms[2];
+    normb = norms[3];
+    MPI_Comm_free(&row_communicator);
+    MPI_Comm_free(&col_communicator);
+
+    double eps = std::numeric_limits<HOST_DATA_TYPE>::epsilon();
+    double threshold = 1.0;
+    if (mixed_precision) {
+        // HPL-MxP requires the solution to be accurate in double precision with the unit roundoff and threshold of HPL
+        eps = std::numeric_limits<double>::epsilon() / 2;
+        threshold = 16.0;
+    }
+    // Scaled residual as used by HPL: ||Ax - b|| / (eps * (||A|| * ||x|| + ||b||) * n) with the infinity norm
+    residn = resid / (static_cast<double>(n) * (norma * normx + normb) * eps);
 
     #ifndef NDEBUG
         if (residn > 1 &&  this->mpi_comm_size == 1) {
@@ -462,7 +765,7 @@ public:
     this->errors.emplace("residual_norm", residn);
 
     if (this->mpi_comm_rank == 0) {
-        return residn < 1;
+        return residn < threshold;
     } else {
         return true;
     }
@@ -495,6 +798,12 @@ collectResults() {
     MPI_Reduce(this->timings["gefa"].data(), global_lu_times.data(), this->timings["gefa"].size(), MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
     std::vector<double> global_sl_times(this->timings["gesl"].size());
     MPI_Reduce(this->timings["gesl"].data(), global_sl_times.data(), this->timings["gesl"].size(), MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    bool mixed_precision = this->timings.count("gmres") > 0;
+    std::vector<double> global_ir_times;
+    if (mixed_precision) {
+        global_ir_times.resize(this->timings["gmres"].size());
+        MPI_Reduce(this->timings["gmres"].data(), global_ir_times.data(), this->timings["gmres"].size(), MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    }
 #ifndef NDEBUG
     std::cout << "Rank " << this->mpi_comm_rank << ": Result collection done" << std::endl;
 #endif
@@ -533,6 +842,27 @@ collectResults() {
     this->results.emplace("gflops", hpcc_base::HpccResult((gflop_lu + gflop_sl) / tmin, "GFLOP/s"));
     this->results.emplace("gflops_lu", hpcc_base::HpccResult(gflop_lu / lu_min, "GFLOP/s"));
     this->results.emplace("gflops_sl", hpcc_base::HpccResult(gflop_sl / sl_min, "GFLOP/s"));
+
+    if (mixed_precision) {
+        // HPL-MxP counts the operations of the LU factorization and the solve, but includes the time of the refinement
+        double gflop_mxp = ((2.0 / 3.0) * total_matrix_size * total_matrix_size * total_matrix_size + 1.5 * total_matrix_size * total_matrix_size) / 1.0e9;
+        double tir = 0;
+        double tmxp = 0;
+        double ir_min = std::numeric_limits<double>::max();
+        double tmxp_min = std::numeric_limits<double>::max();
+        for (int i =0; i < global_ir_times.size(); i++) {
+            tir += global_ir_times[i];
+            tmxp += global_lu_times[i] + global_sl_times[i] + global_ir_times[i];
+            ir_min = std::min(ir_min, global_ir_times[i]);
+            tmxp_min = std::min(tmxp_min, global_lu_times[i] + global_sl_times[i] + global_ir_times[i]);
+        }
+        this->results.emplace("tir_mean", hpcc_base::HpccResult(tir / global_ir_times.size(), "s"));
+        this->results.emplace("tir_min", hpcc_base::HpccResult(ir_min, "s"));
+        this->results.emplace("tmxp_mean", hpcc_base::HpccResult(tmxp / global_ir_times.size(), "s"));
+        this->results.emplace("tmxp_min", hpcc_base::HpccResult(tmxp_min, "s"));
+        this->results.emplace("gflops_mxp", hpcc_base::HpccResult(gflop_mxp / tmxp_min, "GFLOP/s"));
+        this->results.emplace("gmres_iterations", hpcc_base::HpccResult(gmres_iterations, ""));
+    }
     
     return;
 }
@@ -557,6 +887,16 @@ printResults() {
         std::cout << std::left << std::setw(ENTRY_SPACE) << " GESL"
                   << this->results.at("tsl_min") << this->results.at("tsl_mean") << this->results.at("gflops_sl")
                   << std::right << std::endl;
+
+        if (this->results.count("gflops_mxp") > 0) {
+            std::cout << std::left << std::setw(ENTRY_SPACE) << " GMRES"
+                    << this->results.at("tir_min") << this->results.at("tir_mean")
+                    << std::right << std::endl;
+            std::cout << std::left << std::setw(ENTRY_SPACE) << " MxP total"
+                    << this->results.at("tmxp_min") << this->results.at("tmxp_mean") << this->results.at("gflops_mxp")
+                    << std::right << std::endl;
+            std::cout << "GMRES iterations: " << this->results.at("gmres_iterations").value << std::endl;
+        }
     }
 }
 
@@ -27,8 +27,15 @@ SOFTWARE.
 #include "linpack_data.hpp"
 
 /* C++ standard library headers */
+#include <algorithm>
 #include <memory>
 #include <random>
+#include <vector>
+
+/* External library headers */
+#ifdef _OPENMP
+#include "omp.h"
+#endif
 
 /* Project's headers */
 #include "communication_types.hpp"
@@ -37,7 +44,7 @@ SOFTWARE.
 linpack::LinpackProgramSettings::LinpackProgramSettings(cxxopts::ParseResult &results) : hpcc_base::BaseSettings(results),
     matrixSize(results["m"].as<uint>() * (1 << (results["b"].as<uint>()))), blockSize(1 << (results["b"].as<uint>())), 
     isEmulationKernel(results.count("emulation") > 0), isDiagonallyDominant(results.count("uniform") == 0),
-    torus_width(results["p"].as<uint>()) {
+    lookAhead(results["look-ahead"].as<uint>()), isMixedPrecision(results.count("mxp") > 0), torus_width(results["p"].as<uint>()) {
     int mpi_comm_rank;
     int mpi_comm_size;
     MPI_Comm_rank(MPI_COMM_WORLD, &mpi_comm_rank);
@@ -49,6 +56,12 @@ linpack::LinpackProgramSettings::LinpackProgramSettings(cxxopts::ParseResult &re
     torus_height = mpi_comm_size / torus_width;
     torus_row = (mpi_comm_rank / torus_width);
     torus_col = (mpi_comm_rank % torus_width);
+    if (lookAhead > 1) {
+        throw std::runtime_error("Look-ahead depth " + std::to_string(lookAhead) + " not supported! Only 0 and 1 are allowed.");
+    }
+    if (isMixedPrecision && !isDiagonallyDominant) {
+        throw std::runtime_error("Mixed-precision mode requires a diagonally dominant matrix, since the LU factors are calculated without pivoting!");
+    }
 }
 
 std::map<std::string, std::string>
@@ -57,6 +70,8 @@ linpack::LinpackProgramSettings::getSettingsMap() {
     map["Matrix Size"] = std::to_string(matrixSize);
     map["Block Size"] = std::to_string(blockSize);
     map["Emulate"] = (isEmulationKernel) ? "Yes" : "No";
+    map["Look-Ahead"] = std::to_string(lookAhead);
+    map["Mixed Precision"] = isMixedPrecision ? "Yes" : "No";
     map["Diagonally Dominant"] = isDiagonallyDominant ? "Yes" : "No";
     map["Data Type"] = STR(HOST_DATA_TYPE);
     map["FPGA Torus"] = "P=" + std::to_string(torus_width) +
@@ -64,95 +79,316 @@ linpack::LinpackProgramSettings::getSettingsMap() {
     return map;
 }
 
+namespace {
+
 /**
-Standard LU factorization on a block with fixed size
+ * Number of columns of A that are factorized as a panel before the trailing matrix is updated.
+ * It is also used as the block size of the triangular solves.
+ */
+constexpr unsigned REFERENCE_BLOCK_SIZE = 128;
 
-Case 1 of Zhangs description
+/**
+ * Width of a sub-panel that is factorized column by column and not further divided
+ */
+constexpr unsigned REFERENCE_PANEL_LEAF_SIZE = 16;
+
+/**
+ * Number of rows of the multipliers that are packed into a contiguous buffer by the trailing update
+ */
+constexpr unsigned REFERENCE_UPDATE_ROWS = 256;
+
+/**
+ * Number of rows and columns of the trailing matrix that are kept in registers by the trailing update
+ */
+constexpr unsigned REFERENCE_MICRO_ROWS = 16;
+constexpr unsigned REFERENCE_MICRO_COLS = 4;
+
+/**
+Update the block of A with the rows [r0,r1) and columns [c0,c1) with the product of the multipliers in the columns [k0,k1)
+and the rows [k0,k1) of the block columns. Since the multipliers are stored negated, the product is added.
+The trailing matrix is divided into tiles of rows that are processed in parallel. The multipliers of a tile are packed into
+a contiguous buffer and reused for all columns. Four columns are updated at once with the partial results kept in registers.
 */
 void
-linpack::gefa_ref(HOST_DATA_TYPE* a, unsigned n, unsigned lda, cl_int* ipvt) {
-    for (int i = 0; i < n; i++) {
-        ipvt[i] = i;
+update_trailing_matrix(HOST_DATA_TYPE* a, unsigned lda, unsigned k0, unsigned k1, unsigned r0, unsigned r1, unsigned c0, unsigned c1) {
+    if (k1 <= k0 || r1 <= r0 || c1 <= c0) {
+        return;
+    }
+    unsigned depth = k1 - k0;
+    unsigned row_tiles = (r1 - r0 + REFERENCE_UPDATE_ROWS - 1) / REFERENCE_UPDATE_ROWS;
+    unsigned col_groups = (c1 - c0 + REFERENCE_MICRO_COLS - 1) / REFERENCE_MICRO_COLS;
+    // Split the columns of a tile into chunks, so also small trailing matrices are distributed over all threads
+    unsigned num_threads = 1;
+#ifdef _OPENMP
+    num_threads = omp_get_max_threads();
+#endif
+    unsigned col_chunks = std::max(1u, std::min(col_groups, num_threads / row_tiles));
+    unsigned groups_per_chunk = (col_groups + col_chunks - 1) / col_chunks;
+
+    #pragma omp parallel
+    {
+    std::vector<HOST_DATA_TYPE> packed(static_cast<size_t>(REFERENCE_UPDATE_ROWS) * depth);
+    int packed_tile = -1;
+
+    #pragma omp for schedule(static)
+    for (int task = 0; task < static_cast<int>(row_tiles * col_chunks); task++) {
+        int tile = task / col_chunks;
+        unsigned row_start = r0 + tile * REFERENCE_UPDATE_ROWS;
+        unsigned rows = std::min(REFERENCE_UPDATE_ROWS, r1 - row_start);
+        if (tile != packed_tile) {
+            for (unsigned k = 0; k < depth; k++) {
+                std::copy(&a[static_cast<size_t>(lda) * (k0 + k) + row_start], &a[static_cast<size_t>(lda) * (k0 + k) + row_start + rows],
+                          &packed[static_cast<size_t>(rows) * k]);
+            }
+            packed_tile = tile;
+        }
+        unsigned col_start = c0 + (task % col_chunks) * groups_per_chunk * REFERENCE_MICRO_COLS;
+        unsigned col_end = std::min(c1, col_start + groups_per_chunk * REFERENCE_MICRO_COLS);
+        for (unsigned j = col_start; j < col_end; j += REFERENCE_MICRO_COLS) {
+            unsigned cols = std::min(REFERENCE_MICRO_COLS, col_end - j);
+            HOST_DATA_TYPE* c[REFERENCE_MICRO_COLS];
+            const HOST_DATA_TYPE* u[REFERENCE_MICRO_COLS];
+            for (unsigned jj = 0; jj < REFERENCE_MICRO_COLS; jj++) {
+                // Surplus columns of the last group repeat the last column and are not stored
+                unsigned col = j + std::min(jj, cols - 1);
+                c[jj] = &a[static_cast<size_t>(lda) * col + row_start];
+                u[jj] = &a[static_cast<size_t>(lda) * col + k0];
+            }
+            unsigned i = 0;
+            for (; i + REFERENCE_MICRO_ROWS <= rows; i += REFERENCE_MICRO_ROWS) {
+                HOST_DATA_TYPE acc[REFERENCE_MICRO_COLS][REFERENCE_MICRO_ROWS] = {};
+                for (unsigned k = 0; k < depth; k++) {
+                    const HOST_DATA_TYPE* l = &packed[static_cast<size_t>(rows) * k + i];
+                    for (unsigned jj = 0; jj < REFERENCE_MICRO_COLS; jj++) {
+                        HOST_DATA_TYPE scale = u[jj][k];
+                        #pragma omp simd
+                        for (unsigned ii = 0; ii < REFERENCE_MICRO_ROWS; ii++) {
+                            acc[jj][ii] += l[ii] * scale;
+                        }
+                    }
+                }
+                for (unsigned jj = 0; jj < cols; jj++) {
+                    #pragma omp simd
+                    for (unsigned ii = 0; ii < REFERENCE_MICRO_ROWS; ii++) {
+                        c[jj][i + ii] += acc[jj][ii];
+                    }
+                }
+            }
+            // Remaining rows of the tile
+            for (unsigned jj = 0; jj < cols; jj++) {
+                for (unsigned k = 0; k < depth; k++) {
+                    HOST_DATA_TYPE scale = u[jj][k];
+                    for (unsigned ii = i; ii < rows; ii++) {
+                        c[jj][ii] += packed[static_cast<size_t>(rows) * k + ii] * scale;
+                    }
+                }
+            }
+        }
     }
-    // For each diagnonal element
-    for (int k = 0; k < n - 1; k++) {
-        HOST_DATA_TYPE max_val = fabs(a[k * lda + k]);
-        int pvt_index = k;
-        for (int i = k + 1; i < n; i++) {
-            if (max_val < fabs(a[k * lda + i])) {
-                pvt_index = i;
-                max_val = fabs(a[k * lda + i]);
+    }
+}
+
+/**
+Apply the row interchanges of the columns [k0,k1) to the columns [c0,c1) in the order they were found
+*/
+void
+apply_row_interchanges(HOST_DATA_TYPE* a, unsigned lda, const cl_int* ipvt, unsigned k0, unsigned k1, unsigned c0, unsigned c1) {
+    #pragma omp parallel for
+    for (int j = c0; j < static_cast<int>(c1); j++) {
+        for (unsigned k = k0; k < k1; k++) {
+            if (ipvt[k] != static_cast<cl_int>(k)) {
+                std::swap(a[static_cast<size_t>(lda) * j + k], a[static_cast<size_t>(lda) * j + ipvt[k]]);
             }
         }
+    }
+}
 
-        for (int i = k; i < n; i++) {
-            HOST_DATA_TYPE tmp_val = a[i * lda + k];
-            a[i * lda + k] = a[i * lda + pvt_index];
-            a[i * lda + pvt_index] = tmp_val;
+/**
+Apply the multipliers of the columns [k0,k1) to the rows [k0,k1) of the columns [c0,c1), which is a triangular solve
+with the unit lower triangular block of L
+*/
+void
+solve_block_row(HOST_DATA_TYPE* a, unsigned lda, unsigned k0, unsigned k1, unsigned c0, unsigned c1) {
+    #pragma omp parallel for
+    for (int j = c0; j < static_cast<int>(c1); j++) {
+        HOST_DATA_TYPE* column = &a[static_cast<size_t>(lda) * j];
+        for (unsigned k = k0; k < k1; k++) {
+            const HOST_DATA_TYPE* l = &a[static_cast<size_t>(lda) * k];
+            for (unsigned i = k + 1; i < k1; i++) {
+                column[i] += l[i] * column[k];
+            }
         }
-        ipvt[k] = pvt_index;
+    }
+}
 
-        // For each element below it
-        for (int i = k + 1; i < n; i++) {
-            a[k * lda + i] *= -1.0 / a[k * lda + k];
+/**
+Recursively factorize the panel of A with the columns [c0,c1). The left half of the panel is factorized first and used
+to update the right half, before the right half is factorized. Row interchanges are applied to all columns of the panel,
+so the multipliers are in the final row order of the panel when they are used for the updates.
+The columns right of the panel have to be interchanged by the caller.
+
+@param ipvt array of pivoting indices. If it is a nullptr, the panel is factorized without pivoting and
+            the diagonal will contain the negative inverse of its elements
+*/
+void
+factorize_panel(HOST_DATA_TYPE* a, unsigned n, unsigned lda, unsigned c0, unsigned c1, cl_int* ipvt) {
+    if (c1 - c0 > REFERENCE_PANEL_LEAF_SIZE) {
+        unsigned mid = c0 + (c1 - c0) / 2;
+        factorize_panel(a, n, lda, c0, mid, ipvt);
+        if (ipvt != nullptr) {
+            apply_row_interchanges(a, lda, ipvt, c0, mid, mid, c1);
+        }
+        solve_block_row(a, lda, c0, mid, mid, c1);
+        update_trailing_matrix(a, lda, c0, mid, mid, n, mid, c1);
+        factorize_panel(a, n, lda, mid, c1, ipvt);
+        if (ipvt != nullptr) {
+            apply_row_interchanges(a, lda, ipvt, mid, std::min(c1, n - 1), c0, mid);
+        }
+        return;
+    }
+    for (unsigned k = c0; k < c1; k++) {
+        if (ipvt != nullptr) {
+            if (k + 1 >= n) {
+                break;
+            }
+            HOST_DATA_TYPE max_val = fabs(a[k * lda + k]);
+            unsigned pvt_index = k;
+            for (unsigned i = k + 1; i < n; i++) {
+                if (max_val < fabs(a[k * lda + i])) {
+                    pvt_index = i;
+                    max_val = fabs(a[k * lda + i]);
+                }
+            }
+            for (unsigned j = c0; j < c1; j++) {
+                std::swap(a[j * lda + k], a[j * lda + pvt_index]);
+            }
+            ipvt[k] = pvt_index;
+            // For each element below it
+            for (unsigned i = k + 1; i < n; i++) {
+                a[k * lda + i] *= -1.0 / a[k * lda + k];
+            }
         }
-        // For each column right of current diagonal element
-        for (int j = k + 1; j < n; j++) {
+        else {
+            // Store negatie invers of diagonal elements to get rid of some divisions afterwards!
+            a[k * lda + k] = -1.0 / a[k * lda + k];
             // For each element below it
-            for (int i = k+1; i < n; i++) {
-                a[j * lda + i] += a[k * lda + i] * a[j * lda + k];
+            for (unsigned i = k + 1; i < n; i++) {
+                a[k * lda + i] *= a[k * lda + k];
+            }
+        }
+        // For each column of the panel right of current diagonal element
+        for (unsigned j = k + 1; j < c1; j++) {
+            HOST_DATA_TYPE scale = a[j * lda + k];
+            #pragma omp simd
+            for (unsigned i = k + 1; i < n; i++) {
+                a[j * lda + i] += a[k * lda + i] * scale;
             }
         }
+    }
+}
 
-#ifdef DEBUG
-        std::cout << "A(k=" << k <<"): " << std::endl;
-                for (int i= 0; i < n; i++) {
-                    for (int j=0; j < n; j++) {
-                        std::cout << a[i*lda + j] << ", ";
+/**
+Blocked right-looking LU factorization. After a panel is factorized, its row interchanges and the triangular solve are applied
+to the block row right of it and the trailing matrix is updated with a matrix multiplication.
+The multipliers of a column are stored in the row order at the time the column was eliminated like in LINPACK,
+so the row interchanges of the later columns of the panel are undone for each column in the end.
+*/
+void
+blocked_gefa(HOST_DATA_TYPE* a, unsigned n, unsigned lda, cl_int* ipvt) {
+    for (unsigned k0 = 0; k0 < n; k0 += REFERENCE_BLOCK_SIZE) {
+        unsigned k1 = std::min(k0 + REFERENCE_BLOCK_SIZE, n);
+        factorize_panel(a, n, lda, k0, k1, ipvt);
+        if (ipvt != nullptr) {
+            apply_row_interchanges(a, lda, ipvt, k0, std::min(k1, n - 1), k1, n);
+        }
+        solve_block_row(a, lda, k0, k1, k1, n);
+        update_trailing_matrix(a, lda, k0, k1, k1, n, k1, n);
+        if (ipvt != nullptr) {
+            #pragma omp parallel for
+            for (int k = k0; k < static_cast<int>(k1); k++) {
+                for (unsigned l = std::min(k1, n - 1); l-- > static_cast<unsigned>(k) + 1;) {
+                    if (ipvt[l] != static_cast<cl_int>(l)) {
+                        std::swap(a[static_cast<size_t>(lda) * k + l], a[static_cast<size_t>(lda) * k + ipvt[l]]);
                     }
-                    std::cout << std::endl;
                 }
-                std::cout <<  std::endl;
-#endif
-
+            }
+        }
     }
 }
 
+/**
+Update the rows [r0,r1) of b with the product of the columns [k0,k1) of A and the already solved values b[k0:k1]
+multiplied by sign. The rows are distributed over the threads.
+*/
 void
-linpack::gesl_ref(HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, cl_int* ipvt, unsigned n, unsigned lda) {
-    auto b_tmp = new HOST_DATA_TYPE[n];
-    {
-        for (int k = 0; k < n; k++) {
-            b_tmp[k] = b[k];
+update_solution(const HOST_DATA_TYPE* a, unsigned lda, HOST_DATA_TYPE* b, unsigned k0, unsigned k1, unsigned r0, unsigned r1, HOST_DATA_TYPE sign) {
+    #pragma omp parallel for if (r1 - r0 > REFERENCE_UPDATE_ROWS)
+    for (int row_start = r0; row_start < static_cast<int>(r1); row_start += REFERENCE_UPDATE_ROWS) {
+        unsigned row_end = std::min(row_start + REFERENCE_UPDATE_ROWS, r1);
+        for (unsigned k = k0; k < k1; k++) {
+            HOST_DATA_TYPE scale = sign * b[k];
+            #pragma omp simd
+            for (unsigned i = row_start; i < row_end; i++) {
+                b[i] += scale * a[static_cast<size_t>(lda) * k + i];
+            }
         }
+    }
+}
+
+}
+
+/**
+Standard LU factorization on a block with fixed size
+
+Case 1 of Zhangs description
+*/
+void
+linpack::gefa_ref(HOST_DATA_TYPE* a, unsigned n, unsigned lda, cl_int* ipvt) {
+    for (unsigned i = 0; i < n; i++) {
+        ipvt[i] = i;
+    }
+    blocked_gefa(a, n, lda, ipvt);
+}
 
-        // solve l*y = b
-        // For each row in matrix
-        for (int k = 0; k < n - 1; k++) {
-            if (ipvt[k] != k) {
-                HOST_DATA_TYPE tmp = b_tmp[k];
-                b_tmp[k] = b_tmp[ipvt[k]];
-                b_tmp[ipvt[k]] = tmp;
+void
+linpack::gesl_ref(HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, cl_int* ipvt, unsigned n, unsigned lda) {
+    // solve l*y = b
+    for (unsigned k0 = 0; k0 < n; k0 += REFERENCE_BLOCK_SIZE) {
+        unsigned k1 = std::min(k0 + REFERENCE_BLOCK_SIZE, n);
+        for (unsigned k = k0; k + 1 < n && k < k1; k++) {
+            unsigned p = ipvt[k];
+            if (p >= k1) {
+                // The row below the block did not receive the updates of the previous columns of the block yet.
+                // Add them before the interchange and subtract them from the new value, since they are added with the block update.
+                HOST_DATA_TYPE pending = 0.0;
+                for (unsigned j = k0; j < k; j++) {
+                    pending += b[j] * a[static_cast<size_t>(lda) * j + p];
+                }
+                HOST_DATA_TYPE tmp = b[k];
+                b[k] = b[p] + pending;
+                b[p] = tmp - pending;
+            }
+            else if (p != k) {
+                std::swap(b[k], b[p]);
             }
-            // For each row below add
-            for (int i = k + 1; i < n; i++) {
-                // add solved upper row to current row
-                b_tmp[i] += b_tmp[k] * a[lda * k + i];
+            for (unsigned i = k + 1; i < k1; i++) {
+                b[i] += b[k] * a[static_cast<size_t>(lda) * k + i];
             }
         }
+        update_solution(a, lda, b, k0, k1, k1, n, 1.0);
+    }
 
-        // now solve  u*x = y
-        for (int k = n - 1; k >= 0; k--) {
-            b_tmp[k] = b_tmp[k] / a[lda * k + k];
-            for (int i = 0; i < k; i++) {
-                b_tmp[i] -= b_tmp[k] * a[lda * k + i];
+    // now solve  u*x = y
+    for (unsigned k1 = n; k1 > 0; k1 = (k1 > REFERENCE_BLOCK_SIZE) ? k1 - REFERENCE_BLOCK_SIZE : 0) {
+        unsigned k0 = (k1 > REFERENCE_BLOCK_SIZE) ? k1 - REFERENCE_BLOCK_SIZE : 0;
+        for (unsigned k = k1; k-- > k0;) {
+            b[k] = b[k] / a[static_cast<size_t>(lda) * k + k];
+            for (unsigned i = k0; i < k; i++) {
+                b[i] -= b[k] * a[static_cast<size_t>(lda) * k + i];
             }
         }
-        for (int k = 0; k < n; k++) {
-            b[k] = b_tmp[k];
-        }
+        update_solution(a, lda, b, k0, k1, 0, k0, -1.0);
     }
-    delete [] b_tmp;
 }
 
 void linpack::dmxpy(unsigned n1, HOST_DATA_TYPE* y, unsigned n2, unsigned ldm, HOST_DATA_TYPE* x, HOST_DATA_TYPE* m, bool transposed) {
@@ -165,65 +401,33 @@ void linpack::dmxpy(unsigned n1, HOST_DATA_TYPE* y, unsigned n2, unsigned ldm, H
 
 void
 linpack::gefa_ref_nopvt(HOST_DATA_TYPE* a, unsigned n, unsigned lda) {
-    // For each diagnonal element
-    for (int k = 0; k < n; k++) {
-        // Store negatie invers of diagonal elements to get rid of some divisions afterwards!
-        a[k * lda + k] = -1.0 / a[k * lda + k];
-        // For each element below it
-        for (int i = k + 1; i < n; i++) {
-            a[k * lda + i] *= a[k * lda + k];
-        }
-        // For each column right of current diagonal element
-        for (int j = k + 1; j < n; j++) {
-            // For each element below it
-            for (int i = k+1; i < n; i++) {
-                a[j * lda + i] += a[k * lda + i] * a[j * lda + k];
-            }
-        }
-
-#ifdef DEBUG
-        std::cout << "A(k=" << k << "): " << std::endl;
-                for (int i= 0; i < n; i++) {
-                    for (int j=0; j < n; j++) {
-                        std::cout << a[i*lda + j] << ", ";
-                    }
-                    std::cout << std::endl;
-                }
-                std::cout <<  std::endl;
-#endif
-
-    }
+    blocked_gefa(a, n, lda, nullptr);
 }
 
 
 void
 linpack::gesl_ref_nopvt(HOST_DATA_TYPE* a, HOST_DATA_TYPE* b, unsigned n, unsigned lda) {
-    auto b_tmp = new HOST_DATA_TYPE[n];
-
-    for (int k = 0; k < n; k++) {
-        b_tmp[k] = b[k];
-    }
-
     // solve l*y = b
-    // For each row in matrix
-    for (int k = 0; k < n - 1; k++) {
-        // For each row below add
-        for (int i = k + 1; i < n; i++) {
-            // add solved upper row to current row
-            b_tmp[i] += b_tmp[k] * a[lda * k + i];
+    for (unsigned k0 = 0; k0 < n; k0 += REFERENCE_BLOCK_SIZE) {
+        unsigned k1 = std::min(k0 + REFERENCE_BLOCK_SIZE, n);
+        for (unsigned k = k0; k < k1; k++) {
+            for (unsigned i = k + 1; i < k1; i++) {
+                b[i] += b[k] * a[static_cast<size_t>(lda) * k + i];
+            }
         }
+        update_solution(a, lda, b, k0, k1, k1, n, 1.0);
     }
 
-    // now solve  u*x = y
-    for (int k = n - 1; k >= 0; k--) {
-        HOST_DATA_TYPE scale = b_tmp[k] * a[lda * k + k];
-        b_tmp[k] = -scale;
-        for (int i = 0; i < k; i++) {
-            b_tmp[i] += scale * a[lda * k + i];
+    // now solve  u*x = y. The diagonal contains the negative inverse of its elements
+    for (unsigned k1 = n; k1 > 0; k1 = (k1 > REFERENCE_BLOCK_SIZE) ? k1 - REFERENCE_BLOCK_SIZE : 0) {
+        unsigned k0 = (k1 > REFERENCE_BLOCK_SIZE) ? k1 - REFERENCE_BLOCK_SIZE : 0;
+        for (unsigned k = k1; k-- > k0;) {
+            HOST_DATA_TYPE scale = b[k] * a[static_cast<size_t>(lda) * k + k];
+            b[k] = -scale;
+            for (unsigned i = k0; i < k; i++) {
+                b[i] += scale * a[static_cast<size_t>(lda) * k + i];
+            }
         }
+        update_solution(a, lda, b, k0, k1, 0, k0, -1.0);
     }
-    for (int k = 0; k < n; k++) {
-        b[k] = b_tmp[k];
-    }
-    delete [] b_tmp;
 }
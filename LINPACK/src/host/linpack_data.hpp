@@ -73,6 +73,20 @@ public:
      */
     bool isEmulationKernel;
 
+    /**
+     * @brief Look-ahead depth of the PCIe execution. If it is 1, the LU, top and left updates of the next block row
+     *          only wait for the updates of the blocks they depend on and not for the whole trailing matrix update.
+     * 
+     */
+    uint lookAhead;
+
+    /**
+     * @brief True, if the solution of the LU factorization should be refined to double precision with GMRES
+     *          as defined by HPL-MxP.
+     * 
+     */
+    bool isMixedPrecision;
+
     /**
      * @brief The row position of this MPI rank in the torus
      * 
@@ -97,4 +97,31 @@ TEST_F(LinpackHostTest, ReferenceSolveWithoutPivoting) {
     bm->printError(); 
 }
 
+// The reference implementation works on panels of 128 columns, so use a matrix size that is not a multiple
+// of the panel size to also cover the row interchanges between the panels and the remaining columns
+TEST_F(LinpackHostTest, ReferenceSolveWithPivotingMultiplePanels) {
+    bm->getExecutionSettings().programSettings->matrixSize = 300;
+    bm->getExecutionSettings().programSettings->isDiagonallyDominant = false;
+    data = bm->generateInputData();
+    linpack::gefa_ref(data->A, 300, 300, data->ipvt);
+    linpack::gesl_ref(data->A, data->b, data->ipvt, 300, 300);
+    EXPECT_TRUE(bm->validateOutput(*data));
+    bm->printError();
+}
+
+TEST_F(LinpackHostTest, ReferenceSolveWithoutPivotingMultiplePanels) {
+    bm->getExecutionSettings().programSettings->matrixSize = 300;
+    data = bm->generateInputData();
+    linpack::gefa_ref_nopvt(data->A, 300, 300);
+    linpack::gesl_ref_nopvt(data->A, data->b, 300, 300);
+    EXPECT_TRUE(bm->validateOutput(*data));
+    bm->printError();
+}
 
+TEST_F(LinpackHostTest, ValidationFailsForWrongSolution) {
+    data = bm->generateInputData();
+    linpack::gefa_ref_nopvt(data->A, array_size, array_size);
+    linpack::gesl_ref_nopvt(data->A, data->b, array_size, array_size);
+    data->b[array_size / 2] += 0.1;
+    EXPECT_FALSE(bm->validateOutput(*data));
+}
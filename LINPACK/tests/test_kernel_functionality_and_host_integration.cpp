@@ -47,6 +47,36 @@ TEST_P(LinpackKernelTest, FPGACorrectResultsOneRepetition) {
     }
 }
 
+/**
+ * PCIe execution without look-ahead returns correct results.
+ * The LU, top and left updates additionally wait for all inner updates of the previous block row.
+ */
+TEST_P(LinpackKernelTest, FPGACorrectResultsWithoutLookAhead) {
+    if (bm->getExecutionSettings().programSettings->communicationType != hpcc_base::CommunicationType::pcie_mpi) {
+        GTEST_SKIP() << "The look-ahead depth is only used by the PCIe execution";
+    }
+    bm->getExecutionSettings().programSettings->lookAhead = 0;
+    bm->executeKernel(*data);
+    for (int i = 0; i < array_size; i++) {
+        EXPECT_NEAR(data->b[i], 1.0, 1.0e-3);
+    }
+}
+
+/**
+ * PCIe execution with look-ahead returns correct results.
+ * The next diagonal block is factorized while the inner updates of the current block row are still running.
+ */
+TEST_P(LinpackKernelTest, FPGACorrectResultsWithLookAhead) {
+    if (bm->getExecutionSettings().programSettings->communicationType != hpcc_base::CommunicationType::pcie_mpi) {
+        GTEST_SKIP() << "The look-ahead depth is only used by the PCIe execution";
+    }
+    bm->getExecutionSettings().programSettings->lookAhead = 1;
+    bm->executeKernel(*data);
+    for (int i = 0; i < array_size; i++) {
+        EXPECT_NEAR(data->b[i], 1.0, 1.0e-3);
+    }
+}
+
 /**
  * GEFA Execution returns correct results for a single repetition
  */
@@ -125,6 +155,17 @@ TEST_P(LinpackKernelTest, JsonDump) {
     }
 }
 
+/**
+ * Mixed-precision execution refines the solution until it passes the double precision validation
+ */
+TEST_P(LinpackKernelTest, FPGAMixedPrecisionSolutionIsRefined) {
+    bm->getExecutionSettings().programSettings->isMixedPrecision = true;
+    bm->executeKernel(*data);
+    EXPECT_TRUE(bm->getTimingsMap().count("gmres") > 0);
+    EXPECT_TRUE(bm->validateOutput(*data));
+    bm->printError();
+}
+
 INSTANTIATE_TEST_CASE_P(
         LinpackKernelParametrizedTests,
         LinpackKernelTest,
@@ -0,0 +1,23 @@
+# This file contains the default configuration for the Xilinx Alveo U280 board
+# using HBM and the PCIE communication type, where updates are routed between the ranks via MPI.
+# To use this configuration file, call cmake with the parameter
+#
+#     cmake [...] -DHPCC_FPGA_CONFIG="path to this file"
+#
+
+
+set(USE_MPI Yes CACHE BOOL "" FORCE)
+set(USE_SVM No CACHE BOOL "" FORCE)
+set(USE_HBM Yes CACHE BOOL "" FORCE)
+set(FPGA_BOARD_NAME "xilinx_u280_xdma_201920_3" CACHE STRING "" FORCE)
+set(XILINX_LINK_SETTINGS_FILE ${CMAKE_SOURCE_DIR}/settings/settings.link.xilinx.random_access_kernels_PCIE.hbm.generator.ini CACHE FILEPATH "" FORCE)
+set(XILINX_COMPILE_SETTINGS_FILE ${CMAKE_SOURCE_DIR}/settings/settings.compile.xilinx.random_access_kernels_single.hbm.ini CACHE FILEPATH "" FORCE)
+set(DEFAULT_COMM_TYPE "PCIE" CACHE STRING "" FORCE)
+
+# RA specific options
+set(HPCC_FPGA_RA_DEFAULT_ARRAY_LENGTH_LOG 29 CACHE STRING "" FORCE)
+set(HPCC_FPGA_RA_INTEL_USE_PRAGMA_IVDEP No CACHE BOOL "" FORCE)
+set(HPCC_FPGA_RA_DEVICE_BUFFER_SIZE_LOG 10 CACHE STRING "" FORCE)
+set(NUM_REPLICATIONS 16 CACHE STRING "" FORCE)
+set(HPCC_FPGA_RA_DEFAULT_LOOK_AHEAD 1024 CACHE STRING "" FORCE)
+set(HPCC_FPGA_RA_DEFAULT_BATCH_SIZE_LOG 20 CACHE STRING "" FORCE)
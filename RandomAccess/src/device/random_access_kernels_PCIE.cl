@@ -0,0 +1,99 @@
+/*
+Copyright (c) 2023 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "parameters.h"
+
+{% if generate_attributes is defined %}
+    {% set kernel_param_attributes = generate_attributes(num_replications) %}
+{% else %}
+    {% set kernel_param_attributes = create_list("", num_replications) %}
+{% endif %}
+
+{% for i in range(num_replications) %}
+
+/*
+Kernel, that will apply a batch of updates to the given data array.
+In contrast to the single kernel implementation, the random numbers are not
+generated on the FPGA. Instead, they are generated by all MPI ranks on the host
+and routed to the rank that holds the addressed part of the data array.
+
+@param data The data array that will be updated
+@param updates The random numbers that should be applied to the data array
+@param num_updates The number of updates in the updates buffer
+@param m  the size of the data array over all ranks
+@param data_chunk  the chunk size that has to be updated by the kernel
+@param kernel_number Global number of the kernel that defines the offset of the data chunk to the total data array
+*/
+__attribute__((max_global_work_dim(0),uses_global_work_offset(0)))
+__kernel
+void applyUpdates_{{ i }}(__global {{ kernel_param_attributes[i] }} DEVICE_DATA_TYPE_UNSIGNED  volatile * restrict data,
+                        __global {{ kernel_param_attributes[i] }} const DEVICE_DATA_TYPE_UNSIGNED * restrict updates,
+                        const DEVICE_DATA_TYPE_UNSIGNED num_updates,
+                        const DEVICE_DATA_TYPE_UNSIGNED m,
+                        const DEVICE_DATA_TYPE_UNSIGNED data_chunk,
+                        const uint kernel_number) {
+
+    // calculate the start of the address range this kernel is responsible for
+    DEVICE_DATA_TYPE_UNSIGNED const address_start = kernel_number * data_chunk;
+
+#ifdef INTEL_FPGA
+#ifdef HPCC_FPGA_RA_INTEL_USE_PRAGMA_IVDEP
+#pragma ivdep array(data)
+#endif
+#endif
+    for (DEVICE_DATA_TYPE_UNSIGNED offset = 0; offset < num_updates; offset += BUFFER_SIZE) {
+
+        DEVICE_DATA_TYPE_UNSIGNED local_address_buffer[BUFFER_SIZE];
+        DEVICE_DATA_TYPE_UNSIGNED loaded_data_buffer[BUFFER_SIZE];
+
+#ifdef INTEL_FPGA
+#ifdef HPCC_FPGA_RA_INTEL_USE_PRAGMA_IVDEP
+        __attribute__((opencl_unroll_hint(2*BUFFER_SIZE)))
+#endif
+#endif
+        for (uint i = 0; i < 2 * BUFFER_SIZE; i++) {
+            if (i < BUFFER_SIZE) {
+                // Load the next update and the addressed value
+                bool valid = (offset + i) < num_updates;
+                DEVICE_DATA_TYPE_UNSIGNED random_number = valid ? updates[offset + i] : 0UL;
+                DEVICE_DATA_TYPE_UNSIGNED address = (random_number >> 3) & (m - 1);
+                DEVICE_DATA_TYPE_UNSIGNED local_address = address - address_start;
+                // Mark invalid updates with an address outside of the data chunk
+                valid = valid && (local_address < data_chunk);
+                local_address_buffer[i] = valid ? local_address : data_chunk;
+
+                if (valid) {
+                    loaded_data_buffer[i] = data[local_address] ^ random_number;
+                }
+            }
+            else {
+                // Write back the updated values
+                DEVICE_DATA_TYPE_UNSIGNED local_address = local_address_buffer[i - BUFFER_SIZE];
+                if (local_address < data_chunk) {
+                    data[local_address] = loaded_data_buffer[i - BUFFER_SIZE];
+                }
+            }
+        }
+    }
+}
+
+{% endfor %}
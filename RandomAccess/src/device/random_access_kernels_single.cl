@@ -52,6 +52,8 @@ to the kernel.
 @param m  the size of the data array
 @param data_chunk  the chunk size that has to be updated by the kernel
 @param kernel_number Number of the kernel that defines the offset of the data chunk to the total data array
+@param num_active_gen Number of random number generators that are used to generate the updates. Has to be at most CONCURRENT_GEN.
+                The remaining generators stay idle.
 */
 __attribute__((max_global_work_dim(0),uses_global_work_offset(0)))
 __kernel
@@ -60,7 +62,8 @@ void accessMemory_{{ i }}(__global {{ kernel_param_attributes[i] }} DEVICE_DATA_
                         const DEVICE_DATA_TYPE_UNSIGNED m,
                         const DEVICE_DATA_TYPE_UNSIGNED data_chunk,
                         const uint num_cache_operations,
-                        const uint kernel_number) {
+                        const uint kernel_number,
+                        const uint num_active_gen) {
 
     // Initiate the pseudo random number generators
     DEVICE_DATA_TYPE_UNSIGNED ran_initials[CONCURRENT_GEN/BLOCK_SIZE][BLOCK_SIZE];
@@ -78,10 +81,16 @@ void accessMemory_{{ i }}(__global {{ kernel_param_attributes[i] }} DEVICE_DATA_
     }
     DEVICE_DATA_TYPE_UNSIGNED ran[CONCURRENT_GEN];
     DEVICE_DATA_TYPE_UNSIGNED number_count[CONCURRENT_GEN];
+    DEVICE_DATA_TYPE_UNSIGNED const mupdate = 4 * m;
+    // Number of updates every generator has to calculate. Inactive generators do not calculate any updates
+    DEVICE_DATA_TYPE_UNSIGNED total_updates[CONCURRENT_GEN];
+    DEVICE_DATA_TYPE_UNSIGNED const updates_per_gen = mupdate / num_active_gen;
+    DEVICE_DATA_TYPE_UNSIGNED const remaining_updates = mupdate - updates_per_gen * num_active_gen;
     __attribute__((opencl_unroll_hint(CONCURRENT_GEN)))
     for (int r = 0; r < CONCURRENT_GEN; r++) {
         number_count[r] = 0;
         ran[r] = ran_initials[r >> BLOCK_SIZE_LOG][ r & (BLOCK_SIZE - 1)];
+        total_updates[r] = (r < num_active_gen) ? updates_per_gen + ((r < remaining_updates) ? 1 : 0) : 0;
     }
 
     // Initialize shift register
@@ -105,7 +114,6 @@ void accessMemory_{{ i }}(__global {{ kernel_param_attributes[i] }} DEVICE_DATA_
     DEVICE_DATA_TYPE_UNSIGNED const address_start = kernel_number * data_chunk;
     #endif
 
-    DEVICE_DATA_TYPE_UNSIGNED const mupdate = 4 * m;
     bool done = false;
 
     // do random accesses until we achieved the desired number of updates
@@ -130,10 +138,9 @@ void accessMemory_{{ i }}(__global {{ kernel_param_attributes[i] }} DEVICE_DATA_
                 // They put a new random number into the shift register if it does not already contain a valid random number indicated by the valid bit
                 __attribute__((opencl_unroll_hint(CONCURRENT_GEN)))
                 for (int r=0; r < CONCURRENT_GEN; r++) {
-                    DEVICE_DATA_TYPE_UNSIGNED total_updates = (mupdate >> CONCURRENT_GEN_LOG) + ((r < (mupdate & (CONCURRENT_GEN - 1)) ? 1 : 0));
                     number_count[r] = !random_number_valid[(r + 1) * SHIFT_GAP] ? number_count[r] + 1 : number_count[r];
                     bool is_inrange = false;
-                    if (!random_number_valid[(r + 1) * SHIFT_GAP] && number_count[r] <= total_updates) {
+                    if (!random_number_valid[(r + 1) * SHIFT_GAP] && number_count[r] <= total_updates[r]) {
                         DEVICE_DATA_TYPE_UNSIGNED v = ((DEVICE_DATA_TYPE) ran[r] < 0) ? POLY : 0UL;
                         ran[r] = (ran[r] << 1) ^ v;
                         DEVICE_DATA_TYPE_UNSIGNED address = (ran[r] >> 3) & (m - 1);
@@ -148,7 +155,7 @@ void accessMemory_{{ i }}(__global {{ kernel_param_attributes[i] }} DEVICE_DATA_
                     }
                     // update the status bits of the shift register accordingly
                     random_number_valid[(r + 1) * SHIFT_GAP] = (random_number_valid[(r + 1) * SHIFT_GAP] || is_inrange);
-                    random_number_done_shift[(r + 1) * SHIFT_GAP] = (number_count[r] >= total_updates && (random_number_done_shift[(r + 1) * SHIFT_GAP] || r == CONCURRENT_GEN - 1));
+                    random_number_done_shift[(r + 1) * SHIFT_GAP] = (number_count[r] >= total_updates[r] && (random_number_done_shift[(r + 1) * SHIFT_GAP] || r == CONCURRENT_GEN - 1));
                 }
 
                 // Get random number from shift register and do update
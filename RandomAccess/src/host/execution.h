@@ -43,6 +43,46 @@ namespace bm_execution {
 std::map<std::string, std::vector<double>>
 calculate(hpcc_base::ExecutionSettings<random_access::RandomAccessProgramSettings, cl::Device, cl::Context, cl::Program> const& config, HOST_DATA_TYPE * data, int mpi_rank, int mpi_size);
 
+namespace cpu {
+
+/**
+ * @brief This method will execute the benchmark on the host to provide a CPU baseline.
+ *          The update sequence is split over all OpenMP threads and every thread uses multiple interleaved
+ *          random number generators. Addresses are prefetched and can optionally be sorted in batches.
+ *          Updates of different threads are not synchronized, as in the HPCC reference implementation.
+ * 
+ * @param config The ExecutionSettings with the OpenCL objects and program settings
+ * @param data The data that is used as input and output of the random accesses
+ * @param mpi_rank The rank of this process
+ * @param mpi_size The number of ranks
+ * @return std::map<std::string, std::vector<double>> The measured runtimes of the execution
+ */
+std::map<std::string, std::vector<double>>
+calculate(hpcc_base::ExecutionSettings<random_access::RandomAccessProgramSettings, cl::Device, cl::Context, cl::Program> const& config, HOST_DATA_TYPE * data, int mpi_rank, int mpi_size);
+
+}  // namespace cpu
+
+#ifdef _USE_MPI_
+namespace pcie {
+
+/**
+ * @brief This method will execute the distributed version of the benchmark similar to MPIRandomAccess of HPCC.
+ *          Every rank generates only its share of the updates on the host and routes them to the owning rank
+ *          via MPI_Alltoallv in windows of the configured look-ahead. The received updates are applied in batches
+ *          by the FPGA kernels.
+ * 
+ * @param config The ExecutionSettings with the OpenCL objects and program settings
+ * @param data The local part of the data array that is used as input and output of the random accesses
+ * @param mpi_rank The rank of this process
+ * @param mpi_size The number of ranks
+ * @return std::map<std::string, std::vector<double>> The measured runtimes of the kernel
+ */
+std::map<std::string, std::vector<double>>
+calculate(hpcc_base::ExecutionSettings<random_access::RandomAccessProgramSettings, cl::Device, cl::Context, cl::Program> const& config, HOST_DATA_TYPE * data, int mpi_rank, int mpi_size);
+
+}  // namespace pcie
+#endif
+
 }  // namespace bm_execution
 
 #endif  // SRC_HOST_EXECUTION_H_
@@ -0,0 +1,177 @@
+/*
+Copyright (c) 2023 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* Related header files */
+#include "execution.h"
+
+/* C++ standard library headers */
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+/* External library headers */
+#ifdef _OPENMP
+#include "omp.h"
+#endif
+#ifdef _USE_MPI_
+#include "mpi.h"
+#endif
+
+/**
+ * @brief Number of updates that are generated by every thread before they are applied to the data array.
+ *          The addresses of all updates in the batch are prefetched before the first update is applied.
+ *
+ */
+#define HOST_CPU_PREFETCH_BATCH_SIZE 64
+
+/**
+ * @brief Number of updates that are generated and sorted by every thread before they are applied, if sorting is enabled
+ *
+ */
+#define HOST_CPU_SORT_BATCH_SIZE (1 << 12)
+
+namespace bm_execution {
+namespace cpu {
+
+    /*
+    Implementation for the CPU.
+     @copydoc bm_execution::cpu::calculate()
+    */
+    std::map<std::string, std::vector<double>>
+    calculate(hpcc_base::ExecutionSettings<random_access::RandomAccessProgramSettings, cl::Device, cl::Context, cl::Program> const& config, HOST_DATA_TYPE * data, int mpi_rank, int mpi_size) {
+
+        HOST_DATA_TYPE local_size = config.programSettings->dataSize;
+        HOST_DATA_TYPE global_size = local_size * mpi_size;
+        HOST_DATA_TYPE address_start = mpi_rank * local_size;
+        HOST_DATA_TYPE total_updates = 4 * global_size;
+        bool sort_updates = config.programSettings->sortUpdates;
+
+        // Every repetition starts with the same data, so keep a copy of the initial values
+        std::vector<HOST_DATA_TYPE> initial_data(data, data + local_size);
+
+        /* --- Execute the benchmark on the host --- */
+
+        std::vector<double> executionTimes;
+        for (int i = 0; i < config.programSettings->numRepetitions; i++) {
+
+            #pragma omp parallel for
+            for (HOST_DATA_TYPE j = 0; j < local_size; j++) {
+                data[j] = initial_data[j];
+            }
+
+#ifdef _USE_MPI_
+            MPI_Barrier(MPI_COMM_WORLD);
+#endif
+
+            auto t1 = std::chrono::high_resolution_clock::now();
+
+            #pragma omp parallel
+            {
+                int num_threads = 1;
+                int thread_id = 0;
+#ifdef _OPENMP
+                num_threads = omp_get_num_threads();
+                thread_id = omp_get_thread_num();
+#endif
+                // Every thread uses multiple interleaved generators to hide the dependency between consecutive numbers.
+                // Every generator calculates a segment of the update sequence starting at its jump-ahead value.
+                HOST_DATA_TYPE generators_per_thread = std::max(static_cast<HOST_DATA_TYPE>(1),
+                        static_cast<HOST_DATA_TYPE>(config.programSettings->numRngs / num_threads));
+                HOST_DATA_TYPE num_segments = generators_per_thread * num_threads;
+                HOST_DATA_TYPE segment_size = total_updates / num_segments;
+                HOST_DATA_TYPE first_segment = thread_id * generators_per_thread;
+
+                std::vector<HOST_DATA_TYPE> ran(generators_per_thread);
+                for (HOST_DATA_TYPE g = 0; g < generators_per_thread; g++) {
+                    ran[g] = random_access::starts((first_segment + g) * segment_size);
+                }
+
+                HOST_DATA_TYPE batch_steps = std::max(static_cast<HOST_DATA_TYPE>(1),
+                        static_cast<HOST_DATA_TYPE>((sort_updates ? HOST_CPU_SORT_BATCH_SIZE : HOST_CPU_PREFETCH_BATCH_SIZE) / generators_per_thread));
+                std::vector<HOST_DATA_TYPE> updates(batch_steps * generators_per_thread);
+
+                for (HOST_DATA_TYPE step = 0; step < segment_size; step += batch_steps) {
+                    HOST_DATA_TYPE current_steps = std::min(batch_steps, segment_size - step);
+                    HOST_DATA_TYPE update_count = 0;
+                    // Generate the next numbers of all generators and keep only the updates to the local data
+                    for (HOST_DATA_TYPE s = 0; s < current_steps; s++) {
+                        for (HOST_DATA_TYPE g = 0; g < generators_per_thread; g++) {
+                            HOST_DATA_TYPE_SIGNED v = 0;
+                            if (((HOST_DATA_TYPE_SIGNED)ran[g]) < 0) {
+                                v = POLY;
+                            }
+                            ran[g] = (ran[g] << 1) ^ v;
+                            HOST_DATA_TYPE local_address = ((ran[g] >> 3) & (global_size - 1)) - address_start;
+                            if (local_address < local_size) {
+                                updates[update_count++] = ran[g];
+                                __builtin_prefetch(&data[local_address], 1);
+                            }
+                        }
+                    }
+                    if (sort_updates) {
+                        std::sort(updates.begin(), updates.begin() + update_count,
+                                [global_size](HOST_DATA_TYPE a, HOST_DATA_TYPE b) {
+                                    return ((a >> 3) & (global_size - 1)) < ((b >> 3) & (global_size - 1));
+                                });
+                    }
+                    // Updates of different threads may collide.
+                    // Like the HPCC reference implementation, no synchronization is used and the resulting errors
+                    // have to stay within the error tolerance.
+                    for (HOST_DATA_TYPE u = 0; u < update_count; u++) {
+                        data[((updates[u] >> 3) & (global_size - 1)) - address_start] ^= updates[u];
+                    }
+                }
+
+                // The last generator of the last thread additionally calculates the remaining updates
+                if (thread_id == num_threads - 1) {
+                    HOST_DATA_TYPE g = generators_per_thread - 1;
+                    for (HOST_DATA_TYPE u = num_segments * segment_size; u < total_updates; u++) {
+                        HOST_DATA_TYPE_SIGNED v = 0;
+                        if (((HOST_DATA_TYPE_SIGNED)ran[g]) < 0) {
+                            v = POLY;
+                        }
+                        ran[g] = (ran[g] << 1) ^ v;
+                        HOST_DATA_TYPE local_address = ((ran[g] >> 3) & (global_size - 1)) - address_start;
+                        if (local_address < local_size) {
+                            data[local_address] ^= ran[g];
+                        }
+                    }
+                }
+            }
+
+            auto t2 = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double> timespan =
+                    std::chrono::duration_cast<std::chrono::duration<double>>
+                            (t2 - t1);
+            executionTimes.push_back(timespan.count());
+        }
+
+        std::map<std::string, std::vector<double>> timings;
+
+        timings["execution"] = executionTimes;
+
+        return timings;
+    }
+
+}  // namespace cpu
+}  // namespace bm_execution
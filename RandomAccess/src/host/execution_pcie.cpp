@@ -0,0 +1,268 @@
+/*
+Copyright (c) 2023 Marius Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* Related header files */
+#include "execution.h"
+
+/* C++ standard library headers */
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+/* External library headers */
+#include "mpi.h"
+#ifdef INTEL_FPGA
+#include "CL/cl_ext_intelfpga.h"
+#endif
+
+namespace bm_execution {
+namespace pcie {
+
+    /*
+    Implementation for the PCIE communication type.
+     @copydoc bm_execution::pcie::calculate()
+    */
+    std::map<std::string, std::vector<double>>
+    calculate(hpcc_base::ExecutionSettings<random_access::RandomAccessProgramSettings, cl::Device, cl::Context, cl::Program> const& config, HOST_DATA_TYPE * data, int mpi_rank, int mpi_size) {
+#ifdef USE_SVM
+        throw std::runtime_error("The PCIE communication type does not support SVM!");
+#endif
+        // int used to check for OpenCL errors
+        int err;
+
+        uint replications = config.programSettings->kernelReplications;
+        HOST_DATA_TYPE local_size = config.programSettings->dataSize;
+        HOST_DATA_TYPE global_size = local_size * mpi_size;
+        HOST_DATA_TYPE data_chunk = local_size / replications;
+        HOST_DATA_TYPE address_start = mpi_rank * local_size;
+        HOST_DATA_TYPE look_ahead = config.programSettings->lookAhead;
+        HOST_DATA_TYPE batch_size = config.programSettings->batchSize;
+        // A single window can contain up to look_ahead updates from every rank.
+        // So the host buffers for a batch need additional space for the last window
+        HOST_DATA_TYPE max_batch_size = batch_size + look_ahead * mpi_size;
+
+        std::vector<cl::CommandQueue> compute_queue;
+        std::vector<cl::Buffer> Buffer_data;
+        // Two update buffers per replication, so the next batch can be transferred while the current batch is applied
+        std::vector<cl::Buffer> Buffer_updates[2];
+        std::vector<cl::Kernel> updatekernel;
+
+        /* --- Prepare kernels --- */
+
+        for (int r=0; r < replications; r++) {
+            compute_queue.push_back(cl::CommandQueue(*config.context, *config.device, 0, &err));
+            ASSERT_CL(err);
+            int memory_bank_info = 0;
+#ifdef INTEL_FPGA
+#ifdef USE_HBM
+            memory_bank_info = CL_MEM_HETEROGENEOUS_INTELFPGA;
+#else
+            memory_bank_info = ((r + 1) << 16);
+#endif
+#endif
+            Buffer_data.push_back(cl::Buffer(*config.context,
+                        CL_MEM_READ_WRITE | memory_bank_info,
+                        sizeof(HOST_DATA_TYPE) * data_chunk));
+            for (int b = 0; b < 2; b++) {
+                Buffer_updates[b].emplace_back(*config.context,
+                            CL_MEM_READ_ONLY | memory_bank_info,
+                            sizeof(HOST_DATA_TYPE) * max_batch_size);
+            }
+#ifdef INTEL_FPGA
+            updatekernel.push_back(cl::Kernel(*config.program,
+                        (APPLY_UPDATES_KERNEL + std::to_string(r)).c_str() ,
+                        &err));
+#endif
+#ifdef XILINX_FPGA
+            updatekernel.push_back(cl::Kernel(*config.program,
+                        (std::string(APPLY_UPDATES_KERNEL) + "0:{" + APPLY_UPDATES_KERNEL + "0_" + std::to_string(r + 1) + "}").c_str() ,
+                        &err));
+#endif
+            ASSERT_CL(err);
+
+            err = updatekernel[r].setArg(0, Buffer_data[r]);
+            ASSERT_CL(err);
+            err = updatekernel[r].setArg(3, global_size);
+            ASSERT_CL(err);
+            err = updatekernel[r].setArg(4, data_chunk);
+            ASSERT_CL(err);
+            err = updatekernel[r].setArg(5, cl_uint(mpi_rank * replications + r));
+            ASSERT_CL(err);
+        }
+
+        /* --- Prepare host buffers --- */
+
+        // Updates generated in the current window and the same updates sorted by the destination rank
+        std::vector<HOST_DATA_TYPE> window_updates(look_ahead);
+        std::vector<HOST_DATA_TYPE> send_buffer(look_ahead);
+        std::vector<int> send_counts(mpi_size);
+        std::vector<int> send_displs(mpi_size);
+        std::vector<int> recv_counts(mpi_size);
+        std::vector<int> recv_displs(mpi_size);
+        std::vector<int> send_positions(mpi_size);
+        // Received updates of the current batch
+        std::vector<HOST_DATA_TYPE> batch_buffer(max_batch_size);
+        // Received updates sorted by kernel replication. One buffer for each of the two device buffers
+        std::vector<HOST_DATA_TYPE> replication_buffer[2];
+        std::vector<HOST_DATA_TYPE> replication_offsets[2];
+        std::vector<cl::Event> kernel_events[2];
+        for (int b = 0; b < 2; b++) {
+            replication_buffer[b].resize(max_batch_size);
+            replication_offsets[b].resize(replications + 1);
+        }
+
+        /* --- Execute actual benchmark kernels --- */
+
+        std::vector<double> executionTimes;
+        for (int i = 0; i < config.programSettings->numRepetitions; i++) {
+
+            for (int r = 0; r < replications; r++) {
+                err = compute_queue[r].enqueueWriteBuffer(Buffer_data[r], CL_TRUE, 0,
+                                                    sizeof(HOST_DATA_TYPE) * data_chunk,
+                                                    &data[r * data_chunk]);
+                ASSERT_CL(err)
+            }
+
+            MPI_Barrier(MPI_COMM_WORLD);
+
+            auto t1 = std::chrono::high_resolution_clock::now();
+
+            // Every rank generates its share of the global update sequence
+            HOST_DATA_TYPE ran = random_access::starts(4 * address_start);
+            HOST_DATA_TYPE remaining_updates = 4 * local_size;
+            HOST_DATA_TYPE batch_count = 0;
+            int current_buffer = 0;
+
+            while (remaining_updates > 0) {
+                HOST_DATA_TYPE window_size = std::min(look_ahead, remaining_updates);
+                remaining_updates -= window_size;
+
+                // Generate the updates of the window and sort them by the destination rank
+                std::fill(send_counts.begin(), send_counts.end(), 0);
+                for (HOST_DATA_TYPE u = 0; u < window_size; u++) {
+                    HOST_DATA_TYPE_SIGNED v = 0;
+                    if (((HOST_DATA_TYPE_SIGNED)ran) < 0) {
+                        v = POLY;
+                    }
+                    ran = (ran << 1) ^ v;
+                    window_updates[u] = ran;
+                    send_counts[((ran >> 3) & (global_size - 1)) / local_size]++;
+                }
+                send_displs[0] = 0;
+                for (int p = 1; p < mpi_size; p++) {
+                    send_displs[p] = send_displs[p - 1] + send_counts[p - 1];
+                }
+                std::copy(send_displs.begin(), send_displs.end(), send_positions.begin());
+                for (HOST_DATA_TYPE u = 0; u < window_size; u++) {
+                    send_buffer[send_positions[((window_updates[u] >> 3) & (global_size - 1)) / local_size]++] = window_updates[u];
+                }
+
+                // Exchange the updates with all other ranks
+                MPI_Alltoall(send_counts.data(), 1, MPI_INT, recv_counts.data(), 1, MPI_INT, MPI_COMM_WORLD);
+                recv_displs[0] = 0;
+                for (int p = 1; p < mpi_size; p++) {
+                    recv_displs[p] = recv_displs[p - 1] + recv_counts[p - 1];
+                }
+                MPI_Alltoallv(send_buffer.data(), send_counts.data(), send_displs.data(), MPI_UNSIGNED_LONG,
+                                &batch_buffer[batch_count], recv_counts.data(), recv_displs.data(), MPI_UNSIGNED_LONG, MPI_COMM_WORLD);
+                batch_count += recv_displs[mpi_size - 1] + recv_counts[mpi_size - 1];
+
+                if (batch_count < batch_size && remaining_updates > 0) {
+                    continue;
+                }
+
+                // Apply the batch on the FPGA. Wait until the previous kernels using the same buffer are done
+                if (!kernel_events[current_buffer].empty()) {
+                    cl::Event::waitForEvents(kernel_events[current_buffer]);
+                    kernel_events[current_buffer].clear();
+                }
+                // Sort the received updates by the kernel replication that holds the address
+                std::vector<HOST_DATA_TYPE>& sorted = replication_buffer[current_buffer];
+                std::vector<HOST_DATA_TYPE>& offsets = replication_offsets[current_buffer];
+                std::fill(offsets.begin(), offsets.end(), 0);
+                for (HOST_DATA_TYPE u = 0; u < batch_count; u++) {
+                    offsets[(((batch_buffer[u] >> 3) & (global_size - 1)) - address_start) / data_chunk + 1]++;
+                }
+                for (int r = 0; r < replications; r++) {
+                    offsets[r + 1] += offsets[r];
+                }
+                std::vector<HOST_DATA_TYPE> positions(offsets.begin(), offsets.end() - 1);
+                for (HOST_DATA_TYPE u = 0; u < batch_count; u++) {
+                    sorted[positions[(((batch_buffer[u] >> 3) & (global_size - 1)) - address_start) / data_chunk]++] = batch_buffer[u];
+                }
+                for (int r = 0; r < replications; r++) {
+                    HOST_DATA_TYPE num_updates = offsets[r + 1] - offsets[r];
+                    if (num_updates == 0) {
+                        continue;
+                    }
+                    err = compute_queue[r].enqueueWriteBuffer(Buffer_updates[current_buffer][r], CL_FALSE, 0,
+                                                        sizeof(HOST_DATA_TYPE) * num_updates,
+                                                        &sorted[offsets[r]]);
+                    ASSERT_CL(err)
+                    err = updatekernel[r].setArg(1, Buffer_updates[current_buffer][r]);
+                    ASSERT_CL(err)
+                    err = updatekernel[r].setArg(2, num_updates);
+                    ASSERT_CL(err)
+                    cl::Event kernel_event;
+                    err = compute_queue[r].enqueueNDRangeKernel(updatekernel[r], cl::NullRange, cl::NDRange(1), cl::NullRange, nullptr, &kernel_event);
+                    ASSERT_CL(err)
+                    kernel_events[current_buffer].push_back(kernel_event);
+                }
+                compute_queue[0].flush();
+                batch_count = 0;
+                current_buffer = 1 - current_buffer;
+            }
+
+            for (int r = 0; r < replications; r++) {
+                compute_queue[r].finish();
+            }
+            for (int b = 0; b < 2; b++) {
+                kernel_events[b].clear();
+            }
+
+            MPI_Barrier(MPI_COMM_WORLD);
+
+            auto t2 = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double> timespan =
+                    std::chrono::duration_cast<std::chrono::duration<double>>
+                            (t2 - t1);
+            executionTimes.push_back(timespan.count());
+        }
+
+        /* --- Read back results from Device --- */
+        for (int r=0; r < replications; r++) {
+            err = compute_queue[r].enqueueReadBuffer(Buffer_data[r], CL_TRUE, 0,
+                    sizeof(HOST_DATA_TYPE) * data_chunk,
+                    &data[r * data_chunk]);
+            ASSERT_CL(err)
+        }
+
+        std::map<std::string, std::vector<double>> timings;
+
+        timings["execution"] = executionTimes;
+
+        return timings;
+    }
+
+}  // namespace pcie
+}  // namespace bm_execution
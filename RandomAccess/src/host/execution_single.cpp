@@ -26,6 +26,7 @@ SOFTWARE.
 /* C++ standard library headers */
 #include <chrono>
 #include <fstream>
+#include <limits>
 #include <memory>
 #include <vector>
 
@@ -45,33 +46,26 @@ namespace bm_execution {
         // int used to check for OpenCL errors
         int err;
 
+        uint replications = config.programSettings->kernelReplications;
+        bool scan = config.programSettings->scan;
+
         std::vector<cl::CommandQueue> compute_queue;
         std::vector<cl::Buffer> Buffer_data;
         std::vector<cl::Buffer> Buffer_randoms;
         std::vector<cl::Kernel> accesskernel;
 
-        // Calculate RNG initial values
+        // The kernel always reads the initial values of all generators it was compiled with.
+        // Only the first numRngs generators are used.
+        size_t max_rngs = std::max(static_cast<size_t>(config.programSettings->numRngs), static_cast<size_t>(1 << HPCC_FPGA_RA_RNG_COUNT_LOG));
         HOST_DATA_TYPE* random_inits;
-        posix_memalign(reinterpret_cast<void**>(&random_inits), 4096, sizeof(HOST_DATA_TYPE)*config.programSettings->numRngs);
-        HOST_DATA_TYPE chunk = config.programSettings->dataSize * mpi_size * 4 / std::min(static_cast<size_t>(config.programSettings->numRngs), config.programSettings->dataSize * 4 * mpi_size);
-        HOST_DATA_TYPE ran = 1;
-        random_inits[0] = ran;
-        for (HOST_DATA_TYPE r=0; r < config.programSettings->numRngs - 1; r++) {
-            for (HOST_DATA_TYPE run = 0; run < chunk; run++) {
-                HOST_DATA_TYPE_SIGNED v = 0;
-                if (((HOST_DATA_TYPE_SIGNED) ran) < 0) {
-                    v = POLY;
-                }
-                ran = (ran << 1) ^v;
-            }
-            random_inits[r + 1] = ran;
-        }
-
+        posix_memalign(reinterpret_cast<void**>(&random_inits), 4096, sizeof(HOST_DATA_TYPE)*max_rngs);
+        std::fill(random_inits, random_inits + max_rngs, 1);
 
         /* --- Prepare kernels --- */
 
-        for (int r=0; r < config.programSettings->kernelReplications; r++) {
-            compute_queue.push_back(cl::CommandQueue(*config.context, *config.device, 0, &err));
+        for (int r=0; r < replications; r++) {
+            // Profiling is only required to measure the kernel latencies in scan mode
+            compute_queue.push_back(cl::CommandQueue(*config.context, *config.device, scan ? CL_QUEUE_PROFILING_ENABLE : 0, &err));
             ASSERT_CL(err);
             int memory_bank_info = 0;
 #ifdef INTEL_FPGA
@@ -83,11 +77,11 @@ namespace bm_execution {
 #endif
             Buffer_data.push_back(cl::Buffer(*config.context,
                         CL_MEM_READ_WRITE | memory_bank_info,
-                        sizeof(HOST_DATA_TYPE)*(config.programSettings->dataSize / config.programSettings->kernelReplications)));
+                        sizeof(HOST_DATA_TYPE)*(config.programSettings->dataSize / replications)));
 
             Buffer_randoms.emplace_back(*config.context,
                         CL_MEM_READ_ONLY,
-                        sizeof(HOST_DATA_TYPE)*config.programSettings->numRngs);
+                        sizeof(HOST_DATA_TYPE)*max_rngs);
 #ifdef INTEL_FPGA
             accesskernel.push_back(cl::Kernel(*config.program,
                         (RANDOM_ACCESS_KERNEL + std::to_string(r)).c_str() ,
@@ -102,112 +96,159 @@ namespace bm_execution {
 
             // prepare kernels
 #ifdef USE_SVM
-            err = clSetKernelArgSVMPointer(accesskernel[r](), 0,
-                                        reinterpret_cast<void*>(&data[r * (config.programSettings->dataSize / config.programSettings->kernelReplications)]));
             err = clSetKernelArgSVMPointer(accesskernel[r](), 1,
                                         reinterpret_cast<void*>(random_inits));
 #else
             err = accesskernel[r].setArg(0, Buffer_data[r]);
-#endif
-
             ASSERT_CL(err);
             err = accesskernel[r].setArg(1, Buffer_randoms[r]);
-            ASSERT_CL(err);
-            err = accesskernel[r].setArg(2, HOST_DATA_TYPE(config.programSettings->dataSize * mpi_size));
-            ASSERT_CL(err);
-            err = accesskernel[r].setArg(3,
-                                         HOST_DATA_TYPE((config.programSettings->dataSize / config.programSettings->kernelReplications)));
+#endif
             ASSERT_CL(err);
             err = accesskernel[r].setArg(4,(1));
             ASSERT_CL(err);
             err = accesskernel[r].setArg(5,
-                                         cl_uint(mpi_rank * config.programSettings->kernelReplications + r));
+                                         cl_uint(mpi_rank * replications + r));
             ASSERT_CL(err);
         }
 
-        /* --- Execute actual benchmark kernels --- */
+        std::map<std::string, std::vector<double>> timings;
+
+        // In scan mode, the benchmark is executed for all combinations of the number of active generators and
+        // data sizes up to the given values. The last point is always the given configuration.
+        std::vector<random_access::ScanPoint> points = random_access::getScanPoints(*config.programSettings);
+        for (auto const& point : points) {
+#ifdef USE_SVM
+            // The kernels update the host data in place, so every point has to start from the initial data
+            // that is also used for the validation
+            if (&point != &points.front()) {
+                for (HOST_DATA_TYPE j = 0; j < config.programSettings->dataSize; j++) {
+                    data[j] = mpi_rank * config.programSettings->dataSize + j;
+                }
+            }
+#endif
+            HOST_DATA_TYPE local_size = point.dataSize;
+            HOST_DATA_TYPE global_size = local_size * mpi_size;
+            HOST_DATA_TYPE data_chunk = local_size / replications;
+
+            // Calculate RNG initial values using jump-ahead. The first generators calculate one additional
+            // update if the number of updates can not be evenly divided by the number of generators
+            HOST_DATA_TYPE total_updates = 4 * global_size;
+            HOST_DATA_TYPE updates_per_gen = total_updates / point.numRngs;
+            HOST_DATA_TYPE remaining_updates = total_updates - updates_per_gen * point.numRngs;
+            for (HOST_DATA_TYPE g = 0; g < point.numRngs; g++) {
+                random_inits[g] = random_access::starts(g * updates_per_gen + std::min(g, remaining_updates));
+            }
+
+            for (int r = 0; r < replications; r++) {
+#ifdef USE_SVM
+                err = clSetKernelArgSVMPointer(accesskernel[r](), 0,
+                                            reinterpret_cast<void*>(&data[r * data_chunk]));
+                ASSERT_CL(err);
+#endif
+                err = accesskernel[r].setArg(2, global_size);
+                ASSERT_CL(err);
+                err = accesskernel[r].setArg(3, data_chunk);
+                ASSERT_CL(err);
+                err = accesskernel[r].setArg(6, cl_uint(point.numRngs));
+                ASSERT_CL(err);
+            }
+
+            /* --- Execute actual benchmark kernels --- */
 
-        std::vector<double> executionTimes;
-        for (int i = 0; i < config.programSettings->numRepetitions; i++) {
-            std::chrono::time_point<std::chrono::high_resolution_clock> t1;
+            std::vector<double> executionTimes;
+            std::vector<double> kernelLatencies;
+            for (int i = 0; i < config.programSettings->numRepetitions; i++) {
+                std::chrono::time_point<std::chrono::high_resolution_clock> t1;
+                std::vector<cl::Event> kernel_events(replications);
 #pragma omp parallel default(shared)
-            {
+                {
 #pragma omp for
-                for (int r = 0; r < config.programSettings->kernelReplications; r++) {
+                    for (int r = 0; r < replications; r++) {
 #ifdef USE_SVM
-                    err = clEnqueueSVMMap(compute_queue[r](), CL_TRUE,
-                                    CL_MAP_READ | CL_MAP_WRITE,
-                                    reinterpret_cast<void *>(&data[r * (config.programSettings->dataSize / config.programSettings->kernelReplications)]),
-                                    sizeof(HOST_DATA_TYPE) *
-                                    (config.programSettings->dataSize / config.programSettings->kernelReplications), 0,
-                                    NULL, NULL);
-                    ASSERT_CL(err)
-                    err = clEnqueueSVMMap(compute_queue[r](), CL_TRUE,
-                                    CL_MAP_READ,
-                                    reinterpret_cast<void *>(random_inits),
-                                    sizeof(HOST_DATA_TYPE)  * config.programSettings->numRngs, 0,
-                                    NULL, NULL);
-                    ASSERT_CL(err)
+                        err = clEnqueueSVMMap(compute_queue[r](), CL_TRUE,
+                                        CL_MAP_READ | CL_MAP_WRITE,
+                                        reinterpret_cast<void *>(&data[r * data_chunk]),
+                                        sizeof(HOST_DATA_TYPE) * data_chunk, 0,
+                                        NULL, NULL);
+                        ASSERT_CL(err)
+                        err = clEnqueueSVMMap(compute_queue[r](), CL_TRUE,
+                                        CL_MAP_READ,
+                                        reinterpret_cast<void *>(random_inits),
+                                        sizeof(HOST_DATA_TYPE) * max_rngs, 0,
+                                        NULL, NULL);
+                        ASSERT_CL(err)
 #else
-                    err = compute_queue[r].enqueueWriteBuffer(Buffer_data[r], CL_TRUE, 0,
-                                                        sizeof(HOST_DATA_TYPE) *
-                                                        (config.programSettings->dataSize / config.programSettings->kernelReplications),
-                                                        &data[r * (config.programSettings->dataSize / config.programSettings->kernelReplications)]);
-                    ASSERT_CL(err)
-                    err = compute_queue[r].enqueueWriteBuffer(Buffer_randoms[r], CL_TRUE, 0,
-                                                        sizeof(HOST_DATA_TYPE) * config.programSettings->numRngs,
-                                                        random_inits);
-                    ASSERT_CL(err)
+                        err = compute_queue[r].enqueueWriteBuffer(Buffer_data[r], CL_TRUE, 0,
+                                                            sizeof(HOST_DATA_TYPE) * data_chunk,
+                                                            &data[r * data_chunk]);
+                        ASSERT_CL(err)
+                        err = compute_queue[r].enqueueWriteBuffer(Buffer_randoms[r], CL_TRUE, 0,
+                                                            sizeof(HOST_DATA_TYPE) * max_rngs,
+                                                            random_inits);
+                        ASSERT_CL(err)
 #endif
-                }
+                    }
 #pragma omp master
-                {
-                    // Execute benchmark kernels
-                    t1 = std::chrono::high_resolution_clock::now();
-                }
+                    {
+                        // Execute benchmark kernels
+                        t1 = std::chrono::high_resolution_clock::now();
+                    }
 #pragma omp barrier
 #pragma omp for nowait
-                for (int r = 0; r < config.programSettings->kernelReplications; r++) {
-                    compute_queue[r].enqueueNDRangeKernel(accesskernel[r], cl::NullRange, cl::NDRange(1));
-                }
+                    for (int r = 0; r < replications; r++) {
+                        compute_queue[r].enqueueNDRangeKernel(accesskernel[r], cl::NullRange, cl::NDRange(1), cl::NullRange, nullptr, &kernel_events[r]);
+                    }
 #pragma omp for
-                for (int r = 0; r < config.programSettings->kernelReplications; r++) {
-                    compute_queue[r].finish();
-                }
+                    for (int r = 0; r < replications; r++) {
+                        compute_queue[r].finish();
+                    }
 #pragma omp master
-                {
-                    auto t2 = std::chrono::high_resolution_clock::now();
-                    std::chrono::duration<double> timespan =
-                            std::chrono::duration_cast<std::chrono::duration<double>>
-                                    (t2 - t1);
-                    executionTimes.push_back(timespan.count());
+                    {
+                        auto t2 = std::chrono::high_resolution_clock::now();
+                        std::chrono::duration<double> timespan =
+                                std::chrono::duration_cast<std::chrono::duration<double>>
+                                        (t2 - t1);
+                        executionTimes.push_back(timespan.count());
+                    }
+                }
+                if (scan) {
+                    // The latency of a repetition is the time from the start of the first kernel to the end of the last kernel
+                    cl_ulong first_start = std::numeric_limits<cl_ulong>::max();
+                    cl_ulong last_end = 0;
+                    for (auto& e : kernel_events) {
+                        first_start = std::min(first_start, e.getProfilingInfo<CL_PROFILING_COMMAND_START>());
+                        last_end = std::max(last_end, e.getProfilingInfo<CL_PROFILING_COMMAND_END>());
+                    }
+                    kernelLatencies.push_back(static_cast<double>(last_end - first_start) * 1.0e-9);
                 }
             }
+            if (scan) {
+                timings["execution" + random_access::getScanPointSuffix(point)] = executionTimes;
+                timings["latency" + random_access::getScanPointSuffix(point)] = kernelLatencies;
+            }
+            timings["execution"] = executionTimes;
         }
 
         /* --- Read back results from Device --- */
-        for (int r=0; r < config.programSettings->kernelReplications; r++) {
+        // After the scan, the device contains the results of the given configuration
+        for (int r=0; r < replications; r++) {
 #ifdef USE_SVM
             err = clEnqueueSVMUnmap(compute_queue[r](),
-                                reinterpret_cast<void *>(&data[r * (config.programSettings->dataSize / config.programSettings->kernelReplications)]), 0,
+                                reinterpret_cast<void *>(&data[r * (config.programSettings->dataSize / replications)]), 0,
                                 NULL, NULL);
             err = clEnqueueSVMUnmap(compute_queue[r](),
                                 reinterpret_cast<void *>(random_inits), 0,
                                 NULL, NULL);
 #else
             err = compute_queue[r].enqueueReadBuffer(Buffer_data[r], CL_TRUE, 0,
-                    sizeof(HOST_DATA_TYPE)*(config.programSettings->dataSize / config.programSettings->kernelReplications), 
-                    &data[r * (config.programSettings->dataSize / config.programSettings->kernelReplications)]);
+                    sizeof(HOST_DATA_TYPE)*(config.programSettings->dataSize / replications),
+                    &data[r * (config.programSettings->dataSize / replications)]);
 #endif
             ASSERT_CL(err)
         }
 
         free(random_inits);
 
-        std::map<std::string, std::vector<double>> timings;
-
-        timings["execution"] = executionTimes;
-
         return timings;
     }
 }  // namespace bm_execution
@@ -27,8 +27,15 @@ SOFTWARE.
 #include "random_access_benchmark.hpp"
 
 /* C++ standard library headers */
+#include <algorithm>
 #include <memory>
 #include <random>
+#include <vector>
+
+/* External library headers */
+#ifdef _OPENMP
+#include "omp.h"
+#endif
 
 /* Project's headers */
 #include "execution.h"
@@ -36,7 +43,12 @@ SOFTWARE.
 
 random_access::RandomAccessProgramSettings::RandomAccessProgramSettings(cxxopts::ParseResult &results) : hpcc_base::BaseSettings(results),
     dataSize((1UL << results["d"].as<size_t>())),
-    numRngs((1UL << results["g"].as<uint>())) {
+    numRngs((1UL << results["g"].as<uint>())),
+    lookAhead(results["look-ahead"].as<uint>()),
+    batchSize((1UL << results["batch"].as<uint>())),
+    sortUpdates(results.count("sort") > 0),
+    scan(results.count("scan") > 0),
+    scanMinSize((1UL << results["scan-min-size"].as<uint>())) {
 
 }
 
@@ -51,25 +63,40 @@ random_access::RandomAccessProgramSettings::getSettingsMap() {
     ss << dataSize << " (" << static_cast<double>(dataSize * sizeof(HOST_DATA_TYPE) * mpi_size) << " Byte )";
     map["Array Size"] = ss.str();
     map["#RNGs"] = std::to_string(numRngs);
+    if (communicationType == hpcc_base::CommunicationType::pcie_mpi) {
+        map["Look-Ahead"] = std::to_string(lookAhead);
+        map["Batch Size"] = std::to_string(batchSize);
+    }
+    if (communicationType == hpcc_base::CommunicationType::cpu_only) {
+        map["Sort Updates"] = sortUpdates ? "Yes" : "No";
+    }
+    if (scan) {
+        map["Scan Min. Size"] = std::to_string(scanMinSize);
+    }
     return map;
 }
 
 random_access::RandomAccessData::RandomAccessData(cl::Context& context, size_t size) : context(context) {
 #ifdef USE_SVM
-    data = reinterpret_cast<HOST_DATA_TYPE*>(
-                        clSVMAlloc(context(), 0 ,
-                        size * sizeof(HOST_DATA_TYPE), 1024));
-#else
-    posix_memalign(reinterpret_cast<void**>(&data), 4096, size * sizeof(HOST_DATA_TYPE));
+    // Without a context, the data is only used on the CPU
+    if (context() != nullptr) {
+        data = reinterpret_cast<HOST_DATA_TYPE*>(
+                            clSVMAlloc(context(), 0 ,
+                            size * sizeof(HOST_DATA_TYPE), 1024));
+        return;
+    }
 #endif
+    posix_memalign(reinterpret_cast<void**>(&data), 4096, size * sizeof(HOST_DATA_TYPE));
 }
 
 random_access::RandomAccessData::~RandomAccessData() {
 #ifdef USE_SVM
-    clSVMFree(context(), reinterpret_cast<void*>(data));
-#else
-    free(data);
+    if (context() != nullptr) {
+        clSVMFree(context(), reinterpret_cast<void*>(data));
+        return;
+    }
 #endif
+    free(data);
 }
 
 random_access::RandomAccessBenchmark::RandomAccessBenchmark(int argc, char* argv[]) : HpccFpgaBenchmark(argc, argv) {
@@ -82,26 +109,50 @@ random_access::RandomAccessBenchmark::addAdditionalParseOptions(cxxopts::Options
         ("d", "Log2 of the size of the data array",
             cxxopts::value<size_t>()->default_value(std::to_string(DEFAULT_ARRAY_LENGTH_LOG)))
         ("g", "Log2 of the number of random number generators",
-            cxxopts::value<uint>()->default_value(std::to_string(HPCC_FPGA_RA_RNG_COUNT_LOG)));
+            cxxopts::value<uint>()->default_value(std::to_string(HPCC_FPGA_RA_RNG_COUNT_LOG)))
+        ("look-ahead", "Maximum number of updates every rank generates and exchanges at once (PCIE only). The HPCC rules allow at most 1024.",
+            cxxopts::value<uint>()->default_value(std::to_string(DEFAULT_LOOK_AHEAD)))
+        ("batch", "Log2 of the number of received updates that are applied by a single kernel execution (PCIE only)",
+            cxxopts::value<uint>()->default_value(std::to_string(DEFAULT_BATCH_SIZE_LOG)))
+        ("sort", "Sort the generated updates in batches by address before they are applied (CPU only)")
+        ("scan", "Measure all combinations of active RNGs and data sizes up to the given values")
+        ("scan-min-size", "Log2 of the smallest data size that is measured in scan mode",
+            cxxopts::value<uint>()->default_value(std::to_string(DEFAULT_SCAN_MIN_SIZE_LOG)));
 }
 
 void
 random_access::RandomAccessBenchmark::executeKernel(RandomAccessData &data) {
-    timings = bm_execution::calculate(*executionSettings, data.data, mpi_comm_rank, mpi_comm_size);
+    switch (executionSettings->programSettings->communicationType) {
+#ifdef _USE_MPI_
+        case hpcc_base::CommunicationType::pcie_mpi:
+            timings = bm_execution::pcie::calculate(*executionSettings, data.data, mpi_comm_rank, mpi_comm_size); break;
+#endif
+        case hpcc_base::CommunicationType::cpu_only:
+            timings = bm_execution::cpu::calculate(*executionSettings, data.data, mpi_comm_rank, mpi_comm_size); break;
+        case hpcc_base::CommunicationType::unsupported:
+            timings = bm_execution::calculate(*executionSettings, data.data, mpi_comm_rank, mpi_comm_size); break;
+        default: throw std::runtime_error("No calculate method implemented for communication type " + commToString(executionSettings->programSettings->communicationType));
+    }
 }
 
 void
 random_access::RandomAccessBenchmark::collectResults() {
 
-    std::vector<double> avgTimings(timings.at("execution").size());
+    // Average the measurements of all ranks
+    auto averageOverRanks = [this](std::vector<double> const& measurements) {
+        std::vector<double> avgTimings(measurements.size());
 #ifdef _USE_MPI_
-    // Copy the object variable to a local variable to make it accessible to the lambda function
-    int mpi_size = mpi_comm_size;
-    MPI_Reduce(timings.at("execution").data(), avgTimings.data(),timings.at("execution").size(), MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
-    std::for_each(avgTimings.begin(), avgTimings.end(), [mpi_size](double& x) {x /= mpi_size;});
+        // Copy the object variable to a local variable to make it accessible to the lambda function
+        int mpi_size = mpi_comm_size;
+        MPI_Reduce(measurements.data(), avgTimings.data(), measurements.size(), MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+        std::for_each(avgTimings.begin(), avgTimings.end(), [mpi_size](double& x) {x /= mpi_size;});
 #else
-    std::copy(timings.at("execution").begin(), timings.at("execution").end(), avgTimings.begin());
+        std::copy(measurements.begin(), measurements.end(), avgTimings.begin());
 #endif
+        return avgTimings;
+    };
+
+    std::vector<double> avgTimings = averageOverRanks(timings.at("execution"));
     // Calculate performance for kernel execution
     double tmean = 0;
     double tmin = std::numeric_limits<double>::max();
@@ -117,6 +168,24 @@ random_access::RandomAccessBenchmark::collectResults() {
     results.emplace("t_min", hpcc_base::HpccResult(tmin, "s"));
     results.emplace("t_mean", hpcc_base::HpccResult(tmean, "s"));
     results.emplace("guops", hpcc_base::HpccResult(gups / tmin, "GUOP/s"));
+
+    if (!executionSettings->programSettings->scan) {
+        return;
+    }
+    // Calculate the performance and the distribution of the kernel latencies for every scan point
+    for (auto const& point : getScanPoints(*executionSettings->programSettings)) {
+        std::string suffix = getScanPointSuffix(point);
+        std::vector<double> pointTimings = averageOverRanks(timings.at("execution" + suffix));
+        std::vector<double> latencies = averageOverRanks(timings.at("latency" + suffix));
+        std::sort(latencies.begin(), latencies.end());
+        double pointGups = static_cast<double>(4 * point.dataSize * mpi_comm_size) / 1000000000;
+        double pointTmin = *std::min_element(pointTimings.begin(), pointTimings.end());
+        results.emplace("guops" + suffix, hpcc_base::HpccResult(pointGups / pointTmin, "GUOP/s"));
+        results.emplace("latency_min" + suffix, hpcc_base::HpccResult(latencies.front(), "s"));
+        results.emplace("latency_median" + suffix, hpcc_base::HpccResult(latencies[latencies.size() / 2], "s"));
+        results.emplace("latency_p90" + suffix, hpcc_base::HpccResult(latencies[(latencies.size() * 9) / 10], "s"));
+        results.emplace("latency_max" + suffix, hpcc_base::HpccResult(latencies.back(), "s"));
+    }
 }
 
 void random_access::RandomAccessBenchmark::printResults() {
@@ -129,6 +198,26 @@ void random_access::RandomAccessBenchmark::printResults() {
                 << results.at("t_min") << std::setw(ENTRY_SPACE) << results.at("t_mean")
                 << std::setw(ENTRY_SPACE) << results.at("guops")
                 << std::endl;
+
+        if (executionSettings->programSettings->scan) {
+            std::cout << std::endl << "Scan results:" << std::endl;
+            std::cout << std::left << std::setw(ENTRY_SPACE)
+                    << "#RNGs" << std::setw(ENTRY_SPACE) << "Array Size"
+                    << std::setw(ENTRY_SPACE) << "GUOPS" << std::setw(ENTRY_SPACE) << "lat. min"
+                    << std::setw(ENTRY_SPACE) << "lat. median" << std::setw(ENTRY_SPACE) << "lat. p90"
+                    << std::setw(ENTRY_SPACE) << "lat. max" << std::right << std::endl;
+            for (auto const& point : getScanPoints(*executionSettings->programSettings)) {
+                std::string suffix = getScanPointSuffix(point);
+                std::cout << std::left << std::setw(ENTRY_SPACE) << point.numRngs
+                        << std::setw(ENTRY_SPACE) << point.dataSize << std::right
+                        << std::setw(ENTRY_SPACE) << results.at("guops" + suffix)
+                        << std::setw(ENTRY_SPACE) << results.at("latency_min" + suffix)
+                        << std::setw(ENTRY_SPACE) << results.at("latency_median" + suffix)
+                        << std::setw(ENTRY_SPACE) << results.at("latency_p90" + suffix)
+                        << std::setw(ENTRY_SPACE) << results.at("latency_max" + suffix)
+                        << std::endl;
+            }
+        }
     }
 }
 
@@ -146,12 +235,41 @@ random_access::RandomAccessBenchmark::checkInputParameters() {
         std::cerr << "ERROR: Data chunk size for each kernel replication is not a power of 2!" << std::endl;
         validationResult = false;
     }
+    if (executionSettings->programSettings->communicationType == hpcc_base::CommunicationType::pcie_mpi) {
+        if (executionSettings->programSettings->lookAhead == 0) {
+            std::cerr << "ERROR: Look-ahead has to be at least 1!" << std::endl;
+            validationResult = false;
+        }
+        else if (executionSettings->programSettings->lookAhead > 1024) {
+            std::cerr << "WARNING: Look-ahead of " << executionSettings->programSettings->lookAhead
+                        << " updates is larger than allowed by the HPCC rules (1024)!" << std::endl;
+        }
+    }
+    if (executionSettings->programSettings->communicationType == hpcc_base::CommunicationType::unsupported &&
+            executionSettings->programSettings->numRngs > (1 << HPCC_FPGA_RA_RNG_COUNT_LOG)) {
+        std::cerr << "ERROR: Number of RNGs is larger than the number of RNGs in the kernel ("
+                    << (1 << HPCC_FPGA_RA_RNG_COUNT_LOG) << ")!" << std::endl;
+        validationResult = false;
+    }
+    if (executionSettings->programSettings->scan) {
+        if (executionSettings->programSettings->communicationType != hpcc_base::CommunicationType::unsupported) {
+            std::cerr << "ERROR: Scan mode is only supported by the single kernel implementation!" << std::endl;
+            validationResult = false;
+        }
+        size_t min_data_per_replication = executionSettings->programSettings->scanMinSize / executionSettings->programSettings->kernelReplications;
+        if (executionSettings->programSettings->scanMinSize > executionSettings->programSettings->dataSize || min_data_per_replication == 0) {
+            std::cerr << "ERROR: Minimum scan size has to be between the number of kernel replications and the data size!" << std::endl;
+            validationResult = false;
+        }
+    }
     return validationResult;
 }
 
 std::unique_ptr<random_access::RandomAccessData>
 random_access::RandomAccessBenchmark::generateInputData() {
-    auto d = std::unique_ptr<RandomAccessData>(new RandomAccessData(*executionSettings->context, executionSettings->programSettings->dataSize));
+    // No context is created if the updates are calculated on the CPU
+    cl::Context context = executionSettings->context ? *executionSettings->context : cl::Context();
+    auto d = std::unique_ptr<RandomAccessData>(new RandomAccessData(context, executionSettings->programSettings->dataSize));
     for (HOST_DATA_TYPE j=0; j < executionSettings->programSettings->dataSize ; j++) {
         d->data[j] = mpi_comm_rank * executionSettings->programSettings->dataSize + j;
     }
@@ -161,59 +279,210 @@ random_access::RandomAccessBenchmark::generateInputData() {
 bool  
 random_access::RandomAccessBenchmark::validateOutput(random_access::RandomAccessData &data) {
 
-    HOST_DATA_TYPE* rawdata;
-    if (mpi_comm_size > 1) {
+    HOST_DATA_TYPE local_size = executionSettings->programSettings->dataSize;
+    HOST_DATA_TYPE global_size = local_size * mpi_comm_size;
+    HOST_DATA_TYPE address_start = mpi_comm_rank * local_size;
+
+    // Execute all pseudo random updates again, but every rank only applies the updates
+    // that hit its own address range. This should lead to the initial values in the data array,
+    // because XOR is a involutory function.
+    replayUpdates(data.data, local_size, address_start, global_size);
+
+    double error_count = 0;
+#pragma omp parallel for reduction(+:error_count)
+    for (HOST_DATA_TYPE i=0; i< local_size; i++) {
+        if (data.data[i] != address_start + i) {
+            // If the array at index i does not contain i, it differs from the initial value and is counted as an error
+            error_count++;
+        }
+    }
+
 #ifdef _USE_MPI_
-        if (mpi_comm_rank == 0) {
-            rawdata = new HOST_DATA_TYPE[executionSettings->programSettings->dataSize * mpi_comm_size];
+    // Only the error counts are reduced, the data array stays distributed over all ranks
+    MPI_Allreduce(MPI_IN_PLACE, &error_count, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+#endif
+
+    // The overall error is calculated in percent of the overall array size
+    double error_ratio = error_count / global_size;
+    errors.emplace("ratio", error_ratio);
+
+    return error_ratio < 0.01;
+}
+
+/**
+ * Number of updates that are generated by every thread before they are applied to the data array
+ */
+#define HOST_REPLAY_CHUNK_SIZE (1 << 18)
+
+/**
+ * Number of values in a partition of the data array. All updates to a partition are applied by the same thread.
+ * The partition should fit into the L2 cache.
+ */
+#define HOST_REPLAY_PARTITION_SIZE (1 << 15)
+
+void
+random_access::replayUpdates(HOST_DATA_TYPE *data, HOST_DATA_TYPE local_size, HOST_DATA_TYPE address_start,
+                                HOST_DATA_TYPE global_size) {
+    HOST_DATA_TYPE total_updates = 4 * global_size;
+    HOST_DATA_TYPE num_partitions = (local_size + HOST_REPLAY_PARTITION_SIZE - 1) / HOST_REPLAY_PARTITION_SIZE;
+
+    int num_threads = 1;
+    HOST_DATA_TYPE segment_size = 0;
+    HOST_DATA_TYPE num_rounds = 0;
+
+    // Updates generated by every thread in the current round sorted by the partition they hit
+    std::vector<std::vector<HOST_DATA_TYPE>> buckets;
+    // Offsets of the partitions in the buckets of every thread
+    std::vector<std::vector<HOST_DATA_TYPE>> bucket_offsets;
+
+#pragma omp parallel
+    {
+#pragma omp single
+        {
+#ifdef _OPENMP
+            num_threads = omp_get_num_threads();
+#endif
+            // Every thread replays a contiguous segment of the update sequence
+            segment_size = (total_updates + num_threads - 1) / num_threads;
+            num_rounds = (segment_size + HOST_REPLAY_CHUNK_SIZE - 1) / HOST_REPLAY_CHUNK_SIZE;
+            buckets.resize(num_threads);
+            bucket_offsets.resize(num_threads);
         }
-        MPI_Gather(data.data, executionSettings->programSettings->dataSize, MPI_LONG, 
-                rawdata, executionSettings->programSettings->dataSize, MPI_LONG, 0, MPI_COMM_WORLD);
+
+        int t = 0;
+#ifdef _OPENMP
+        t = omp_get_thread_num();
 #endif
+        std::vector<HOST_DATA_TYPE> &sorted = buckets[t];
+        std::vector<HOST_DATA_TYPE> &offsets = bucket_offsets[t];
+        sorted.resize(HOST_REPLAY_CHUNK_SIZE);
+        offsets.resize(num_partitions + 1);
+        std::vector<HOST_DATA_TYPE> hits(HOST_REPLAY_CHUNK_SIZE);
+        std::vector<HOST_DATA_TYPE> positions(num_partitions);
+
+        // The first random number of the segment is calculated using jump-ahead
+        HOST_DATA_TYPE segment_start = std::min(t * segment_size, total_updates);
+        HOST_DATA_TYPE segment_end = std::min(segment_start + segment_size, total_updates);
+        HOST_DATA_TYPE ran = starts(segment_start);
+
+        for (HOST_DATA_TYPE round = 0; round < num_rounds; round++) {
+            HOST_DATA_TYPE chunk_start = std::min(segment_start + round * HOST_REPLAY_CHUNK_SIZE, segment_end);
+            HOST_DATA_TYPE chunk_end = std::min(chunk_start + HOST_REPLAY_CHUNK_SIZE, segment_end);
+
+            // Generate the next chunk of updates and keep only the ones that hit the local address range
+            std::fill(offsets.begin(), offsets.end(), 0);
+            HOST_DATA_TYPE num_hits = 0;
+            for (HOST_DATA_TYPE i = chunk_start; i < chunk_end; i++) {
+                HOST_DATA_TYPE_SIGNED v = 0;
+                if (((HOST_DATA_TYPE_SIGNED)ran) < 0) {
+                    v = POLY;
+                }
+                ran = (ran << 1) ^ v;
+                // Addresses below the local range will overflow and are also filtered by the range check
+                HOST_DATA_TYPE local_address = ((ran >> 3) & (global_size - 1)) - address_start;
+                if (local_address < local_size) {
+                    hits[num_hits++] = ran;
+                    offsets[local_address / HOST_REPLAY_PARTITION_SIZE + 1]++;
+                }
+            }
+
+            // Sort the updates into the buckets of the partitions
+            for (HOST_DATA_TYPE p = 0; p < num_partitions; p++) {
+                offsets[p + 1] += offsets[p];
+                positions[p] = offsets[p];
+            }
+            for (HOST_DATA_TYPE h = 0; h < num_hits; h++) {
+                HOST_DATA_TYPE local_address = ((hits[h] >> 3) & (global_size - 1)) - address_start;
+                sorted[positions[local_address / HOST_REPLAY_PARTITION_SIZE]++] = hits[h];
+            }
+
+#pragma omp barrier
+
+            // Apply the updates partition-wise. Every partition is updated by a single thread,
+            // so no atomics are required. The order of the updates does not matter because XOR is commutative.
+#pragma omp for schedule(dynamic)
+            for (HOST_DATA_TYPE p = 0; p < num_partitions; p++) {
+                for (int g = 0; g < num_threads; g++) {
+                    for (HOST_DATA_TYPE u = bucket_offsets[g][p]; u < bucket_offsets[g][p + 1]; u++) {
+                        HOST_DATA_TYPE value = buckets[g][u];
+                        data[((value >> 3) & (global_size - 1)) - address_start] ^= value;
+                    }
+                }
+            }
+        }
     }
-    else {
-        rawdata = data.data;
+}
+
+std::vector<random_access::ScanPoint>
+random_access::getScanPoints(RandomAccessProgramSettings const& settings) {
+    std::vector<ScanPoint> points;
+    for (size_t size = settings.scan ? settings.scanMinSize : settings.dataSize; size <= settings.dataSize; size *= 2) {
+        for (uint rngs = settings.scan ? 1 : settings.numRngs; rngs <= settings.numRngs; rngs *= 2) {
+            points.push_back({rngs, size});
+        }
     }
+    return points;
+}
 
+std::string
+random_access::getScanPointSuffix(ScanPoint const& point) {
+    uint size_log = 0;
+    while ((1UL << size_log) < point.dataSize) {
+        size_log++;
+    }
+    return "_g" + std::to_string(point.numRngs) + "_d" + std::to_string(size_log);
+}
 
-    if (mpi_comm_rank == 0) {
+HOST_DATA_TYPE
+random_access::starts(HOST_DATA_TYPE n) {
+    n = n % PERIOD;
+    if (n == 0) {
+        return 1;
+    }
 
-        // Serially execute all pseudo random updates again
-        // This should lead to the initial values in the data array, because XOR is a involutory function
-        HOST_DATA_TYPE temp = 1;
-        for (HOST_DATA_TYPE i=0; i < 4L*executionSettings->programSettings->dataSize * mpi_comm_size; i++) {
+    // Precalculate the numbers at position 2*i to be able to multiply
+    // two elements of the sequence in GF(2)
+    HOST_DATA_TYPE m2[BIT_SIZE];
+    HOST_DATA_TYPE temp = 1;
+    for (uint i = 0; i < BIT_SIZE; i++) {
+        m2[i] = temp;
+        for (int k = 0; k < 2; k++) {
             HOST_DATA_TYPE_SIGNED v = 0;
             if (((HOST_DATA_TYPE_SIGNED)temp) < 0) {
                 v = POLY;
             }
             temp = (temp << 1) ^ v;
-            rawdata[(temp >> 3) & (executionSettings->programSettings->dataSize * mpi_comm_size - 1)] ^= temp;
         }
+    }
 
-        double error_count = 0;
-#pragma omp parallel for reduction(+:error_count)
-        for (HOST_DATA_TYPE i=0; i< executionSettings->programSettings->dataSize * mpi_comm_size; i++) {
-            if (rawdata[i] != i) {
-                // If the array at index i does not contain i, it differs from the initial value and is counted as an error
-                error_count++;
-            }
+    // Find the most significant bit of n
+    int i;
+    for (i = BIT_SIZE - 2; i >= 0; i--) {
+        if ((n >> i) & 1) {
+            break;
         }
+    }
 
-        // The overall error is calculated in percent of the overall array size
-        double error_ratio = static_cast<double>(error_count) / (executionSettings->programSettings->dataSize * mpi_comm_size);
-        errors.emplace("ratio", error_ratio);
-
-#ifdef _USE_MPI_
-        if (mpi_comm_rank == 0 && mpi_comm_size > 1) {
-            delete [] rawdata;
+    // Square-and-multiply over the bits of n
+    HOST_DATA_TYPE ran = 2;
+    while (i > 0) {
+        temp = 0;
+        for (uint j = 0; j < BIT_SIZE; j++) {
+            if ((ran >> j) & 1) {
+                temp ^= m2[j];
+            }
+        }
+        ran = temp;
+        i--;
+        if ((n >> i) & 1) {
+            HOST_DATA_TYPE_SIGNED v = 0;
+            if (((HOST_DATA_TYPE_SIGNED)ran) < 0) {
+                v = POLY;
+            }
+            ran = (ran << 1) ^ v;
         }
-#endif
-
-        return error_ratio < 0.01;
     }
-
-    // All other ranks skip validation and always return true
-    return true;
+    return ran;
 }
 
 void
@@ -26,6 +26,7 @@ SOFTWARE.
 /* C++ standard library headers */
 #include <complex>
 #include <memory>
+#include <vector>
 
 /* Project's headers */
 #include "hpcc_benchmark.hpp"
@@ -56,6 +57,36 @@ public:
      */
     uint numRngs;
 
+    /**
+     * @brief Maximum number of updates every rank generates and exchanges at once with the PCIE communication type
+     * 
+     */
+    uint lookAhead;
+
+    /**
+     * @brief Number of received updates that are applied by a single kernel execution with the PCIE communication type
+     * 
+     */
+    size_t batchSize;
+
+    /**
+     * @brief Sort the generated updates in batches by their address before applying them with the CPU communication type
+     * 
+     */
+    bool sortUpdates;
+
+    /**
+     * @brief Execute the benchmark for all combinations of active generators and data sizes up to the given values
+     * 
+     */
+    bool scan;
+
+    /**
+     * @brief Smallest size of the local data array that is used in scan mode
+     * 
+     */
+    size_t scanMinSize;
+
     /**
      * @brief Construct a new random access Program Settings object
      * 
@@ -72,6 +103,25 @@ public:
 
 };
 
+/**
+ * @brief A single configuration that is measured in scan mode
+ * 
+ */
+struct ScanPoint {
+
+    /**
+     * @brief Number of active random number generators per kernel replication
+     * 
+     */
+    uint numRngs;
+
+    /**
+     * @brief The size of the local data array
+     * 
+     */
+    size_t dataSize;
+};
+
 /**
  * @brief Data class cotnaining the data the kernel is exeucted with
  * 
@@ -95,7 +145,7 @@ public:
     /**
      * @brief Construct a new Random Access Data object
      * 
-     * @param context The OpenCL context that will be used to allocate SVM memory
+     * @param context The OpenCL context that will be used to allocate SVM memory. If it is empty, the memory is allocated on the host
      * @param size The size  of the allocated memory in number of values
      */
     RandomAccessData(cl::Context& context, size_t size);
@@ -193,6 +243,55 @@ public:
 
 };
 
+/**
+ * @brief Calculate the n-th number of the pseudo random sequence used for the updates
+ *          without generating all numbers before it (jump-ahead).
+ *          The implementation follows HPCC_starts of the HPCC reference implementation.
+ *          starts(0) returns the initial value 1 and starts(n) is equal to the value
+ *          after n updates of the RNG.
+ *
+ * @param n The position in the sequence
+ * @return HOST_DATA_TYPE the pseudo random number at the given position
+ */
+HOST_DATA_TYPE
+starts(HOST_DATA_TYPE n);
+
+/**
+ * @brief Apply all updates of the pseudo random sequence to the given part of the data array on the host.
+ *          The sequence is split into one segment per OpenMP thread, which is generated using jump-ahead.
+ *          The generated updates are sorted by cache-sized partitions of the data array and every partition is
+ *          updated by a single thread, so no atomic operations are required.
+ *
+ * @param data The local part of the data array that will be updated
+ * @param local_size The number of values in the local part of the data array
+ * @param address_start The global address of the first value in the local data array
+ * @param global_size The size of the global data array over all ranks. Has to be a power of two.
+ */
+void
+replayUpdates(HOST_DATA_TYPE *data, HOST_DATA_TYPE local_size, HOST_DATA_TYPE address_start,
+                HOST_DATA_TYPE global_size);
+
+/**
+ * @brief Get all configurations that have to be measured for the given settings.
+ *          Without scan mode, this is only the configuration given by the settings.
+ *          In scan mode, the number of active generators and the data size are doubled starting from one generator
+ *          and the minimum scan size. The given configuration is always the last point.
+ *
+ * @param settings The program settings of the benchmark
+ * @return std::vector<ScanPoint> the configurations ordered by data size and number of generators
+ */
+std::vector<ScanPoint>
+getScanPoints(RandomAccessProgramSettings const& settings);
+
+/**
+ * @brief Get the suffix that is used for the timings and results keys of a scan point
+ *
+ * @param point The scan point
+ * @return std::string the suffix in the format _g<number of generators>_d<log2 of the data size>
+ */
+std::string
+getScanPointSuffix(ScanPoint const& point);
+
 } // namespace stream
 
 
@@ -30,6 +30,21 @@ TEST_F(RandomAccessHostCodeTest, ResultValidationWorksForCorrectUpdates) {
     bm->printError();
 }
 
+/**
+ * Check if the jump-ahead calculation matches the sequentially generated random numbers
+ */
+TEST_F(RandomAccessHostCodeTest, JumpAheadMatchesSequentialRandomNumbers) {
+    HOST_DATA_TYPE ran = 1;
+    for (HOST_DATA_TYPE i = 0; i < 4 * bm->getExecutionSettings().programSettings->dataSize; i++) {
+        ASSERT_EQ(random_access::starts(i), ran);
+        HOST_DATA_TYPE_SIGNED v = 0;
+        if (((HOST_DATA_TYPE_SIGNED)ran) < 0) {
+            v = POLY;
+        }
+        ran = (ran << 1) ^ v;
+    }
+}
+
 /**
  * Check if invalid data size throws exception
  */
@@ -56,3 +71,51 @@ TEST_F(RandomAccessHostCodeTest, ResultValidationWorksForWrongUpdates) {
     EXPECT_FALSE(bm->validateOutput(*data));
     bm->printError();
 }
+
+/**
+ * Check if the CPU implementation calculates the updates within the error tolerance
+ */
+TEST_F(RandomAccessHostCodeTest, CPUExecutionPassesValidation) {
+    bm->getExecutionSettings().programSettings->communicationType = hpcc_base::CommunicationType::cpu_only;
+    bm->getExecutionSettings().programSettings->numRepetitions = 2;
+    for (bool sort : {false, true}) {
+        bm->getExecutionSettings().programSettings->sortUpdates = sort;
+        auto data = bm->generateInputData();
+        bm->executeKernel(*data);
+        EXPECT_TRUE(bm->validateOutput(*data));
+    }
+}
+
+/**
+ * Check if the CPU implementation can be executed without kernel file and device
+ */
+TEST(RandomAccessCPUOnlyTest, CPUExecutionWithoutKernelFile) {
+    std::vector<std::string> args = {"RandomAccess", "--comm-type", "CPU", "-d", "10", "-n", "1"};
+    std::vector<char*> tmp_argv;
+    for (auto& arg : args) {
+        tmp_argv.push_back(&arg[0]);
+    }
+    tmp_argv.push_back(nullptr);
+    random_access::RandomAccessBenchmark bm(args.size(), tmp_argv.data());
+    EXPECT_EQ(bm.getExecutionSettings().device, nullptr);
+    EXPECT_EQ(bm.getExecutionSettings().context, nullptr);
+    EXPECT_TRUE(bm.executeBenchmark());
+}
+
+/**
+ * Check if the scan points cover all combinations and end with the given configuration
+ */
+TEST_F(RandomAccessHostCodeTest, ScanPointsEndWithGivenConfiguration) {
+    auto& settings = *bm->getExecutionSettings().programSettings;
+    settings.numRngs = 4;
+    settings.scan = false;
+    EXPECT_EQ(random_access::getScanPoints(settings).size(), 1);
+    settings.scan = true;
+    settings.scanMinSize = 256;
+    auto points = random_access::getScanPoints(settings);
+    // 3 data sizes and 3 generator counts
+    ASSERT_EQ(points.size(), 9);
+    EXPECT_EQ(points.back().numRngs, 4);
+    EXPECT_EQ(points.back().dataSize, 1024);
+    EXPECT_EQ(random_access::getScanPointSuffix(points.back()), "_g4_d10");
+}
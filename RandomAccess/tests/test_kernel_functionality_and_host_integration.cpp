@@ -50,6 +50,22 @@ TEST_F(RandomAccessKernelTest, FPGAErrorBelow1Percent) {
     bm->printError();
 }
 
+/**
+ * Scan mode measures all points and still returns correct results for the given configuration
+ */
+TEST_F(RandomAccessKernelTest, FPGAScanMeasuresAllPoints) {
+    auto& settings = *bm->getExecutionSettings().programSettings;
+    settings.scan = true;
+    settings.scanMinSize = settings.dataSize / 2;
+    bm->executeKernel(*data);
+    auto points = random_access::getScanPoints(settings);
+    for (auto const& point : points) {
+        EXPECT_EQ(bm->getTimingsMap().at("execution" + random_access::getScanPointSuffix(point)).size(), 1);
+        EXPECT_EQ(bm->getTimingsMap().at("latency" + random_access::getScanPointSuffix(point)).size(), 1);
+    }
+    EXPECT_TRUE(bm->validateOutput(*data));
+}
+
 using json = nlohmann::json;
 
 TEST_F(RandomAccessKernelTest, JsonDump) {
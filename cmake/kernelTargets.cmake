@@ -93,7 +93,7 @@ function(generate_kernel_targets_xilinx)
         )
         if (XILINX_GENERATE_LINK_SETTINGS)
             add_custom_command(OUTPUT ${xilinx_link_settings}
-                    COMMAND ${Python3_EXECUTABLE} ${CODE_GENERATOR} -o ${xilinx_link_settings} -p num_replications=${NUM_REPLICATIONS} ${gen_xilinx_link_settings}
+                    COMMAND ${Python3_EXECUTABLE} ${CODE_GENERATOR} -o ${xilinx_link_settings} -p num_replications=${NUM_REPLICATIONS} ${KERNEL_CODE_GENERATION_PARAMETERS} ${gen_xilinx_link_settings}
                     MAIN_DEPENDENCY ${gen_xilinx_link_settings}
                     )
         else()
@@ -105,7 +105,7 @@ function(generate_kernel_targets_xilinx)
 
         if (KERNEL_REPLICATION_ENABLED)
                 add_custom_command(OUTPUT ${source_f}
-                        COMMAND ${Python3_EXECUTABLE} ${CODE_GENERATOR} -o ${source_f} -p num_replications=1 -p num_total_replications=${NUM_REPLICATIONS} ${base_file}
+                        COMMAND ${Python3_EXECUTABLE} ${CODE_GENERATOR} -o ${source_f} -p num_replications=1 -p num_total_replications=${NUM_REPLICATIONS} ${KERNEL_CODE_GENERATION_PARAMETERS} ${base_file}
                         MAIN_DEPENDENCY ${base_file}
                 )
         else()
@@ -197,6 +197,9 @@ function(generate_kernel_targets_intel)
                 if (INTEL_CODE_GENERATION_SETTINGS)
                         list(APPEND codegen_parameters -p "\"use_file('${INTEL_CODE_GENERATION_SETTINGS}')\"")
                 endif()
+                if (KERNEL_CODE_GENERATION_PARAMETERS)
+                        list(APPEND codegen_parameters ${KERNEL_CODE_GENERATION_PARAMETERS})
+                endif()
                 add_custom_command(OUTPUT ${source_f}
                         COMMAND ${Python3_EXECUTABLE} ${CODE_GENERATOR} -o ${source_f} ${codegen_parameters} ${base_file}
                         MAIN_DEPENDENCY ${base_file}
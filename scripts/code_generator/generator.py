@@ -66,6 +66,8 @@ if __name__ == '__main__':
     if not args.file:
         logging.debug('no input file given')
         exit(1)
+    # Remember the names that are defined by the script itself to find the ones added by the -p parameters
+    script_names = set(globals().keys()) | {'p'}
     for p in args.params:
         logging.debug("Parse statement: %s" % p)
         exec(p, globals())
@@ -74,10 +76,11 @@ if __name__ == '__main__':
 
     template.globals.update({'create_list': create_list})
 
-    try:
-        template.globals.update({"generate_attributes": generate_attributes})
-    except:
-        pass
+    # Make all variables and functions that are defined with the -p parameters available in the template.
+    # This also includes the definitions of files that are loaded with use_file
+    for name in set(globals().keys()) - script_names:
+        logging.debug("Export to template: %s" % name)
+        template.globals.update({name: globals()[name]})
 
     if not 'num_replications' in globals():
         num_replications = 1 
@@ -251,7 +251,7 @@ class HpccFpgaBenchmark
         ss << "Git Commit:   " << GIT_COMMIT_HASH << std::endl;
         // Defining and parsing program options
         cxxopts::Options options(argv[0], ss.str());
-        options.add_options()("f,file", "Kernel file name", cxxopts::value<std::string>())(
+        options.add_options()("f,file", "Kernel file name", cxxopts::value<std::string>()->default_value(std::string()))(
             "n", "Number of repetitions", cxxopts::value<uint>()->default_value(std::to_string(DEFAULT_REPETITIONS)))
 #ifdef INTEL_FPGA
             ("i", "Use memory Interleaving")
@@ -309,7 +309,12 @@ class HpccFpgaBenchmark
             }
 
             // Check parsed options and handle special cases
-            if (result.count("f") <= 0) {
+            // The kernel file is not needed if the benchmark is calculated on the CPU
+            bool cpu_only = false;
+#ifdef COMMUNICATION_TYPE_SUPPORT_ENABLED
+            cpu_only = result["comm-type"].as<std::string>() == commToString(CommunicationType::cpu_only);
+#endif
+            if (result.count("f") <= 0 && !cpu_only) {
                 throw fpga_setup::FpgaSetupException("Mandatory option is missing! Use -h to show all available "
                                                      "options. ERROR: Kernel file must be given with option -f!");
             }
@@ -550,7 +555,8 @@ class HpccFpgaBenchmark
             std::unique_ptr<TProgram> program;
             std::unique_ptr<TDevice> usedDevice;
 
-            if (!programSettings->testOnly) {
+            // No device is needed if the benchmark is calculated on the CPU
+            if (!programSettings->testOnly && programSettings->communicationType != CommunicationType::cpu_only) {
 #ifdef USE_XRT_HOST
                 usedDevice = fpga_setup::selectFPGADevice(programSettings->defaultDevice);
 #ifndef USE_ACCL
@@ -713,7 +719,9 @@ class HpccFpgaBenchmark
         int isMpiInitialized;
         MPI_Initialized(&isMpiInitialized);
         if (!isMpiInitialized) {
-            MPI_Init(&argc, &argv);
+            // Host code may call MPI from different OpenMP threads, but never concurrently
+            int provided;
+            MPI_Init_thread(&argc, &argv, MPI_THREAD_SERIALIZED, &provided);
             mpi_external_init = isMpiInitialized;
         }
         MPI_Comm_rank(MPI_COMM_WORLD, &mpi_comm_rank);
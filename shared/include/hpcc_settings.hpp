@@ -191,15 +191,17 @@ public:
     std::string
     getDeviceName() const {
         std::string device_name;
-        if (!programSettings->testOnly) {
+        if (programSettings->testOnly) {
+            device_name = "TEST RUN: Not selected!";
+        } else if (programSettings->communicationType == CommunicationType::cpu_only) {
+            device_name = "CPU";
+        } else {
 #ifdef USE_OCL_HOST
             device->getInfo(CL_DEVICE_NAME, &device_name);
 #endif
 #ifdef USE_XRT_HOST
             device_name = device->template get_info<xrt::info::device::name>();
 #endif
-        } else {
-            device_name = "TEST RUN: Not selected!";
         }
         return device_name;
     }
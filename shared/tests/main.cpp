@@ -36,7 +36,8 @@ public:
         int isMPIInitialized;
         MPI_Initialized(&isMPIInitialized);
         if (!isMPIInitialized) {
-            MPI_Init(argc, argv);
+            int provided;
+            MPI_Init_thread(argc, argv, MPI_THREAD_SERIALIZED, &provided);
         }
     }
 